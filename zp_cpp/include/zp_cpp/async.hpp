@@ -0,0 +1,565 @@
+#pragma once
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "jobs.hpp"
+#include "small_function.hpp"
+#include "time.hpp"
+#include "timer_wheel.hpp"
+
+namespace zp
+{
+    constexpr ens NO_DEADLINE = std::numeric_limits<ens>::max();
+
+    // runs zp::task coroutines on the thread that polls it, typically once per frame. a suspended coroutine costs no thread:
+    // timers park it on a timer wheel, work offloaded to zp::jobs posts it back when done, and pollers (e.g. an ENet host's
+    // handle_incoming) run first in every poll to wake coroutines waiting on them. every coroutine resumes on the polling
+    // thread, so task bodies need no locking against each other. not thread safe apart from exec_post.
+    struct executor
+    {
+        struct State
+        {
+            struct Internal;
+
+            Internal* p_i         = nullptr;
+            std::uint64_t resumed = 0; // coroutine resumptions over the executor's life.
+            std::uint32_t spawned = 0; // spawned tasks that have not finished.
+        };
+        State state;
+    };
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // exec_init: Allocates the executor with its timers starting at clock::now_ns.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void exec_init(executor* p_exec);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // exec_exit: Destroys every spawned task that has not finished, without resuming it, and releases the executor. Work offloaded
+    // to zp::jobs by those tasks must have finished first, e.g. by calling jobs::shutdown before.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void exec_exit(executor* p_exec);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // exec_poll: Runs the pollers, fires due timers, then resumes every coroutine that became ready. Coroutines that suspend again
+    // while it runs resume from a later poll, never this one. Returns how many coroutines resumed.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    std::size_t exec_poll(executor* p_exec);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // exec_add_poller: Runs poller at the start of every exec_poll.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void exec_add_poller(executor* p_exec, small_function<void()> poller);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // exec_schedule: Resumes handle from the next exec_poll. Polling thread only.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void exec_schedule(executor* p_exec, std::coroutine_handle<> handle);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // exec_schedule_at: Resumes handle from the first exec_poll at or after deadline_ns, rounded up to the timer tick. Polling
+    // thread only.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void exec_schedule_at(executor* p_exec, ens deadline_ns, std::coroutine_handle<> handle);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // exec_call_at: Runs callback from the first exec_poll at or after deadline_ns, before that poll resumes anything, so it can
+    // decide what wakes. Polling thread only.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    TimerId exec_call_at(executor* p_exec, ens deadline_ns, std::function<void()> callback);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // exec_cancel_call: Drops a callback from exec_call_at that has not run. Returns false when it already ran. Polling thread only.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    bool exec_cancel_call(executor* p_exec, TimerId id);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // exec_post: Resumes handle from the next exec_poll. Safe from any thread.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void exec_post(executor* p_exec, std::coroutine_handle<> handle);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // exec_adopt: Tracks handle as a spawned task until exec_release. Called by exec_spawn.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void exec_adopt(executor* p_exec, std::coroutine_handle<> handle);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // exec_release: Stops tracking and destroys a spawned task that has finished. Called from the task's final suspend.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void exec_release(executor* p_exec, std::coroutine_handle<> handle);
+
+    // what every task promise shares: the executor it runs on, inherited from the awaiting task, and who to resume when done.
+    // awaitables read p_exec through the handle they are suspended with, so co_await never needs the executor spelled out.
+    struct task_promise_base
+    {
+        struct FinalAwaiter
+        {
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            // hands control straight to the awaiting task, or lets the executor free a spawned one.
+            template <typename Promise> std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> finished) noexcept
+            {
+                task_promise_base& promise = finished.promise();
+                if (promise.continuation)
+                {
+                    return promise.continuation;
+                }
+                exec_release(promise.p_exec, finished);
+                return std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept
+            {
+            }
+        };
+
+        executor* p_exec = nullptr;
+        std::coroutine_handle<> continuation;
+
+        std::suspend_always initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        FinalAwaiter final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        // errors travel as return values here like everywhere else in zp; an exception escaping a task is a bug.
+        void unhandled_exception() const noexcept
+        {
+            std::terminate();
+        }
+    };
+
+    template <typename T> struct task_value
+    {
+        std::optional<T> value;
+
+        template <typename U> void return_value(U&& v)
+        {
+            value.emplace(std::forward<U>(v));
+        }
+
+        T take()
+        {
+            return std::move(*value);
+        }
+    };
+
+    template <> struct task_value<void>
+    {
+        void return_void() const noexcept
+        {
+        }
+
+        void take() const noexcept
+        {
+        }
+    };
+
+    // a lazy coroutine producing a T. nothing runs until it is co_awaited from another task, which it then resumes directly
+    // when it finishes, or handed to exec_spawn. awaiting a task that completes without suspending costs no trip through
+    // the executor. move only; destroying a task that has not been spawned destroys its frame.
+    template <typename T = void> struct task
+    {
+        struct promise_type : task_promise_base, task_value<T>
+        {
+            task get_return_object() noexcept
+            {
+                return task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+        };
+
+        task() noexcept = default;
+
+        explicit task(std::coroutine_handle<promise_type> h) noexcept : handle(h)
+        {
+        }
+
+        task(task&& o) noexcept : handle(std::exchange(o.handle, {}))
+        {
+        }
+
+        task& operator=(task&& o) noexcept
+        {
+            if (this != &o)
+            {
+                if (handle)
+                {
+                    handle.destroy();
+                }
+                handle = std::exchange(o.handle, {});
+            }
+            return *this;
+        }
+
+        ~task()
+        {
+            if (handle)
+            {
+                handle.destroy();
+            }
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        template <typename Promise> std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> awaiting) noexcept
+        {
+            handle.promise().p_exec       = awaiting.promise().p_exec;
+            handle.promise().continuation = awaiting;
+            return handle;
+        }
+
+        T await_resume()
+        {
+            return handle.promise().take();
+        }
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // exec_spawn: Starts spawned on the calling thread, which must be the polling thread, and runs it until it first suspends.
+    // The executor owns it from then on and frees it when it finishes; its result is dropped.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename T> void exec_spawn(executor* p_exec, task<T> spawned);
+
+    // resumes the awaiting task from the next exec_poll, e.g. to retry a non-blocking check once per frame.
+    struct yield_awaiter
+    {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        template <typename Promise> void await_suspend(std::coroutine_handle<Promise> awaiting) const
+        {
+            exec_schedule(awaiting.promise().p_exec, awaiting);
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+    };
+
+    // resumes the awaiting task from the first exec_poll at or after deadline_ns. deadlines already passed do not suspend.
+    struct sleep_awaiter
+    {
+        ens deadline_ns;
+
+        bool await_ready() const noexcept
+        {
+            return clock::now_ns() >= deadline_ns;
+        }
+
+        template <typename Promise> void await_suspend(std::coroutine_handle<Promise> awaiting) const
+        {
+            exec_schedule_at(awaiting.promise().p_exec, deadline_ns, awaiting);
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+    };
+
+    // runs fn on zp::jobs and resumes the awaiting task with its result from the next exec_poll after it returns.
+    template <typename F> struct offload_awaiter
+    {
+        using R = std::invoke_result_t<F&>;
+
+        F fn;
+        std::optional<std::conditional_t<std::is_void_v<R>, bool, R>> result;
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        template <typename Promise> void await_suspend(std::coroutine_handle<Promise> awaiting)
+        {
+            executor* p_exec = awaiting.promise().p_exec;
+            jobs::run(
+                [this, p_exec, awaiting]()
+                {
+                    if constexpr (std::is_void_v<R>)
+                    {
+                        fn();
+                        result.emplace(true);
+                    }
+                    else
+                    {
+                        result.emplace(fn());
+                    }
+                    exec_post(p_exec, awaiting);
+                });
+        }
+
+        R await_resume()
+        {
+            if constexpr (!std::is_void_v<R>)
+            {
+                return std::move(*result);
+            }
+        }
+    };
+
+    template <typename T> struct pop_awaiter;
+
+    // values handed from the polling thread to the tasks awaiting them, oldest waiter first. values pushed while nobody waits
+    // are kept for the next async_pop. polling thread only.
+    template <typename T> struct async_queue
+    {
+        struct Waiter
+        {
+            std::coroutine_handle<> handle;
+            executor* p_exec;
+            pop_awaiter<T>* p_awaiter;
+        };
+
+        std::deque<T> values;
+        std::deque<Waiter> waiters;
+    };
+
+    // the next value of an async_queue, or nullopt when async_cancel woke the waiter or deadline_ns passed first. p_queue is
+    // cleared once the awaiter is no longer queued, so a frame destroyed while still waiting, e.g. by exec_exit, takes itself
+    // off the queue and one destroyed after being woken never touches it. a deadline is a timer on the executor's wheel that
+    // takes the waiter off the queue before resuming it, so a value can never reach a waiter that already timed out.
+    template <typename T> struct pop_awaiter
+    {
+        async_queue<T>* p_queue;
+        std::optional<T> slot;
+        ens deadline_ns  = NO_DEADLINE;
+        executor* p_exec = nullptr;
+        TimerId timer    = INVALID_TIMER;
+
+        ~pop_awaiter()
+        {
+            if (p_queue != nullptr)
+            {
+                withdraw();
+            }
+        }
+
+        // the awaiter is off its queue: disarm the deadline and forget the queue.
+        void detach()
+        {
+            if (timer != INVALID_TIMER)
+            {
+                exec_cancel_call(p_exec, timer);
+                timer = INVALID_TIMER;
+            }
+            p_queue = nullptr;
+        }
+
+        // takes the awaiter off its queue while it is still waiting.
+        void withdraw()
+        {
+            std::deque<typename async_queue<T>::Waiter>& waiters = p_queue->waiters;
+            waiters.erase(std::remove_if(waiters.begin(), waiters.end(), [this](const typename async_queue<T>::Waiter& waiter) { return waiter.p_awaiter == this; }), waiters.end());
+            detach();
+        }
+
+        bool await_ready()
+        {
+            if (p_queue->values.empty())
+            {
+                if (deadline_ns == NO_DEADLINE || clock::now_ns() < deadline_ns)
+                {
+                    return false;
+                }
+                p_queue = nullptr;
+                return true;
+            }
+            slot.emplace(std::move(p_queue->values.front()));
+            p_queue->values.pop_front();
+            p_queue = nullptr;
+            return true;
+        }
+
+        template <typename Promise> void await_suspend(std::coroutine_handle<Promise> awaiting)
+        {
+            p_exec = awaiting.promise().p_exec;
+            p_queue->waiters.push_back({awaiting, p_exec, this});
+            if (deadline_ns != NO_DEADLINE)
+            {
+                const auto expire = [this, awaiting]()
+                {
+                    timer = INVALID_TIMER;
+                    withdraw();
+                    exec_schedule(p_exec, awaiting);
+                };
+                timer = exec_call_at(p_exec, deadline_ns, expire);
+            }
+        }
+
+        std::optional<T> await_resume()
+        {
+            return std::move(slot);
+        }
+    };
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // async_yield: Suspends until the next exec_poll.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline yield_awaiter async_yield()
+    {
+        return {};
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // async_sleep_until: Suspends until the first exec_poll at or after deadline_ns on clock::now_ns.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline sleep_awaiter async_sleep_until(ens deadline_ns)
+    {
+        return {deadline_ns};
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // async_sleep: Suspends until delay_ns from now have passed on clock::now_ns.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline sleep_awaiter async_sleep(ens delay_ns)
+    {
+        return {clock::now_ns() + delay_ns};
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // async_offload: Runs fn on a zp::jobs worker and suspends until it returns, so blocking work such as file I/O never stalls
+    // the polling thread. fn lives in the awaiting frame. Without a running pool fn runs inline and the task resumes next poll.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename F> offload_awaiter<std::decay_t<F>> async_offload(F&& fn)
+    {
+        return {std::forward<F>(fn), std::nullopt};
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // async_push: Hands value to the oldest waiter, which resumes from the next exec_poll, or keeps it when nobody waits.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename T> void async_push(async_queue<T>* p_queue, T value);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // async_pop: Awaits the next value, taking a kept one without suspending.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename T> pop_awaiter<T> async_pop(async_queue<T>* p_queue)
+    {
+        return {p_queue, std::nullopt};
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // async_pop_until: async_pop that gives up with nullopt from the first exec_poll at or after deadline_ns on clock::now_ns.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename T> pop_awaiter<T> async_pop_until(async_queue<T>* p_queue, ens deadline_ns)
+    {
+        return {p_queue, std::nullopt, deadline_ns};
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // async_cancel: Wakes every waiter with nullopt, e.g. when the source the values come from has gone away. Tasks destroyed
+    // while waiting, e.g. by exec_exit, have already left the queue, so it is safe to call after the executor has gone.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename T> void async_cancel(async_queue<T>* p_queue);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// exec_spawn: Detaches the frame from spawned, points it at the executor and runs it to its first suspension.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename T> void zp::exec_spawn(executor* p_exec, task<T> spawned)
+{
+    const std::coroutine_handle<typename task<T>::promise_type> handle = std::exchange(spawned.handle, {});
+    handle.promise().p_exec                                             = p_exec;
+    exec_adopt(p_exec, handle);
+    handle.resume();
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// async_push: Hands value to the oldest waiter, or keeps it when nobody waits.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename T> void zp::async_push(async_queue<T>* p_queue, T value)
+{
+    if (p_queue->waiters.empty())
+    {
+        p_queue->values.push_back(std::move(value));
+        return;
+    }
+
+    const typename async_queue<T>::Waiter waiter = p_queue->waiters.front();
+    p_queue->waiters.pop_front();
+    waiter.p_awaiter->slot.emplace(std::move(value));
+    waiter.p_awaiter->detach();
+    exec_schedule(waiter.p_exec, waiter.handle);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// async_cancel: Wakes every waiter with nullopt.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename T> void zp::async_cancel(async_queue<T>* p_queue)
+{
+    for (const typename async_queue<T>::Waiter& waiter : p_queue->waiters)
+    {
+        waiter.p_awaiter->detach();
+        exec_schedule(waiter.p_exec, waiter.handle);
+    }
+    p_queue->waiters.clear();
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include "async.hpp"
+#include "files.hpp"
+
+// the coroutine side of zp::files, kept apart so plain file users do not pull in the executor.
+namespace zp::files
+{
+    // a whole file read by async_read. bytes is empty unless result is ZC_SUCCESS.
+    struct FileContents
+    {
+        Result result;
+        std::vector<std::byte> bytes;
+    };
+
+    // reads the whole file on a zp::jobs worker; the awaiting task resumes from the executor poll after the read.
+    task<FileContents> async_read(std::filesystem::path path);
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "core.hpp"
+#include "buff.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zp::compress
+{
+    constexpr std::uint32_t FRAME_MAGIC      = 0x5a4c505a; // "ZPLZ" little endian
+    constexpr std::uint32_t FRAME_VERSION    = 1;
+    constexpr std::size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+    constexpr std::size_t MAX_BLOCK_SIZE     = 4 * 1024 * 1024;
+
+    enum class Level
+    {
+        FAST,
+        HIGH,
+    };
+
+    // streaming xxh32-compatible checksum used for frame content checksums.
+    struct Checksum
+    {
+        std::uint64_t total_len;
+        std::uint32_t v[4];
+        std::uint8_t mem[16];
+        std::uint32_t mem_size;
+    };
+
+    struct encoder
+    {
+        struct Config
+        {
+            Level level            = Level::FAST;
+            std::size_t block_size = DEFAULT_BLOCK_SIZE;
+        };
+        Config config;
+
+        struct State
+        {
+            bool header_written = false;
+            std::vector<std::byte> pending;
+            std::vector<std::byte> scratch;
+            Checksum checksum;
+        };
+        State state;
+    };
+
+    struct decoder
+    {
+        enum class Stage
+        {
+            HEADER,
+            BLOCK_HEADER,
+            BLOCK,
+            CHECKSUM,
+            DONE,
+        };
+
+        struct State
+        {
+            Stage stage                = Stage::HEADER;
+            std::size_t block_size     = 0;
+            std::uint32_t block_header = 0;
+            std::vector<std::byte> pending;
+            Checksum checksum;
+        };
+        State state;
+    };
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // compress_bound: Worst-case compressed size of a single block holding src_size bytes.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    constexpr std::size_t compress_bound(std::size_t src_size) noexcept
+    {
+        return src_size + src_size / 255 + 16;
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // compress_block: Compresses src into dst using the LZ4 block format. FAST is a greedy single-probe matcher, HIGH searches
+    // hash chains with one step of lazy evaluation. dst should hold compress_bound(src.count) bytes.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    Result compress_block(span<const std::byte> src, span<std::byte> dst, Level level, span<std::byte>* p_out);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // decompress_block: Decodes an LZ4 block into dst. Every read and write is bounds checked so corrupt input fails with
+    // ZC_INVALID_FORMAT instead of touching memory outside src or dst.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    Result decompress_block(span<const std::byte> src, span<std::byte> dst, span<std::byte>* p_out);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // checksum_reset / checksum_update / checksum_digest: Streaming xxh32 (seed 0) over arbitrary chunks.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void checksum_reset(Checksum* p_checksum) noexcept;
+    void checksum_update(Checksum* p_checksum, span<const std::byte> data) noexcept;
+    std::uint32_t checksum_digest(const Checksum* p_checksum) noexcept;
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // encoder_write: Buffers input and appends every completed frame block to p_out. The frame header is emitted on first use.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void encoder_write(encoder* p_encoder, span<const std::byte> data, std::vector<std::byte>* p_out);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // encoder_finish: Flushes the last partial block, the end mark and the content checksum, then resets the encoder for reuse.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void encoder_finish(encoder* p_encoder, std::vector<std::byte>* p_out);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // decoder_feed: Consumes any amount of frame bytes and appends decoded content to p_out. Returns ZC_CHECKSUM_MISMATCH when
+    // the content checksum fails and ZC_INVALID_FORMAT for malformed frames.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    Result decoder_feed(decoder* p_decoder, span<const std::byte> data, std::vector<std::byte>* p_out);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // compress_frame / decompress_frame: One-shot helpers over the streaming encoder and decoder.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void compress_frame(span<const std::byte> src, Level level, std::vector<std::byte>* p_out);
+    Result decompress_frame(span<const std::byte> src, std::vector<std::byte>* p_out);
+}
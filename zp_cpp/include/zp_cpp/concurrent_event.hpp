@@ -0,0 +1,221 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "events.hpp"
+#include "small_function.hpp"
+
+namespace zp
+{
+    // multi-producer queue of work for one owning thread: any thread posts, the owner drains, typically once per frame.
+    struct dispatch_queue
+    {
+        struct State
+        {
+            struct Internal;
+
+            Internal* p_i = nullptr;
+        };
+        State state;
+    };
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // dispatch_init: Allocates the queue.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void dispatch_init(dispatch_queue* p_queue);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // dispatch_exit: Drops any work still queued without running it and releases the queue.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void dispatch_exit(dispatch_queue* p_queue);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // dispatch_post: Queues work for the owner's next dispatch_drain. Safe from any thread.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void dispatch_post(dispatch_queue* p_queue, small_function<void()> work);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // dispatch_drain: Runs everything posted so far on the calling thread and returns how much ran. Work posted while it runs
+    // waits for the next drain.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    std::size_t dispatch_drain(dispatch_queue* p_queue);
+
+    // epoch-based read-copy-update. readers bump one of two counters picked by the epoch's parity; rcu_synchronize advances
+    // the epoch twice, waiting each time for the parity it left to drain, after which no reader can still hold anything
+    // unpublished before the call.
+    struct rcu_epoch
+    {
+        std::atomic<std::uint64_t> epoch = 0;
+        std::atomic<std::uint64_t> readers[2];
+        std::mutex synchronize_mutex;
+    };
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // rcu_read_lock: Enters a read section and returns the epoch to hand to rcu_read_unlock. Wait-free unless a writer flips the
+    // epoch in between, in which case it retries.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    std::uint64_t rcu_read_lock(rcu_epoch* p_rcu);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // rcu_read_unlock: Leaves the read section entered at epoch.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void rcu_read_unlock(rcu_epoch* p_rcu, std::uint64_t epoch);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // rcu_synchronize: Waits for a grace period: every read section that began before the call has ended.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void rcu_synchronize(rcu_epoch* p_rcu);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // rcu_in_read_section: True while the calling thread is inside any read section, where rcu_synchronize would wait on itself.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    bool rcu_in_read_section();
+
+    // Event<T> for cross-thread signalling. trigger runs on any thread and takes no lock: it walks an immutable listener array
+    // inside an rcu read section. subscribe and unsubscribe copy the array, publish the copy and free the old one after a grace
+    // period, or leave it for a later writer when called from inside a listener. a listener subscribed with a target
+    // dispatch_queue is not called on the triggering thread; a copy of it and the payload are posted to the queue instead, and
+    // it may still run once after unsubscribing.
+    template <typename T> class concurrent_event
+    {
+        public:
+        using Listener = small_function<void(const T&)>;
+
+        concurrent_event() : p_shared(std::make_shared<Shared>()) {}
+
+        concurrent_event(const concurrent_event&)            = delete;
+        concurrent_event& operator=(const concurrent_event&) = delete;
+
+        [[nodiscard]] subscription subscribe(Listener callback, dispatch_queue* p_target = nullptr)
+        {
+            const std::uint64_t id = p_shared->next_id.fetch_add(1, std::memory_order_relaxed);
+            publish(p_shared.get(), [&](std::vector<Entry>* p_entries) { p_entries->push_back(Entry{id, std::move(callback), p_target}); });
+            return subscription(p_shared, &concurrent_event::release, static_cast<std::uint32_t>(id), static_cast<std::uint32_t>(id >> 32));
+        }
+
+        void trigger(const T& data)
+        {
+            Shared* p_s                = p_shared.get();
+            const std::uint64_t epoch  = rcu_read_lock(&p_s->rcu);
+            const Snapshot* p_snapshot = p_s->p_current.load(std::memory_order_acquire);
+            for (const Entry& entry : p_snapshot->entries)
+            {
+                if (entry.p_target == nullptr)
+                {
+                    entry.listener(data);
+                }
+                else
+                {
+                    dispatch_post(entry.p_target, [listener = entry.listener, data]() { listener(data); });
+                }
+            }
+            rcu_read_unlock(&p_s->rcu, epoch);
+        }
+
+        std::size_t listener_count() const
+        {
+            Shared* p_s               = p_shared.get();
+            const std::uint64_t epoch = rcu_read_lock(&p_s->rcu);
+            const std::size_t count   = p_s->p_current.load(std::memory_order_acquire)->entries.size();
+            rcu_read_unlock(&p_s->rcu, epoch);
+            return count;
+        }
+
+        private:
+        struct Entry
+        {
+            std::uint64_t id;
+            Listener listener;
+            dispatch_queue* p_target;
+        };
+
+        struct Snapshot
+        {
+            std::vector<Entry> entries;
+        };
+
+        struct Shared
+        {
+            rcu_epoch rcu;
+            std::atomic<const Snapshot*> p_current = new Snapshot();
+            std::atomic<std::uint64_t> next_id     = 1;
+            std::mutex write_mutex;
+            std::vector<const Snapshot*> retired; // replaced snapshots still waiting for a grace period.
+
+            ~Shared()
+            {
+                delete p_current.load();
+                for (const Snapshot* p_snapshot : retired)
+                {
+                    delete p_snapshot;
+                }
+            }
+        };
+
+        // copies the current array, applies edit and publishes the copy. the grace period runs outside write_mutex so a
+        // listener on another thread can still subscribe while this waits for it.
+        template <typename Edit> static void publish(Shared* p_s, const Edit& edit)
+        {
+            std::vector<const Snapshot*> reclaim;
+            {
+                std::lock_guard<std::mutex> lock(p_s->write_mutex);
+                const Snapshot* p_old = p_s->p_current.load(std::memory_order_relaxed);
+                Snapshot* p_next      = new Snapshot(*p_old);
+                edit(&p_next->entries);
+                p_s->p_current.store(p_next, std::memory_order_release);
+                p_s->retired.push_back(p_old);
+                if (rcu_in_read_section())
+                {
+                    return;
+                }
+                reclaim.swap(p_s->retired);
+            }
+
+            rcu_synchronize(&p_s->rcu);
+            for (const Snapshot* p_snapshot : reclaim)
+            {
+                delete p_snapshot;
+            }
+        }
+
+        static void release(void* p, std::uint32_t index, std::uint32_t generation)
+        {
+            const std::uint64_t id = static_cast<std::uint64_t>(generation) << 32 | index;
+            const auto erase_id    = [id](std::vector<Entry>* p_entries)
+            {
+                for (auto it = p_entries->begin(); it != p_entries->end(); ++it)
+                {
+                    if (it->id == id)
+                    {
+                        p_entries->erase(it);
+                        return;
+                    }
+                }
+            };
+            publish(static_cast<Shared*>(p), erase_id);
+        }
+
+        std::shared_ptr<Shared> p_shared;
+    };
+}
@@ -35,6 +35,10 @@ namespace zp
         ZC_FILE_ACCESS_ERROR = -3,
         ZC_FILE_READ_ERROR   = -4,
         ZC_FILE_WRITE_ERROR  = -5,
+        ZC_INVALID_FORMAT    = -6,
+        ZC_CHECKSUM_MISMATCH = -7,
+        ZC_QUEUE_FULL        = -8,
+        ZC_INVALID_ARGUMENT  = -9,
     };
 
     constexpr size_t mib(size_t m) noexcept
@@ -1,54 +1,115 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 #include <sstream>
-#include <iomanip>
-#include <ctime>
-#include <chrono>
+#include <string_view>
 
-#if defined(_WIN32) || defined(_WIN64)
+#include "log.hpp"
 
-#define _DECORATE_LOG(colour, msg, shouldThrow) \
+namespace zp::dbg
+{
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // stream: Per-thread stream a console line is built in. Its buffer is reused across lines.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    std::ostringstream& stream();
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // timestamp: Local "HH:MM:SS.mmm", cached per thread and reformatted at most once per millisecond.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    std::string_view timestamp();
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // console_write: Hands the line in oss to the shared console sink and never blocks on stdout. A background writer drains the
+    // sink with batched writev; when it falls behind, the oldest queued lines are dropped and a count is printed in their place.
+    // The sink writes to STDOUT_FILENO and is POSIX only.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void console_write(std::ostringstream& oss);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // console_flush: Blocks until every line queued so far has reached stdout.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void console_flush();
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // console_dropped: Total lines dropped under backpressure since startup.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    std::uint64_t console_dropped();
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // report_suppressed: ReportFn of the throttled console sites. Writes their "N messages suppressed" line in the site's colour.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void report_suppressed(const zp::log::SiteThrottle* p_throttle, std::uint64_t suppressed);
+}
+
+// writes one console line; callers apply the level gating.
+#define _DBG_EMIT(colour, msg) \
     do { \
-        std::ostringstream oss_MACRO; \
-        std::string path_MACRO      = __FILE__; \
-        size_t pos_MACRO            = path_MACRO.find_last_of("\\/"); \
-        std::string extracted_MACRO = (pos_MACRO == std::string::npos) ? path_MACRO : path_MACRO.substr(pos_MACRO + 1); \
-        /* Get current time with milliseconds */ \
-        auto now_MACRO              = std::chrono::system_clock::now(); \
-        std::time_t t_MACRO         = std::chrono::system_clock::to_time_t(now_MACRO); \
-        std::tm tm_MACRO; \
-        localtime_s(&tm_MACRO, &t_MACRO); \
-        auto ms_MACRO = std::chrono::duration_cast<std::chrono::milliseconds>(now_MACRO.time_since_epoch()) % 1000; \
-        oss_MACRO << "\033[33m[" << std::put_time(&tm_MACRO, "%H:%M:%S") << "." << std::setfill('0') << std::setw(3) << ms_MACRO.count() << "] \033[34m[" << extracted_MACRO << ":" << __LINE__ << "]" << colour << " " << msg << "\033[0m" << std::endl; \
-        std::cout << oss_MACRO.str(); \
+        std::ostringstream& oss_MACRO = zp::dbg::stream(); \
+        oss_MACRO << "\033[33m[" << zp::dbg::timestamp() << "] \033[34m[" << zp::log::source_basename(__FILE__) << ":" << __LINE__ << "]" << colour << " " << msg << "\033[0m\n"; \
+        zp::dbg::console_write(oss_MACRO); \
     } while (0)
 
-#else
+// gated like ZP_LOG_*: below ZP_LOG_MIN_LEVEL a site generates no code, and a silenced module skips formatting at runtime.
+#define _DECORATE_LOG(level, colour, msg, shouldThrow) \
+    do { \
+        if constexpr ((level) >= ZP_LOG_MIN_LEVEL) \
+        { \
+            if (zp::log::level_enabled(ZP_LOG_MODULE, level)) \
+            { \
+                _DBG_EMIT(colour, msg); \
+            } \
+        } \
+    } while (0)
 
-#define _DECORATE_LOG(colour, msg, shouldThrow) \
+// throttled console sites for hot paths, see ZP_LOG_THROTTLED. allow may refer to the site's zp_throttle_MACRO.
+#define _DECORATE_LOG_THROTTLED(level, colour, allow, msg) \
     do { \
-        std::ostringstream oss_MACRO; \
-        std::string path_MACRO      = __FILE__; \
-        size_t pos_MACRO            = path_MACRO.find_last_of("\\/"); \
-        std::string extracted_MACRO = (pos_MACRO == std::string::npos) ? path_MACRO : path_MACRO.substr(pos_MACRO + 1); \
-        /* Get current time with milliseconds */ \
-        auto now_MACRO              = std::chrono::system_clock::now(); \
-        std::time_t t_MACRO         = std::chrono::system_clock::to_time_t(now_MACRO); \
-        std::tm tm_MACRO; \
-        localtime_r(&t_MACRO, &tm_MACRO); \
-        auto ms_MACRO = std::chrono::duration_cast<std::chrono::milliseconds>(now_MACRO.time_since_epoch()) % 1000; \
-        oss_MACRO << "\033[33m[" << std::put_time(&tm_MACRO, "%H:%M:%S") << "." << std::setfill('0') << std::setw(3) << ms_MACRO.count() << "] \033[34m[" << extracted_MACRO << ":" << __LINE__ << "]" << colour << " " << msg << "\033[0m" << std::endl; \
-        std::cout << oss_MACRO.str(); \
+        if constexpr ((level) >= ZP_LOG_MIN_LEVEL) \
+        { \
+            if (zp::log::level_enabled(ZP_LOG_MODULE, level)) \
+            { \
+                static zp::log::SiteThrottle zp_throttle_MACRO; \
+                if (allow) \
+                { \
+                    const std::uint64_t zp_suppressed_MACRO = zp::log::throttle_take_summary(&zp_throttle_MACRO); \
+                    if (zp_suppressed_MACRO > 0) \
+                    { \
+                        _DBG_EMIT(colour, zp_suppressed_MACRO << " messages suppressed"); \
+                    } \
+                    _DBG_EMIT(colour, msg); \
+                } \
+                else if (!zp_throttle_MACRO.registered.load(std::memory_order_relaxed)) \
+                { \
+                    zp::log::throttle_register(&zp_throttle_MACRO, zp::dbg::report_suppressed, nullptr, level, colour, zp::log::source_basename(__FILE__), __LINE__); \
+                } \
+            } \
+        } \
     } while (0)
 
-#endif
+#define LOG(msg)           _DECORATE_LOG(zp::log::Logger::INFO, "\033[0m", msg, false)
+#define TODO(msg)          _DECORATE_LOG(zp::log::Logger::INFO, "\033[32m", msg, false)
+#define ERR(msg)           _DECORATE_LOG(zp::log::Logger::ERROR, "\033[31m", msg, true)
+#define WARN(msg)          _DECORATE_LOG(zp::log::Logger::WARN, "\033[33m", msg, false)
+#define DEPR()             _DECORATE_LOG(zp::log::Logger::ERROR, "\033[31m", "DEPRECATED FUNCTION USED!", true)
 
-#define LOG(msg)           _DECORATE_LOG("\033[0m", msg, false)
-#define TODO(msg)          _DECORATE_LOG("\033[32m", msg, false)
-#define ERR(msg)           _DECORATE_LOG("\033[31m", msg, true)
-#define WARN(msg)          _DECORATE_LOG("\033[33m", msg, false)
-#define DEPR()             _DECORATE_LOG("\033[31m", "DEPRECATED FUNCTION USED!", true)
+// per_second lines with an equal burst, or 1 in n calls.
+#define LOG_RATE(per_second, msg)  _DECORATE_LOG_THROTTLED(zp::log::Logger::INFO, "\033[0m", zp::log::throttle_rate(&zp_throttle_MACRO, per_second, per_second), msg)
+#define WARN_RATE(per_second, msg) _DECORATE_LOG_THROTTLED(zp::log::Logger::WARN, "\033[33m", zp::log::throttle_rate(&zp_throttle_MACRO, per_second, per_second), msg)
+#define ERR_RATE(per_second, msg)  _DECORATE_LOG_THROTTLED(zp::log::Logger::ERROR, "\033[31m", zp::log::throttle_rate(&zp_throttle_MACRO, per_second, per_second), msg)
+#define LOG_SAMPLED(n, msg)        _DECORATE_LOG_THROTTLED(zp::log::Logger::INFO, "\033[0m", zp::log::throttle_sample(&zp_throttle_MACRO, n), msg)
 
 #define RGBCOL(x, r, g, b) "\033[38;2;" #r ";" #g ";" #b "m" << x << "\033[0m"
 
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "buff.hpp"
+#include "events.hpp"
+
+namespace zp
+{
+    // deferred event bus. producers enqueue typed events into one contiguous array per type, and dispatch_all later delivers
+    // them in two passes: first each type's array as one batch to its span handlers (void(span<const T>)), types in the order the
+    // queue first saw them; then one event at a time to per-event handlers in arrival order across all types, so a key press
+    // typed between two characters is handled between them. every enqueue takes the queue's next sequence number to order this.
+    // a coalesced type's events stand for the stream's state as of its newest event and are delivered together at that point.
+    // events enqueued by a handler are delivered by the next dispatch_all. each type can coalesce what it queues between
+    // dispatches, see Coalesce. not thread safe.
+    struct event_queue
+    {
+        struct Channel
+        {
+            std::shared_ptr<void> p_channel;                                // the event_channel<T>.
+            void (*begin)(void* p_channel);                                 // takes the pending events and delivers the batch.
+            bool (*next)(const void* p_channel, std::uint64_t* p_sequence); // sequence of the next event to deliver; false when done.
+            void (*deliver)(void* p_channel);                               // delivers it, or all that is left of a coalesced type.
+            std::size_t (*pending)(const void* p_channel);
+        };
+
+        struct State
+        {
+            std::vector<Channel> channels;    // indexed by queue_type_index<T>(); unused types are empty.
+            std::vector<std::uint32_t> order; // channel indices in the order the queue first saw them.
+            std::uint64_t next_sequence = 0;
+        };
+        State state;
+    };
+
+    // how enqueue folds a new event into the ones already waiting for the same dispatch.
+    enum class Coalesce
+    {
+        KEEP_ALL,    // every event is delivered.
+        KEEP_LATEST, // only the newest event is delivered.
+        ACCUMULATE,  // merge folds each event into the newest waiting one, e.g. summing deltas, unless it declines.
+    };
+
+    // one type's storage in an event_queue. dispatching keeps the previous batch's capacity, so steady-state frames never allocate.
+    template <typename T> struct event_channel
+    {
+        std::vector<T> pending;
+        std::vector<T> dispatching;
+        std::vector<std::uint64_t> pending_sequences; // per pending event, the sequence of the newest event folded into it.
+        std::vector<std::uint64_t> dispatching_sequences;
+        std::size_t delivered                   = 0; // dispatching events per-event handlers have already seen.
+        Coalesce coalesce                       = Coalesce::KEEP_ALL;
+        bool (*merge)(T* p_into, const T& next) = nullptr; // ACCUMULATE: folds next into p_into, or returns false to queue it separately.
+        Event<T> on_event;
+        Event<span<const T>> on_batch;
+    };
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // next_queue_type_index: Hands out the process-wide channel index of one event type. Called once per type by queue_type_index.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    std::uint32_t next_queue_type_index();
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // queue_type_index: T's channel index, shared by every event_queue.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename T> std::uint32_t queue_type_index();
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // queue_channel: T's channel in p_queue, created on first use.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename T> event_channel<T>* queue_channel(event_queue* p_queue);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // enqueue: Appends evt to its type's array for the next dispatch_all.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename T> void enqueue(event_queue* p_queue, T evt);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // queue_coalesce: Sets how T events queued between two dispatch_all calls are coalesced. merge is required for ACCUMULATE
+    // and ignored otherwise; ACCUMULATE without one returns ZC_INVALID_ARGUMENT and leaves the policy as it was. Applies from the
+    // next enqueue.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename T> Result queue_coalesce(event_queue* p_queue, Coalesce policy, bool (*merge)(T* p_into, const T& next) = nullptr);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // queue_subscribe: Calls handler once per T event in every dispatch_all.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename T> [[nodiscard]] subscription queue_subscribe(event_queue* p_queue, typename Event<T>::Listener handler);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // queue_subscribe_batch: Calls handler once per dispatch_all with every T event queued since the last one, before any
+    // per-event handler sees them. Not called for empty batches.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename T> [[nodiscard]] subscription queue_subscribe_batch(event_queue* p_queue, typename Event<span<const T>>::Listener handler);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // queue_forward: Triggers p_event with each T event on dispatch, so existing Event<T> subscribers see queued events.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename T> [[nodiscard]] subscription queue_forward(event_queue* p_queue, Event<T>* p_event);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // dispatch_all: Delivers everything queued so far, batches by type and then single events in arrival order, and empties the
+    // queue.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void dispatch_all(event_queue* p_queue);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // queue_pending: Events waiting for the next dispatch_all, across all types.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    std::size_t queue_pending(const event_queue* p_queue);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// queue_type_index: Assigned on first use, so indices stay dense across the types a program actually queues.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename T> std::uint32_t zp::queue_type_index()
+{
+    static const std::uint32_t index = next_queue_type_index();
+    return index;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// queue_channel: T's channel in p_queue, created on first use.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename T> zp::event_channel<T>* zp::queue_channel(event_queue* p_queue)
+{
+    const std::uint32_t index = queue_type_index<T>();
+    if (index >= p_queue->state.channels.size())
+    {
+        p_queue->state.channels.resize(index + 1);
+    }
+
+    event_queue::Channel& channel = p_queue->state.channels[index];
+    if (!channel.p_channel)
+    {
+        channel.p_channel = std::make_shared<event_channel<T>>();
+        channel.begin     = [](void* p)
+        {
+            event_channel<T>* p_channel = static_cast<event_channel<T>*>(p);
+            p_channel->dispatching.swap(p_channel->pending);
+            p_channel->dispatching_sequences.swap(p_channel->pending_sequences);
+            p_channel->delivered = 0;
+            if (!p_channel->dispatching.empty())
+            {
+                p_channel->on_batch.trigger(span<const T>{p_channel->dispatching.data(), p_channel->dispatching.size()});
+            }
+        };
+        channel.next      = [](const void* p, std::uint64_t* p_sequence)
+        {
+            const event_channel<T>* p_channel = static_cast<const event_channel<T>*>(p);
+            if (p_channel->delivered == p_channel->dispatching.size())
+            {
+                return false;
+            }
+            *p_sequence = p_channel->coalesce == Coalesce::KEEP_ALL ? p_channel->dispatching_sequences[p_channel->delivered] : p_channel->dispatching_sequences.back();
+            return true;
+        };
+        channel.deliver   = [](void* p)
+        {
+            event_channel<T>* p_channel = static_cast<event_channel<T>*>(p);
+            const std::size_t last      = p_channel->coalesce == Coalesce::KEEP_ALL ? p_channel->delivered + 1 : p_channel->dispatching.size();
+            while (p_channel->delivered < last)
+            {
+                p_channel->on_event.trigger(p_channel->dispatching[p_channel->delivered++]);
+            }
+
+            // cleared once done, keeping the capacity for the next frame.
+            if (p_channel->delivered == p_channel->dispatching.size())
+            {
+                p_channel->dispatching.clear();
+                p_channel->dispatching_sequences.clear();
+                p_channel->delivered = 0;
+            }
+        };
+        channel.pending   = [](const void* p) { return static_cast<const event_channel<T>*>(p)->pending.size(); };
+        p_queue->state.order.push_back(index);
+    }
+    return static_cast<event_channel<T>*>(channel.p_channel.get());
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// enqueue: Appends evt to its type's array, or folds it into the newest event there per the channel's Coalesce policy. Either
+// way the event it ends up in takes the queue's next sequence number.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename T> void zp::enqueue(event_queue* p_queue, T evt)
+{
+    event_channel<T>* p_channel  = queue_channel<T>(p_queue);
+    const std::uint64_t sequence = p_queue->state.next_sequence++;
+    if (p_channel->coalesce != Coalesce::KEEP_ALL && !p_channel->pending.empty())
+    {
+        if (p_channel->coalesce == Coalesce::KEEP_LATEST)
+        {
+            p_channel->pending.back()           = std::move(evt);
+            p_channel->pending_sequences.back() = sequence;
+            return;
+        }
+        if (p_channel->merge(&p_channel->pending.back(), evt))
+        {
+            p_channel->pending_sequences.back() = sequence;
+            return;
+        }
+    }
+    p_channel->pending.push_back(std::move(evt));
+    p_channel->pending_sequences.push_back(sequence);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// queue_coalesce: Sets how T events queued between two dispatch_all calls are coalesced. Rejects ACCUMULATE without a merge here
+// rather than letting the next enqueue call through a null pointer.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename T> zp::Result zp::queue_coalesce(event_queue* p_queue, Coalesce policy, bool (*merge)(T* p_into, const T& next))
+{
+    if (policy == Coalesce::ACCUMULATE && merge == nullptr)
+    {
+        return Result::ZC_INVALID_ARGUMENT;
+    }
+
+    event_channel<T>* p_channel = queue_channel<T>(p_queue);
+    p_channel->coalesce         = policy;
+    p_channel->merge            = merge;
+    return Result::ZC_SUCCESS;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// queue_subscribe: Calls handler once per T event in every dispatch_all.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename T> zp::subscription zp::queue_subscribe(event_queue* p_queue, typename Event<T>::Listener handler)
+{
+    return queue_channel<T>(p_queue)->on_event.subscribe(std::move(handler));
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// queue_subscribe_batch: Calls handler once per dispatch_all with every T event queued since the last one.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename T> zp::subscription zp::queue_subscribe_batch(event_queue* p_queue, typename Event<span<const T>>::Listener handler)
+{
+    return queue_channel<T>(p_queue)->on_batch.subscribe(std::move(handler));
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// queue_forward: Triggers p_event with each T event on dispatch. p_event must outlive the subscription.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename T> zp::subscription zp::queue_forward(event_queue* p_queue, Event<T>* p_event)
+{
+    return queue_subscribe<T>(p_queue, [p_event](const T& evt) { p_event->trigger(evt); });
+}
@@ -1,7 +1,11 @@
 #pragma once
 
-#include <forward_list>
-#include <functional>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "small_function.hpp"
 
 // ====================================================================================================================
 // ====================================================================================================================
@@ -9,39 +13,176 @@
 // ====================================================================================================================
 namespace zp
 {
-    template <typename T> class Event
+    // move-only handle returned by Event::subscribe. destroying or resetting it unsubscribes in O(1); it is safe to outlive
+    // the event, in which case it does nothing.
+    class subscription
     {
         public:
-        void subscribe(const std::function<void(T)>& callback)
+        using ReleaseFn = void (*)(void* p_slots, std::uint32_t index, std::uint32_t generation);
+
+        subscription() noexcept = default;
+        subscription(std::weak_ptr<void> p_slots, ReleaseFn p_release, std::uint32_t index, std::uint32_t generation) noexcept : p_slots(std::move(p_slots)), p_release(p_release), index(index), generation(generation) {}
+
+        subscription(subscription&& o) noexcept : p_slots(std::move(o.p_slots)), p_release(o.p_release), index(o.index), generation(o.generation) { o.p_release = nullptr; }
+
+        subscription& operator=(subscription&& o) noexcept
         {
-            auto it = listeners.before_begin();
-            for (auto next_it = listeners.begin(); next_it != listeners.end(); ++it, ++next_it)
+            if (this != &o)
             {
+                reset();
+                p_slots     = std::move(o.p_slots);
+                p_release   = o.p_release;
+                index       = o.index;
+                generation  = o.generation;
+                o.p_release = nullptr;
             }
-            listeners.insert_after(it, callback);
+            return *this;
         }
 
-        void unsubscribe(const std::function<void(T)>& callback)
+        subscription(const subscription&)            = delete;
+        subscription& operator=(const subscription&) = delete;
+
+        ~subscription() { reset(); }
+
+        void reset()
         {
-            listeners.remove_if([&](const std::function<void(T)>& item) { return is_same_callback(callback, item); });
+            if (p_release == nullptr)
+            {
+                return;
+            }
+            if (const std::shared_ptr<void> p_locked = p_slots.lock())
+            {
+                p_release(p_locked.get(), index, generation);
+            }
+            p_slots.reset();
+            p_release = nullptr;
+        }
+
+        explicit operator bool() const noexcept { return p_release != nullptr; }
+
+        private:
+        std::weak_ptr<void> p_slots;
+        ReleaseFn p_release      = nullptr;
+        std::uint32_t index      = 0;
+        std::uint32_t generation = 0;
+    };
+
+    // listeners live in a slot array. subscribe fills a free slot and returns a subscription naming it by index and
+    // generation, so unsubscribing is O(1) and a stale token can never release a reused slot. trigger walks the slots with no
+    // allocation. listeners may subscribe and unsubscribe mid-trigger: slots released during a trigger are reclaimed once it
+    // returns, and slots added during one are first called on the next.
+    template <typename T> class Event
+    {
+        public:
+        using Listener = small_function<void(const T&)>;
+
+        Event()                        = default;
+        Event(Event&&)                 = default;
+        Event& operator=(Event&&)      = default;
+        Event(const Event&)            = delete;
+        Event& operator=(const Event&) = delete;
+
+        [[nodiscard]] subscription subscribe(Listener callback)
+        {
+            if (!p_slots)
+            {
+                p_slots = std::make_shared<Slots>();
+            }
+
+            std::uint32_t index = 0;
+            if (!p_slots->free.empty() && p_slots->depth == 0)
+            {
+                index = p_slots->free.back();
+                p_slots->free.pop_back();
+            }
+            else
+            {
+                index = static_cast<std::uint32_t>(p_slots->slots.size());
+                p_slots->slots.emplace_back();
+            }
+
+            Slot& slot    = p_slots->slots[index];
+            slot.listener = std::move(callback);
+            slot.is_live  = true;
+            ++p_slots->live;
+            return subscription(p_slots, &Event::release, index, slot.generation);
         }
 
         void trigger(const T& data)
         {
-            auto listeners_copy = listeners;
-            for (auto& listener : listeners_copy)
+            if (!p_slots || p_slots->live == 0)
             {
-                listener(data);
+                return;
+            }
+
+            // hold the slots so a listener destroying this event mid-trigger cannot free them under the loop.
+            const std::shared_ptr<Slots> p_held = p_slots;
+            const std::size_t count             = p_held->slots.size();
+            ++p_held->depth;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const Slot& slot = p_held->slots[i];
+                if (slot.is_live)
+                {
+                    slot.listener(data);
+                }
+            }
+            if (--p_held->depth == 0 && !p_held->released.empty())
+            {
+                reclaim(p_held.get());
             }
         }
 
+        std::size_t listener_count() const { return p_slots ? p_slots->live : 0; }
+
         private:
-        static bool is_same_callback(const std::function<void(T)>& lhs, const std::function<void(T)>& rhs)
+        struct Slot
+        {
+            Listener listener;
+            std::uint32_t generation = 0;
+            bool is_live             = false;
+        };
+
+        // a deque so slots added mid-trigger never move the one being called.
+        struct Slots
         {
-            return lhs.target_type() == rhs.target_type() && lhs.template target<void(T)>() == rhs.template target<void(T)>();
+            std::deque<Slot> slots;
+            std::vector<std::uint32_t> free;
+            std::vector<std::uint32_t> released; // released mid-trigger; their listeners may still be running.
+            std::size_t live    = 0;
+            std::uint32_t depth = 0;
+        };
+
+        static void release(void* p, std::uint32_t index, std::uint32_t generation)
+        {
+            Slots* p_s = static_cast<Slots*>(p);
+            Slot& slot = p_s->slots[index];
+            if (slot.generation != generation || !slot.is_live)
+            {
+                return;
+            }
+
+            slot.is_live = false;
+            ++slot.generation;
+            --p_s->live;
+            p_s->released.push_back(index);
+            if (p_s->depth == 0)
+            {
+                reclaim(p_s);
+            }
+        }
+
+        static void reclaim(Slots* p_s)
+        {
+            for (const std::uint32_t index : p_s->released)
+            {
+                p_s->slots[index].listener = {};
+                p_s->free.push_back(index);
+            }
+            p_s->released.clear();
         }
 
-        std::forward_list<std::function<void(T)>> listeners;
+        std::shared_ptr<Slots> p_slots;
     };
 
     struct Void
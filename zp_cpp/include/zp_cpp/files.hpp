@@ -2,10 +2,16 @@
 
 #include "core.hpp"
 #include "buff.hpp"
+#include "hash.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <future>
+#include <memory>
 #include <unordered_map>
 #include <functional>
+#include <vector>
 
 namespace zp::files
 {
@@ -17,12 +23,21 @@ namespace zp::files
             std::function<void(const std::filesystem::path&)> on_file_created;
             std::function<void(const std::filesystem::path&)> on_file_modified;
             std::function<void(const std::filesystem::path&)> on_file_destroyed;
+            bool hash_contents = false;
         };
         Config config;
 
+        struct Record
+        {
+            std::filesystem::file_time_type last_write;
+            std::uintmax_t size;
+            bool has_content_hash;
+            zp::hash::hash256 content_hash;
+        };
+
         struct State
         {
-            std::unordered_map<std::filesystem::path, std::filesystem::file_time_type> known;
+            std::unordered_map<std::filesystem::path, Record> known;
         };
         State state;
     };
@@ -42,10 +57,49 @@ namespace zp::files
         State state;
     };
 
+    struct async_writer
+    {
+        struct Config
+        {
+            std::size_t max_queued = 256;
+            std::size_t max_batch  = 32;
+        };
+        Config config;
+
+        struct Metrics
+        {
+            std::size_t queue_depth;
+            std::size_t bytes_in_flight;
+            std::uint64_t writes_completed;
+            std::uint64_t writes_failed;
+            std::uint64_t last_latency_ns;
+            std::uint64_t max_latency_ns;
+            std::uint64_t total_latency_ns;
+            std::uint64_t p50_latency_ns;
+            std::uint64_t p99_latency_ns;
+            std::uint64_t p999_latency_ns;
+        };
+
+        struct State
+        {
+            struct Internal;
+
+            Internal* p_i = nullptr;
+        };
+        State state;
+    };
+
     Result read_file(const std::filesystem::path& path, span<std::byte> buffer, span<std::byte>* p_out);
     Result write_file(const std::filesystem::path& path, span<const std::byte> data);
 
+    void start_writer(async_writer* p_writer);
+    void stop_writer(async_writer* p_writer);
+    Result write_file_async(async_writer* p_writer, const std::filesystem::path& path, std::shared_ptr<const std::vector<std::byte>> data, std::future<Result>* p_out);
+    async_writer::Metrics get_metrics(const async_writer* p_writer);
+
     void poll_dir(dir_watcher* p_dir_watcher);
+    Result save_snapshot(const dir_watcher* p_dir_watcher, const std::filesystem::path& snapshot_path);
+    Result load_snapshot(dir_watcher* p_dir_watcher, const std::filesystem::path& snapshot_path);
 
     bool has_changed(file_watcher_t* p_file_watcher);
 };
\ No newline at end of file
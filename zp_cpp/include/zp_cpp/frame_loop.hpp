@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "stats.hpp"
+#include "time.hpp"
+
+namespace zp
+{
+    // fixed-timestep loop: simulation advances in whole sim_step_ns steps while rendering runs once per frame with the leftover
+    // fraction of a step as the interpolation alpha. every frame runs the stages in the same order:
+    //   poll_input -> receive -> simulate x N -> send -> update_ui -> render(alpha)
+    // which is where platform::poll_events, net handle_incoming, net handle_outgoing and ui::update belong. unset stages are skipped.
+    // time comes from clock::now_ns, so under a virtual clock the loop runs as fast or as slow as that clock says.
+    struct frame_loop
+    {
+        struct Config
+        {
+            ens sim_step_ns                   = 16'666'667; // 60 Hz simulation.
+            ens target_frame_ns               = 0;          // render pacing. 0 renders as fast as the stages allow.
+            std::uint32_t max_steps_per_frame = 5;          // catch-up clamp: simulation time beyond this many steps is dropped.
+            ens spin_ns                       = 1'000'000;  // the last stretch of each pacing wait is spun, the rest slept.
+        };
+        Config config;
+
+        struct Stages
+        {
+            std::function<void()> poll_input;
+            std::function<void()> receive;
+            std::function<void(ens step_ns)> simulate;
+            std::function<void()> send;
+            std::function<void()> update_ui;
+            std::function<void(float alpha)> render;
+        };
+        Stages stages;
+
+        struct State
+        {
+            struct Internal;
+
+            Internal* p_i               = nullptr;
+            std::uint64_t frames        = 0;
+            std::uint64_t sim_steps     = 0;
+            std::uint64_t dropped_steps = 0; // steps skipped by the catch-up clamp.
+            float alpha                 = 0.0f;
+        };
+        State state;
+    };
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // loop_init: Allocates the loop's timing state. The first frame starts timing from here.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void loop_init(frame_loop* p_loop);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // loop_exit: Releases the loop's timing state and histograms.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void loop_exit(frame_loop* p_loop);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // loop_frame: Runs one frame of stages, then waits out the rest of target_frame_ns.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void loop_frame(frame_loop* p_loop);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // loop_run: Runs frames until keep_running returns false. It is checked before every frame.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void loop_run(frame_loop* p_loop, const std::function<bool()>& keep_running);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // loop_frame_times: Start-to-start frame intervals in nanoseconds, pacing included.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    const stats::histogram* loop_frame_times(const frame_loop* p_loop);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // loop_work_times: Time spent in the stages of each frame, pacing excluded.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    const stats::histogram* loop_work_times(const frame_loop* p_loop);
+}
@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <cstddef>
 #include <string>
+#include <string_view>
 
 namespace zp::hash
 {
@@ -19,6 +20,8 @@ namespace zp::hash
     hash256 hash_data(const void* data, std::uint64_t size) noexcept;
     hash256 hash_data(zp::span<const std::byte> data) noexcept;
 
+    std::uint64_t hash_str(std::string_view str) noexcept;
+
     std::string to_str(const hash256& h);
 
     bool operator==(const hash256& a, const hash256& b) noexcept;
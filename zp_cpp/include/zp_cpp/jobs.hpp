@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "small_function.hpp"
+
+// work-stealing job system shared by the whole library. every worker owns a Chase-Lev deque: it pushes and pops its own jobs
+// at the bottom, LIFO, while idle workers steal from the top, FIFO, so thieves take the oldest and usually largest pieces of a
+// split range. threads outside the pool submit through a shared injection queue. the thread that calls init is worker 0 and
+// only runs jobs while it waits. until init, or after shutdown, every call runs its work inline on the calling thread, so
+// library code can use jobs unconditionally.
+namespace zp::jobs
+{
+    // per-worker deque capacity in jobs. a job pushed to a full deque runs inline instead.
+    constexpr std::uint32_t DEQUE_CAPACITY = 4096;
+
+    struct Config
+    {
+        std::uint32_t worker_count = 0;     // workers including the caller of init. 0 picks one per hardware thread.
+        bool pin_workers           = false; // pins worker i to core i modulo the core count. linux only.
+    };
+
+    // counts the jobs submitted against it that have not finished yet. wait on it to fence a batch.
+    struct counter
+    {
+        std::atomic<std::uint32_t> pending = 0;
+    };
+
+    using Job = small_function<void()>;
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // init: Starts config.worker_count - 1 worker threads and makes the caller worker 0. Preallocates the job nodes the pool
+    // recycles, so jobs submitted later allocate nothing unless a job's captures do. Not reentrant; call shutdown first to restart
+    // with a different config.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void init(const Config& config);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // shutdown: Lets the workers finish every queued job, then joins them. Call from the thread that called init, once nothing
+    // else is submitting. Jobs submitted afterwards run inline.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void shutdown();
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // worker_count: Workers in the running pool including worker 0, or 1 when no pool is running.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    std::uint32_t worker_count();
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // worker_index: The calling thread's worker index, or -1 for threads outside the pool.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    std::int32_t worker_index();
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // run: Queues job, counting it against p_counter if one is given until it has finished.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void run(Job job, counter* p_counter = nullptr);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // wait: Returns once p_counter reaches zero, running queued jobs in the meantime so waiting inside a job cannot deadlock.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void wait(counter* p_counter);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // parallel_for_erased: parallel_for behind a function pointer. body is called as body(p_body, first, last) for half-open
+    // subranges.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void parallel_for_erased(std::uint64_t begin, std::uint64_t end, std::uint64_t grain, void (*body)(const void* p_body, std::uint64_t first, std::uint64_t last), const void* p_body);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // parallel_for: Calls body(first, last) over disjoint half-open subranges covering [begin, end) and returns when all have
+    // run. Ranges split lazily: a worker only halves what it has left while its own deque is empty, so splitting tracks
+    // demand from thieves and a range nobody steals from runs as grain-sized chunks with no queueing at all. grain 0 picks
+    // one eighth of an even share per worker.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename Body> void parallel_for(std::uint64_t begin, std::uint64_t end, const Body& body, std::uint64_t grain = 0)
+    {
+        parallel_for_erased(begin, end, grain, [](const void* p_body, std::uint64_t first, std::uint64_t last) { (*static_cast<const Body*>(p_body))(first, last); }, &body);
+    }
+}
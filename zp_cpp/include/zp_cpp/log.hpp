@@ -1,9 +1,31 @@
 #pragma once
 
+#include <algorithm>
 #include <fstream>
 #include <string>
 #include <mutex>
 #include <filesystem>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+
+#include "core.hpp"
+#include "time.hpp"
+
+// sites below this level compile to nothing. 0 = INFO, 1 = WARN, 2 = ERROR.
+#ifndef ZP_LOG_MIN_LEVEL
+#define ZP_LOG_MIN_LEVEL 0
+#endif
+
+// runtime level mask a translation unit's sites are checked against. define before any include to tag a source file.
+#ifndef ZP_LOG_MODULE
+#define ZP_LOG_MODULE zp::log::MODULE_DEFAULT
+#endif
 
 // =========================================================================================================================================
 // =========================================================================================================================================
@@ -20,56 +42,428 @@ namespace zp::log
             ERROR = 2
         };
 
+        // async loggers hand each formatted line to a per-thread ring; a single writer thread batches the rings into large writes
+        // every flush_interval_ms. a producer whose ring is full wakes the writer and yields until it has room, with no bound: if
+        // the writer stalls (a blocked disk), logging threads stall with it rather than drop or reorder lines. rotation starts a
+        // new segment once the active file reaches rotate_bytes or rotate_interval_ms (0 disables either): the closed segment is
+        // renamed to <stem>.<YYYYmmdd-HHMMSS>.<n><ext> and, with compress_segments, compressed to <segment>.zplz on a
+        // low-priority thread. set before init.
+        struct Config
+        {
+            bool async                       = false;
+            bool binary                      = false;
+            bool compress_segments           = false;
+            std::size_t ring_bytes           = 64 * 1024;
+            std::uint32_t flush_interval_ms  = 50;
+            std::uint64_t rotate_bytes       = 0;
+            std::uint32_t rotate_interval_ms = 0;
+        };
+        Config config;
+
+        struct Internal;
+
+        // the file is written through a POSIX descriptor rather than a stream so the writer, the rotator and the fatal-signal drain
+        // can share it with write(2). file sinks need open/write/sigaction; only preallocation and the writer's priority are linux-only.
         std::filesystem::path file_path;
-        std::ofstream file_stream;
+        std::atomic<int> fd = -1;
         std::mutex log_mutex;
         bool initialised;
+        Internal* p_i = nullptr;
+
+        // binary mode: number of call sites whose definition records have been written to this file.
+        std::atomic<std::uint32_t> sites_written;
+    };
+
+    // argument encodings of binary records. integers are widened to 64 bits, strings are a u32 length followed by the bytes.
+    enum ArgType : std::uint8_t
+    {
+        ARG_INT     = 1,
+        ARG_UINT    = 2,
+        ARG_DOUBLE  = 3,
+        ARG_BOOL    = 4,
+        ARG_CHAR    = 5,
+        ARG_STRING  = 6,
+        ARG_POINTER = 7,
+    };
+
+    // binary file layout: a sequence of records, each starting with a tag byte.
+    //   RECORD_HEADER  u32 magic, u32 version, f64 tsc_hz, u64 anchor_tsc, i64 anchor_unix_ns. written by every init.
+    //   RECORD_SITE    u32 site, u8 level, u32 line, u8 arg_count, u8 arg_types[arg_count], u16 file_len, file, u16 fmt_len, fmt.
+    //   RECORD_LOG     u32 site, u64 tsc, u32 payload_len, payload.
+    constexpr std::uint32_t BINARY_MAGIC   = 0x4c42505a; // "ZPBL" little endian
+    constexpr std::uint32_t BINARY_VERSION = 1;
+    constexpr std::uint8_t RECORD_HEADER   = 1;
+    constexpr std::uint8_t RECORD_SITE     = 2;
+    constexpr std::uint8_t RECORD_LOG      = 3;
+
+    constexpr std::uint32_t MAX_MODULES = 32;
+
+    enum Module : std::uint32_t
+    {
+        MODULE_DEFAULT = 0,
+        MODULE_NET     = 1,
+        MODULE_HASH    = 2,
+        MODULE_UI      = 3,
+        MODULE_USER    = 16, // first id free for applications, up to MAX_MODULES - 1.
+    };
+
+    // bit n set = level n disabled for that module. zero-initialised, so everything is enabled until set_module_level runs.
+    inline std::atomic<std::uint32_t> disabled_levels[MAX_MODULES];
+
+    // how often a throttled site may report what it dropped.
+    constexpr std::int64_t SUPPRESSION_SUMMARY_NS = 1'000'000'000;
+
+    // per-call-site state behind the rate-limited and sampled macros. one static instance per site, updated without locks.
+    // the first dropped call registers the site with the summary thread, which reports its counter even after the flood stops;
+    // the registration fields below are only touched under the registry lock.
+    struct SiteThrottle
+    {
+        using ReportFn = void (*)(const SiteThrottle* p_throttle, std::uint64_t suppressed);
+
+        std::atomic<std::int64_t> tat_ns          = 0; // earliest time the bucket is full again (GCRA theoretical arrival time).
+        std::atomic<std::uint64_t> calls          = 0;
+        std::atomic<std::uint64_t> suppressed     = 0;
+        std::atomic<std::int64_t> last_summary_ns = 0;
+        std::atomic<bool> registered              = false;
+
+        ReportFn report     = nullptr;
+        Logger* logger      = nullptr; // nullptr for console sites.
+        Logger::Level level = Logger::INFO;
+        const char* colour  = nullptr;
+        const char* file    = nullptr;
+        int line            = 0;
     };
 
     void init(Logger* logger, const std::filesystem::path& file_path);
     void cleanup(Logger* logger);
     void log(Logger* logger, Logger::Level level, const std::string& message);
+
+    // registers a binary call site once (from a function-local static) and returns its id.
+    std::uint32_t register_site(Logger::Level level, const char* file, int line, const char* fmt, const std::uint8_t* arg_types, std::uint8_t arg_count);
+
+    // submits an encoded RECORD_LOG. text loggers format it immediately instead.
+    void write_record(Logger* logger, std::uint32_t site_id, const std::string& record);
+
+    // reused per-thread buffer that log_binary encodes into.
+    std::string* record_buffer();
+
+    // reused per-thread buffer that log_format formats into.
+    std::string* format_buffer();
+
+    // registers a throttled site with the summary thread, which runs every SUPPRESSION_SUMMARY_NS / 4 and hands each site's dropped
+    // count to report once the site's summary window has passed. the thread starts with the first registration. sites writing to a
+    // logger are reported one last time and unregistered by its cleanup.
+    void throttle_register(SiteThrottle* p_throttle, SiteThrottle::ReportFn report, Logger* logger, Logger::Level level, const char* colour, const char* file, int line);
+
+    // reports every registered site whose summary is due. called by the summary thread; exposed for tests.
+    void throttle_flush_summaries();
+
+    // ReportFn of ZP_LOG_THROTTLED sites: writes "N messages suppressed" to the site's logger.
+    void report_suppressed(const SiteThrottle* p_throttle, std::uint64_t suppressed);
+
+    // enables level and above for module at runtime. sites below ZP_LOG_MIN_LEVEL stay compiled out regardless.
+    void set_module_level(std::uint32_t module, Logger::Level min_level);
+
+    // turns a binary log file, or a compressed .zplz segment of one, into one text line or one JSON object per record.
+    Result decode_binary(const std::filesystem::path& path, std::ostream& out, bool json);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // level_enabled: Runtime check every enabled site performs: one relaxed load and a bit test.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline bool level_enabled(std::uint32_t module, Logger::Level level) noexcept
+    {
+        return (disabled_levels[module].load(std::memory_order_relaxed) & (1u << level)) == 0;
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // throttle_now_ns: Monotonic clock the site throttles measure against. The TSC-backed read keeps suppressed calls cheap.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline std::int64_t throttle_now_ns() noexcept
+    {
+        return static_cast<std::int64_t>(zp::clock::fast_ns());
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // throttle_rate: Token bucket of burst tokens refilled at per_second, expressed as a single theoretical arrival time so one CAS
+    // both checks and takes a token. Returns false and counts the call as suppressed once the bucket is empty.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline bool throttle_rate(SiteThrottle* p_throttle, std::uint32_t per_second, std::uint32_t burst) noexcept
+    {
+        const std::int64_t interval = 1'000'000'000 / std::max<std::int64_t>(per_second, 1);
+        const std::int64_t window   = interval * std::max<std::int64_t>(burst, 1);
+        const std::int64_t now      = throttle_now_ns();
+
+        std::int64_t tat = p_throttle->tat_ns.load(std::memory_order_relaxed);
+        while (true)
+        {
+            const std::int64_t next = std::max(tat, now) + interval;
+            if (next - now > window)
+            {
+                p_throttle->suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (p_throttle->tat_ns.compare_exchange_weak(tat, next, std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // throttle_sample: Lets the first of every n calls through and counts the rest as suppressed.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline bool throttle_sample(SiteThrottle* p_throttle, std::uint32_t n) noexcept
+    {
+        if (p_throttle->calls.fetch_add(1, std::memory_order_relaxed) % std::max<std::uint32_t>(n, 1) == 0)
+        {
+            return true;
+        }
+        p_throttle->suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // throttle_take_summary: Called when a throttled site is about to emit. Returns how many calls it dropped since its last summary,
+    // or 0 when nothing was dropped or a summary went out less than SUPPRESSION_SUMMARY_NS ago. One thread wins each summary.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline std::uint64_t throttle_take_summary(SiteThrottle* p_throttle) noexcept
+    {
+        if (p_throttle->suppressed.load(std::memory_order_relaxed) == 0)
+        {
+            return 0;
+        }
+
+        const std::int64_t now = throttle_now_ns();
+        std::int64_t last      = p_throttle->last_summary_ns.load(std::memory_order_relaxed);
+        if (last != 0 && now - last < SUPPRESSION_SUMMARY_NS)
+        {
+            return 0;
+        }
+        if (!p_throttle->last_summary_ns.compare_exchange_strong(last, now, std::memory_order_relaxed))
+        {
+            return 0;
+        }
+
+        return p_throttle->suppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // source_basename: File name part of __FILE__, resolved at compile time.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    consteval const char* source_basename(const char* path)
+    {
+        const char* base = path;
+        for (const char* p = path; *p != '\0'; ++p)
+        {
+            if (*p == '/' || *p == '\\')
+            {
+                base = p + 1;
+            }
+        }
+        return base;
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // log_format: std::format-based text path behind ZP_LOG_*. Formats "[file:line] message" into a reused thread-local buffer.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename... Ts> void log_format(Logger* logger, Logger::Level level, const char* file, int line, std::format_string<Ts...> fmt, Ts&&... args)
+    {
+        std::string* p_buffer = format_buffer();
+        p_buffer->clear();
+        std::format_to(std::back_inserter(*p_buffer), "[{}:{}] ", file, line);
+        std::format_to(std::back_inserter(*p_buffer), fmt, std::forward<Ts>(args)...);
+        log(logger, level, *p_buffer);
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // arg_type: Maps an argument type to its binary encoding at compile time.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename T> constexpr std::uint8_t arg_type()
+    {
+        using U = std::remove_cvref_t<T>;
+        if constexpr (std::is_same_v<U, bool>)
+        {
+            return ARG_BOOL;
+        }
+        else if constexpr (std::is_same_v<U, char>)
+        {
+            return ARG_CHAR;
+        }
+        else if constexpr (std::is_integral_v<U>)
+        {
+            return std::is_signed_v<U> ? ARG_INT : ARG_UINT;
+        }
+        else if constexpr (std::is_floating_point_v<U>)
+        {
+            return ARG_DOUBLE;
+        }
+        else if constexpr (std::is_convertible_v<const U&, std::string_view>)
+        {
+            return ARG_STRING;
+        }
+        else
+        {
+            static_assert(std::is_pointer_v<U>, "binary log arguments must be arithmetic, string-like or pointers");
+            return ARG_POINTER;
+        }
+    }
+
+    template <typename... Ts> struct ArgTypes
+    {
+        static constexpr std::uint8_t count                     = sizeof...(Ts);
+        static constexpr std::uint8_t values[sizeof...(Ts) + 1] = {arg_type<Ts>()..., 0};
+    };
+
+    // only used inside decltype to name the ArgTypes of a macro's arguments without evaluating them.
+    template <typename... Ts> ArgTypes<Ts...> arg_types_of(const Ts&...);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // encode_arg: Appends the raw bytes of one argument to a record.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename T> void encode_arg(std::string* p_record, const T& value)
+    {
+        constexpr std::uint8_t type = arg_type<T>();
+        if constexpr (type == ARG_STRING)
+        {
+            const std::string_view text = value;
+            const std::uint32_t size    = static_cast<std::uint32_t>(text.size());
+            p_record->append(reinterpret_cast<const char*>(&size), sizeof(size));
+            p_record->append(text.data(), text.size());
+        }
+        else
+        {
+            std::uint64_t bits = 0;
+            if constexpr (type == ARG_INT)
+            {
+                const std::int64_t wide = static_cast<std::int64_t>(value);
+                std::memcpy(&bits, &wide, sizeof(bits));
+            }
+            else if constexpr (type == ARG_DOUBLE)
+            {
+                const double wide = static_cast<double>(value);
+                std::memcpy(&bits, &wide, sizeof(bits));
+            }
+            else if constexpr (type == ARG_POINTER)
+            {
+                bits = reinterpret_cast<std::uintptr_t>(value);
+            }
+            else
+            {
+                bits = static_cast<std::uint64_t>(value);
+            }
+            p_record->append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+        }
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // log_binary: Encodes a RECORD_LOG of site id, TSC timestamp and raw argument bytes. No formatting happens on this path.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename... Ts> void log_binary(Logger* logger, std::uint32_t site_id, const Ts&... args)
+    {
+        std::string* p_record = record_buffer();
+        p_record->clear();
+
+        const std::uint64_t tsc     = zp::clock::ticks();
+        const std::uint32_t no_size = 0;
+        p_record->push_back(static_cast<char>(RECORD_LOG));
+        p_record->append(reinterpret_cast<const char*>(&site_id), sizeof(site_id));
+        p_record->append(reinterpret_cast<const char*>(&tsc), sizeof(tsc));
+        p_record->append(reinterpret_cast<const char*>(&no_size), sizeof(no_size));
+
+        (encode_arg(p_record, args), ...);
+
+        const std::uint32_t payload_size = static_cast<std::uint32_t>(p_record->size() - 17);
+        std::memcpy(p_record->data() + 13, &payload_size, sizeof(payload_size));
+        write_record(logger, site_id, *p_record);
+    }
 }
 
 // =========================================================================================================================================
 // =========================================================================================================================================
 // =========================================================================================================================================
 // =========================================================================================================================================
-#define ZP_LOG_INFO(logger, msg) \
+// std::format syntax. a site below ZP_LOG_MIN_LEVEL is discarded at compile time; an enabled one costs a relaxed load and a branch
+// until its module's level lets it through.
+#define ZP_LOG_AT(logger, level, fmt, ...) \
     do { \
-        if ((logger) && (logger)->initialised) \
+        if constexpr ((level) >= ZP_LOG_MIN_LEVEL) \
         { \
-            std::ostringstream oss; \
-            std::string path     = __FILE__; \
-            size_t pos           = path.find_last_of("\\/"); \
-            std::string filename = (pos == std::string::npos) ? path : path.substr(pos + 1); \
-            oss << "[" << filename << ":" << __LINE__ << "] " << msg; \
-            zp::log::log(logger, zp::log::Logger::INFO, oss.str()); \
+            if (zp::log::level_enabled(ZP_LOG_MODULE, level) && (logger) && (logger)->initialised) \
+            { \
+                zp::log::log_format(logger, level, zp::log::source_basename(__FILE__), __LINE__, fmt __VA_OPT__(, ) __VA_ARGS__); \
+            } \
         } \
     } while (0)
 
-#define ZP_LOG_WARN(logger, msg) \
+#define ZP_LOG_INFO(logger, fmt, ...)  ZP_LOG_AT(logger, zp::log::Logger::INFO, fmt __VA_OPT__(, ) __VA_ARGS__)
+#define ZP_LOG_WARN(logger, fmt, ...)  ZP_LOG_AT(logger, zp::log::Logger::WARN, fmt __VA_OPT__(, ) __VA_ARGS__)
+#define ZP_LOG_ERROR(logger, fmt, ...) ZP_LOG_AT(logger, zp::log::Logger::ERROR, fmt __VA_OPT__(, ) __VA_ARGS__)
+
+// hot-path variants. each site owns a static SiteThrottle: RATE_LIMITED allows burst lines then per_second, SAMPLED keeps 1 in n.
+// dropped calls are reported as "N messages suppressed" ahead of the next emitted line, at most once per SUPPRESSION_SUMMARY_NS, and
+// by the summary thread when the site goes quiet.
+#define ZP_LOG_THROTTLED(logger, level, allow, fmt, ...) \
     do { \
-        if ((logger) && (logger)->initialised) \
+        if constexpr ((level) >= ZP_LOG_MIN_LEVEL) \
         { \
-            std::ostringstream oss; \
-            std::string path     = __FILE__; \
-            size_t pos           = path.find_last_of("\\/"); \
-            std::string filename = (pos == std::string::npos) ? path : path.substr(pos + 1); \
-            oss << "[" << filename << ":" << __LINE__ << "] " << msg; \
-            zp::log::log(logger, zp::log::Logger::WARN, oss.str()); \
+            if (zp::log::level_enabled(ZP_LOG_MODULE, level) && (logger) && (logger)->initialised) \
+            { \
+                static zp::log::SiteThrottle zp_throttle_MACRO; \
+                if (allow) \
+                { \
+                    const std::uint64_t zp_suppressed_MACRO = zp::log::throttle_take_summary(&zp_throttle_MACRO); \
+                    if (zp_suppressed_MACRO > 0) \
+                    { \
+                        zp::log::log_format(logger, level, zp::log::source_basename(__FILE__), __LINE__, "{} messages suppressed", zp_suppressed_MACRO); \
+                    } \
+                    zp::log::log_format(logger, level, zp::log::source_basename(__FILE__), __LINE__, fmt __VA_OPT__(, ) __VA_ARGS__); \
+                } \
+                else if (!zp_throttle_MACRO.registered.load(std::memory_order_relaxed)) \
+                { \
+                    zp::log::throttle_register(&zp_throttle_MACRO, zp::log::report_suppressed, logger, level, nullptr, zp::log::source_basename(__FILE__), __LINE__); \
+                } \
+            } \
         } \
     } while (0)
 
-#define ZP_LOG_ERROR(logger, msg) \
+#define ZP_LOG_RATE_LIMITED(logger, level, per_second, burst, fmt, ...) ZP_LOG_THROTTLED(logger, level, zp::log::throttle_rate(&zp_throttle_MACRO, per_second, burst), fmt __VA_OPT__(, ) __VA_ARGS__)
+#define ZP_LOG_SAMPLED(logger, level, n, fmt, ...)                      ZP_LOG_THROTTLED(logger, level, zp::log::throttle_sample(&zp_throttle_MACRO, n), fmt __VA_OPT__(, ) __VA_ARGS__)
+
+// binary call sites: fmt uses {} placeholders and must be a string literal. the site is registered once; each call then only copies
+// its arguments. on a text logger the record is formatted immediately, so the macros work in either mode.
+#define ZP_LOGB(logger, level, fmt, ...) \
     do { \
-        if ((logger) && (logger)->initialised) \
+        if constexpr ((level) >= ZP_LOG_MIN_LEVEL) \
         { \
-            std::ostringstream oss; \
-            std::string path     = __FILE__; \
-            size_t pos           = path.find_last_of("\\/"); \
-            std::string filename = (pos == std::string::npos) ? path : path.substr(pos + 1); \
-            oss << "[" << filename << ":" << __LINE__ << "] " << msg; \
-            zp::log::log(logger, zp::log::Logger::ERROR, oss.str()); \
+            if (zp::log::level_enabled(ZP_LOG_MODULE, level) && (logger) && (logger)->initialised) \
+            { \
+                using zp_types_MACRO                     = decltype(zp::log::arg_types_of(__VA_ARGS__)); \
+                static const std::uint32_t zp_site_MACRO = zp::log::register_site(level, zp::log::source_basename(__FILE__), __LINE__, fmt, zp_types_MACRO::values, zp_types_MACRO::count); \
+                zp::log::log_binary(logger, zp_site_MACRO __VA_OPT__(, ) __VA_ARGS__); \
+            } \
         } \
     } while (0)
+
+#define ZP_LOGB_INFO(logger, fmt, ...)  ZP_LOGB(logger, zp::log::Logger::INFO, fmt __VA_OPT__(, ) __VA_ARGS__)
+#define ZP_LOGB_WARN(logger, fmt, ...)  ZP_LOGB(logger, zp::log::Logger::WARN, fmt __VA_OPT__(, ) __VA_ARGS__)
+#define ZP_LOGB_ERROR(logger, fmt, ...) ZP_LOGB(logger, zp::log::Logger::ERROR, fmt __VA_OPT__(, ) __VA_ARGS__)
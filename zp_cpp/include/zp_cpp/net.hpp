@@ -1,10 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 
-#include "zp_cpp/events.hpp"
+#include "zp_cpp/async.hpp"
+#include "zp_cpp/concurrent_event.hpp"
 
 namespace zp::net
 {
@@ -20,6 +22,7 @@ namespace zp::net
         using NetId                                               = void*;
 
         constexpr std::uint32_t DISCONNECT_ALL_CLIENTS_TIMEOUT_MS = 2000;
+        constexpr std::uint32_t DISCONNECT_CLIENT_TIMEOUT_MS      = 2000;
 
         struct ClientConnectedEvt
         {
@@ -64,13 +67,15 @@ namespace zp::net
 
             Transient transient;
 
-            zp::Event<ClientConnectedEvt> on_client_connected;
-            zp::Event<ClientDisconnectedEvt> on_client_disconnected;
+            // concurrent so they can be subscribed from the game thread while triggered from a network thread.
+            zp::concurrent_event<ClientConnectedEvt> on_client_connected;
+            zp::concurrent_event<ClientDisconnectedEvt> on_client_disconnected;
         };
 
         bool start_server(Instance* p_inst);
         void stop_server(Instance* p_inst);
 
+        // returns at once; the peer is force reset from handle_incoming if it has not acked within DISCONNECT_CLIENT_TIMEOUT_MS.
         void disconnect_client(Instance* p_inst, NetId client);
         void disconnect_all_clients(Instance* p_inst);
 
@@ -84,6 +89,9 @@ namespace zp::net
 
     namespace client
     {
+        constexpr std::uint32_t CONNECT_TIMEOUT_MS    = 5000;
+        constexpr std::uint32_t DISCONNECT_TIMEOUT_MS = 2000;
+
         struct NetEvent
         {
             EventId event_id;
@@ -110,8 +118,8 @@ namespace zp::net
 
             Transient transient;
 
-            zp::VoidEvent on_connected_to_server;
-            zp::VoidEvent on_disconnected_from_server;
+            zp::concurrent_event<zp::Void> on_connected_to_server;
+            zp::concurrent_event<zp::Void> on_disconnected_from_server;
         };
 
         bool start_client(Instance* p_inst);
@@ -120,6 +128,18 @@ namespace zp::net
         bool connect_to_server(Instance* p_inst);
         void disconnect_from_server(Instance* p_inst);
 
+        // the same handshakes as coroutines on a zp::executor: instead of blocking for up to CONNECT_TIMEOUT_MS or
+        // DISCONNECT_TIMEOUT_MS they never touch the host and sleep until handle_incoming sees the handshake end, with the
+        // timeout armed on the executor's timer wheel. keep calling handle_incoming while they run, e.g. as a poller on the
+        // same executor.
+        zp::task<bool> connect_async(Instance* p_inst);
+        zp::task<void> disconnect_async(Instance* p_inst);
+
+        // the next event handle_incoming receives while this is awaited; it is handed over here instead of being queued on
+        // transient.incoming. nullopt when not connected or once the server disconnects. add handle_incoming as a poller
+        // on the executor to receive without a separate per-frame call.
+        zp::task<std::optional<NetEvent>> recv(Instance* p_inst);
+
         void handle_incoming(Instance* p_inst);
         void handle_outgoing(Instance* p_inst);
 
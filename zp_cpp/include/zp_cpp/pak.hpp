@@ -0,0 +1,129 @@
+#pragma once
+
+#include "core.hpp"
+#include "buff.hpp"
+#include "hash.hpp"
+#include "compress.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace zp::pak
+{
+    constexpr std::uint32_t MAGIC     = 0x4b41505a; // "ZPAK" little endian
+    constexpr std::uint32_t VERSION   = 2;
+    constexpr std::uint64_t ALIGNMENT = 4096;
+
+    enum EntryFlags : std::uint32_t
+    {
+        ENTRY_NONE       = 0,
+        ENTRY_COMPRESSED = 1 << 0,
+    };
+
+    // on-disk header, stored at offset 0 and followed directly by slot_count toc entries, then the path table holding every
+    // entry's relative path back to back. file data starts at data_offset.
+    struct Header
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t slot_count;
+        std::uint32_t entry_count;
+        std::uint64_t data_offset;
+        std::uint64_t total_size;
+    };
+
+    // on-disk toc slot. slots form an open-addressed table keyed by path_hash; path_hash == 0 marks an empty slot. the slot's
+    // path (path_size bytes at path_offset) settles which of several paths sharing a hash it belongs to.
+    struct Entry
+    {
+        std::uint64_t path_hash;
+        std::uint64_t path_offset;
+        std::uint64_t offset;
+        std::uint64_t stored_size;
+        std::uint64_t raw_size;
+        std::uint32_t flags;
+        std::uint32_t path_size;
+        zp::hash::hash256 checksum;
+    };
+
+    struct Archive
+    {
+        struct Config
+        {
+            std::filesystem::path path;
+        };
+        Config config;
+
+        struct State
+        {
+            const std::byte* p_base = nullptr;
+            std::size_t size        = 0;
+            const Entry* p_slots    = nullptr;
+            std::uint32_t slot_mask = 0;
+        };
+        State state;
+    };
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // path_hash: FNV-1a of the '/'-separated relative path. Never returns 0 so that 0 can mark empty toc slots.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    std::uint64_t path_hash(std::string_view rel_path) noexcept;
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // pack_dir: Packs every regular file below dir into a single archive at out_path, keyed by its path relative to dir. With
+    // compress_entries, each file is stored as a zp::compress block whenever that is smaller than the raw bytes.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    Result pack_dir(const std::filesystem::path& dir, const std::filesystem::path& out_path, bool compress_entries = false);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // open: Maps the whole archive at config.path read-only and validates its header. Lookups afterwards make no syscalls. POSIX
+    // only: the mapping goes through mmap.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    Result open(Archive* p_archive);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // close: Unmaps an archive previously mapped by open.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void close(Archive* p_archive);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // find_entry: Returns the toc entry for rel_path, or nullptr when the archive does not contain it. Compares the stored path on
+    // a hash match, so a colliding path never aliases another's entry.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    const Entry* find_entry(const Archive* p_archive, std::string_view rel_path) noexcept;
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // find: Returns a view of the stored bytes for rel_path directly inside the mapping. Compressed entries are returned as stored.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    Result find(const Archive* p_archive, std::string_view rel_path, span<const std::byte>* p_out) noexcept;
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // read: Copies the raw contents of rel_path into buffer, decompressing compressed entries. Fails with ZC_OUT_OF_BOUNDS when
+    // buffer is smaller than the entry's raw_size.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    Result read(const Archive* p_archive, std::string_view rel_path, span<std::byte> buffer, span<std::byte>* p_out);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // verify: Recomputes the hash256 of every entry and compares it against the checksum stored in the toc. ZC_FILE_NOT_FOUND
+    // when the archive is not open.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    Result verify(const Archive* p_archive);
+}
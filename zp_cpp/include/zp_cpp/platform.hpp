@@ -1,5 +1,6 @@
 #pragma once
 
+#include "zp_cpp/event_queue.hpp"
 #include "zp_cpp/events.hpp"
 #include "zp_cpp/math.hpp"
 
@@ -7,6 +8,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace zp::platform
 {
@@ -30,10 +32,20 @@ namespace zp::platform
         {
             zp::math::vec2 pos;
         };
-        using PointerDownEvt       = PointerEvt;
-        using PointerUpEvt         = PointerEvt;
-        using PointerClickEvt      = PointerEvt;
-        using PointerRightClickEvt = PointerEvt;
+
+        // distinct types so each pointer event gets its own event_queue channel.
+        struct PointerDownEvt : PointerEvt
+        {
+        };
+        struct PointerUpEvt : PointerEvt
+        {
+        };
+        struct PointerClickEvt : PointerEvt
+        {
+        };
+        struct PointerRightClickEvt : PointerEvt
+        {
+        };
 
         struct MouseDragEvt
         {
@@ -110,6 +122,11 @@ namespace zp::platform
             zp::Event<WasdAxisChangedEvt> on_wasd_axis_changed;
             zp::VoidEvent on_keyboard_state_changed;
             zp::Event<CharTypedEvt> on_char_typed;
+
+            // GLFW callbacks only enqueue here; poll_events dispatches the frame's input in batches once glfwPollEvents
+            // returns, through queue_routes to the on_* events. batch consumers can subscribe to the queue directly.
+            zp::event_queue queue;
+            std::vector<zp::subscription> queue_routes;
         };
     }
 
@@ -121,7 +138,8 @@ namespace zp::platform
 
     // =========================================================================================================================================
     // =========================================================================================================================================
-    // init: Creates a GLFW window and installs callbacks for translating platform input into zp events.
+    // init: Creates a GLFW window, installs callbacks for translating platform input into zp events and routes the input queue to
+    // the on_* events.
     // =========================================================================================================================================
     // =========================================================================================================================================
     void init(Instance* p_inst, int window_w, int window_h);
@@ -135,7 +153,7 @@ namespace zp::platform
 
     // =========================================================================================================================================
     // =========================================================================================================================================
-    // poll_events: Pumps GLFW's event queue so callbacks are delivered.
+    // poll_events: Pumps GLFW's event queue, then dispatches the input it produced.
     // =========================================================================================================================================
     // =========================================================================================================================================
     void poll_events(Instance* p_inst);
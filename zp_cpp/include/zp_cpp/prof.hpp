@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+
+#include "core.hpp"
+#include "time.hpp"
+
+// zones compile to nothing unless this is non-zero. the CMake option ZP_PROF_ENABLED sets it for zp_cpp and everything linking it.
+#ifndef ZP_PROF_ENABLED
+#define ZP_PROF_ENABLED 0
+#endif
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// =========================================================================================================================================
+// =========================================================================================================================================
+namespace zp::prof
+{
+    // per-thread ring capacity in zones. when it wraps, the oldest zones are overwritten.
+    constexpr std::uint64_t RING_EVENTS = 1 << 14;
+
+    enum class Format
+    {
+        CHROME_JSON, // chrome://tracing, ui.perfetto.dev and speedscope
+        PERFETTO,    // perfetto TracePacket protobuf
+    };
+
+    // one finished zone in zp::clock ticks. name must outlive the process (a string literal).
+    struct Event
+    {
+        const char* name;
+        std::uint64_t begin;
+        std::uint64_t end;
+    };
+
+    // an Event as stored in a ring. relaxed atomics, which compile to plain stores, since dump may copy a slot the owner is
+    // overwriting; such copies are thrown away, but reading them must not be a data race.
+    struct Slot
+    {
+        std::atomic<const char*> name;
+        std::atomic<std::uint64_t> begin;
+        std::atomic<std::uint64_t> end;
+    };
+
+    // single-producer ring owned by one thread. the owner publishes each event with one release store of head; dump copies the
+    // ring without stopping the thread and discards whatever was overwritten while it copied. buffers are never freed, so zones
+    // of exited threads still show up in a dump.
+    struct ThreadBuffer
+    {
+        alignas(64) std::atomic<std::uint64_t> head;
+        std::atomic<std::uint64_t> discard_before; // set by reset: events below this index are not dumped.
+        std::uint32_t tid;
+        char name[32]; // written by set_thread_name under the registry lock, which dump holds while it copies the name.
+        Slot slots[RING_EVENTS];
+    };
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // register_thread: Allocates and registers the calling thread's buffer. Called once per thread by thread_buffer.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    ThreadBuffer* register_thread();
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // set_thread_name: Names the calling thread's track in dumps.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void set_thread_name(const char* name);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // dump: Writes every recorded zone to path. Threads may keep recording while it runs.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    Result dump(const std::filesystem::path& path, Format format);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // reset: Forgets every zone recorded so far. Safe while other threads record.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void reset();
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // thread_buffer: The calling thread's ring, registered on first use. constinit keeps the hot path free of a TLS init guard.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline ThreadBuffer* thread_buffer() noexcept
+    {
+        constinit thread_local ThreadBuffer* p_buffer = nullptr;
+        if (p_buffer == nullptr) [[unlikely]]
+        {
+            p_buffer = register_thread();
+        }
+        return p_buffer;
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // record: Appends a finished zone to the calling thread's ring. One event store and one release store; no locks, no allocation.
+    // The release fence orders the head published by the previous record before the slot stores, so a dump that reads any of them
+    // also sees that head and knows the slot is being overwritten.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline void record(const char* name, std::uint64_t begin, std::uint64_t end) noexcept
+    {
+        ThreadBuffer* p_buffer   = thread_buffer();
+        const std::uint64_t head = p_buffer->head.load(std::memory_order_relaxed);
+        Slot* p_slot             = &p_buffer->slots[head & (RING_EVENTS - 1)];
+        std::atomic_thread_fence(std::memory_order_release);
+        p_slot->name.store(name, std::memory_order_relaxed);
+        p_slot->begin.store(begin, std::memory_order_relaxed);
+        p_slot->end.store(end, std::memory_order_relaxed);
+        p_buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    // scope guard behind ZP_PROF_ZONE.
+    struct Zone
+    {
+        const char* name;
+        std::uint64_t begin;
+
+        explicit Zone(const char* p_name) noexcept : name(p_name), begin(zp::clock::ticks()) {}
+        ~Zone() { record(name, begin, zp::clock::ticks()); }
+
+        Zone(const Zone&)            = delete;
+        Zone& operator=(const Zone&) = delete;
+    };
+}
+
+#define ZP_PROF_CONCAT_INNER(a, b) a##b
+#define ZP_PROF_CONCAT(a, b)       ZP_PROF_CONCAT_INNER(a, b)
+
+// times the rest of the enclosing scope. name must be a string literal.
+#if ZP_PROF_ENABLED
+#define ZP_PROF_ZONE(name) const zp::prof::Zone ZP_PROF_CONCAT(zp_prof_zone_, __LINE__)(name)
+#else
+#define ZP_PROF_ZONE(name) static_cast<void>(0)
+#endif
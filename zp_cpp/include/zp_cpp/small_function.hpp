@@ -0,0 +1,223 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace zp
+{
+    // inline capacity of a small_function: room for a lambda capturing six pointers, or a std::function.
+    constexpr std::size_t SMALL_FUNCTION_BYTES = 48;
+
+    template <typename Signature, std::size_t BYTES = SMALL_FUNCTION_BYTES> class small_function;
+
+    // copyable type-erased callable like std::function, but callables up to BYTES that move without throwing are stored inline,
+    // so wrapping, copying and calling them never touches the heap. larger callables fall back to one heap allocation.
+    template <typename R, typename... Args, std::size_t BYTES> class small_function<R(Args...), BYTES>
+    {
+        public:
+        small_function() noexcept = default;
+        template <typename F>
+            requires(!std::is_same_v<std::remove_cvref_t<F>, small_function> && std::is_invocable_r_v<R, std::remove_cvref_t<F>&, Args...>)
+        small_function(F&& f);
+        small_function(const small_function& o);
+        small_function(small_function&& o) noexcept;
+        small_function& operator=(const small_function& o);
+        small_function& operator=(small_function&& o) noexcept;
+        ~small_function();
+
+        R operator()(Args... args) const;
+        explicit operator bool() const noexcept;
+
+        // identifies the wrapped callable's type, like std::function::target_type. nullptr when empty.
+        const void* target_type() const noexcept;
+
+        private:
+        struct Ops
+        {
+            R (*invoke)(void* p_storage, Args&&... args);
+            void (*copy)(void* p_dst, const void* p_src);
+            void (*relocate)(void* p_dst, void* p_src) noexcept; // moves into p_dst and ends the source's lifetime.
+            void (*destroy)(void* p_storage) noexcept;
+        };
+
+        template <typename F> static constexpr bool IS_INLINE = sizeof(F) <= BYTES && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<F>;
+
+        template <typename F> static const Ops OPS;
+
+        void reset() noexcept;
+
+        alignas(std::max_align_t) std::byte storage[BYTES];
+        const Ops* p_ops = nullptr;
+    };
+}
+
+// the ops table for F. inline callables live in storage; the rest are heap allocated with the pointer kept in storage.
+template <typename R, typename... Args, std::size_t BYTES>
+template <typename F>
+const typename zp::small_function<R(Args...), BYTES>::Ops zp::small_function<R(Args...), BYTES>::OPS = []()
+{
+    if constexpr (IS_INLINE<F>)
+    {
+        return Ops{
+            [](void* p_storage, Args&&... args) -> R { return (*static_cast<F*>(p_storage))(std::forward<Args>(args)...); },
+            [](void* p_dst, const void* p_src) { ::new (p_dst) F(*static_cast<const F*>(p_src)); },
+            [](void* p_dst, void* p_src) noexcept
+            {
+                ::new (p_dst) F(std::move(*static_cast<F*>(p_src)));
+                static_cast<F*>(p_src)->~F();
+            },
+            [](void* p_storage) noexcept { static_cast<F*>(p_storage)->~F(); },
+        };
+    }
+    else
+    {
+        return Ops{
+            [](void* p_storage, Args&&... args) -> R { return (**static_cast<F**>(p_storage))(std::forward<Args>(args)...); },
+            [](void* p_dst, const void* p_src) { *static_cast<F**>(p_dst) = new F(**static_cast<F* const*>(p_src)); },
+            [](void* p_dst, void* p_src) noexcept { *static_cast<F**>(p_dst) = *static_cast<F**>(p_src); },
+            [](void* p_storage) noexcept { delete *static_cast<F**>(p_storage); },
+        };
+    }
+}();
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// small_function: Wraps f, inline when it fits.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename R, typename... Args, std::size_t BYTES>
+template <typename F>
+    requires(!std::is_same_v<std::remove_cvref_t<F>, zp::small_function<R(Args...), BYTES>> && std::is_invocable_r_v<R, std::remove_cvref_t<F>&, Args...>)
+zp::small_function<R(Args...), BYTES>::small_function(F&& f)
+{
+    using Fn = std::remove_cvref_t<F>;
+    if constexpr (IS_INLINE<Fn>)
+    {
+        ::new (static_cast<void*>(storage)) Fn(std::forward<F>(f));
+    }
+    else
+    {
+        *reinterpret_cast<Fn**>(storage) = new Fn(std::forward<F>(f));
+    }
+    p_ops = &OPS<Fn>;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// small_function: Copies o's callable.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename R, typename... Args, std::size_t BYTES> zp::small_function<R(Args...), BYTES>::small_function(const small_function& o)
+{
+    if (o.p_ops != nullptr)
+    {
+        o.p_ops->copy(storage, o.storage);
+        p_ops = o.p_ops;
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// small_function: Takes o's callable, leaving o empty.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename R, typename... Args, std::size_t BYTES> zp::small_function<R(Args...), BYTES>::small_function(small_function&& o) noexcept
+{
+    if (o.p_ops != nullptr)
+    {
+        o.p_ops->relocate(storage, o.storage);
+        p_ops   = o.p_ops;
+        o.p_ops = nullptr;
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// operator=: Replaces the callable with a copy of o's.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename R, typename... Args, std::size_t BYTES> zp::small_function<R(Args...), BYTES>& zp::small_function<R(Args...), BYTES>::operator=(const small_function& o)
+{
+    if (this != &o)
+    {
+        small_function copy(o);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// operator=: Replaces the callable with o's, leaving o empty.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename R, typename... Args, std::size_t BYTES> zp::small_function<R(Args...), BYTES>& zp::small_function<R(Args...), BYTES>::operator=(small_function&& o) noexcept
+{
+    if (this != &o)
+    {
+        reset();
+        if (o.p_ops != nullptr)
+        {
+            o.p_ops->relocate(storage, o.storage);
+            p_ops   = o.p_ops;
+            o.p_ops = nullptr;
+        }
+    }
+    return *this;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ~small_function: Destroys the callable.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename R, typename... Args, std::size_t BYTES> zp::small_function<R(Args...), BYTES>::~small_function()
+{
+    reset();
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// operator(): Calls the callable. Like std::function, const even when the callable mutates its captures. Must not be empty.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename R, typename... Args, std::size_t BYTES> R zp::small_function<R(Args...), BYTES>::operator()(Args... args) const
+{
+    return p_ops->invoke(const_cast<std::byte*>(storage), std::forward<Args>(args)...);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// operator bool: True when holding a callable.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename R, typename... Args, std::size_t BYTES> zp::small_function<R(Args...), BYTES>::operator bool() const noexcept
+{
+    return p_ops != nullptr;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// target_type: The ops table doubles as the type's identity, since there is exactly one per wrapped type.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename R, typename... Args, std::size_t BYTES> const void* zp::small_function<R(Args...), BYTES>::target_type() const noexcept
+{
+    return p_ops;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// reset: Destroys the callable, leaving the function empty.
+// =========================================================================================================================================
+// =========================================================================================================================================
+template <typename R, typename... Args, std::size_t BYTES> void zp::small_function<R(Args...), BYTES>::reset() noexcept
+{
+    if (p_ops != nullptr)
+    {
+        p_ops->destroy(storage);
+        p_ops = nullptr;
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+
+#include "event_queue.hpp"
+#include "events.hpp"
+
+namespace zp
+{
+    // Event<T> whose core listeners are fixed at compile time. each Handler is a default-constructible callable type taking
+    // const T&, stored by value in the event; trigger calls them in order as direct, inlinable calls with no type erasure, then
+    // runs any listeners added through subscribe exactly like Event<T>. with no dynamic listeners that second step is a
+    // quick check, so a hot event with only static handlers costs what calling the handlers by hand would.
+    template <typename T, typename... Handlers> class static_event
+    {
+        public:
+        using Listener = typename Event<T>::Listener;
+
+        [[nodiscard]] subscription subscribe(Listener callback) { return dynamic.subscribe(std::move(callback)); }
+
+        void trigger(const T& data)
+        {
+            std::apply([&](Handlers&... handlers) { (handlers(data), ...); }, fixed);
+            dynamic.trigger(data);
+        }
+
+        // dynamic listeners only; the static handlers are always there.
+        std::size_t listener_count() const { return dynamic.listener_count(); }
+
+        // a static handler, for handlers that carry state.
+        template <typename Handler> Handler& handler() { return std::get<Handler>(fixed); }
+
+        private:
+        std::tuple<Handlers...> fixed;
+        Event<T> dynamic;
+    };
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // queue_forward: Triggers p_event with each T event on dispatch, as for Event<T>. p_event must outlive the subscription.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    template <typename T, typename... Handlers> [[nodiscard]] subscription queue_forward(event_queue* p_queue, static_event<T, Handlers...>* p_event)
+    {
+        return queue_subscribe<T>(p_queue, [p_event](const T& evt) { p_event->trigger(evt); });
+    }
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "core.hpp"
+#include "buff.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace zp::stats
+{
+    constexpr std::uint32_t HISTOGRAM_MAGIC      = 0x54534948; // "HIST" little endian
+    constexpr std::uint32_t HISTOGRAM_VERSION    = 1;
+    constexpr std::uint32_t HISTOGRAM_SUB_BITS   = 8;  // 128 linear sub-buckets per power of two: buckets are under 0.8% wide.
+    constexpr std::uint32_t HISTOGRAM_VALUE_BITS = 42; // values up to 2^42 ns (~73 minutes). larger values count in the top bucket.
+    constexpr std::uint64_t HISTOGRAM_MAX_VALUE  = (std::uint64_t(1) << HISTOGRAM_VALUE_BITS) - 1;
+    constexpr std::uint32_t HISTOGRAM_BUCKETS    = (HISTOGRAM_VALUE_BITS - HISTOGRAM_SUB_BITS + 2) << (HISTOGRAM_SUB_BITS - 1);
+
+    // log-linear high dynamic range histogram. values below 2^SUB_BITS get exact buckets; above that each power of two is split
+    // into 2^(SUB_BITS - 1) equal buckets, so the relative error is bounded at every scale. recording is wait-free and never
+    // allocates. one thread records at a time (give each thread its own histogram and merge them); any thread may read or merge.
+    struct histogram
+    {
+        struct State
+        {
+            std::atomic<std::uint64_t> counts[HISTOGRAM_BUCKETS] = {};
+            std::atomic<std::uint64_t> total                     = 0;
+            std::atomic<std::uint64_t> sum                       = 0;
+            std::atomic<std::uint64_t> min                       = std::numeric_limits<std::uint64_t>::max();
+            std::atomic<std::uint64_t> max                       = 0;
+        };
+        State state;
+    };
+
+    struct Summary
+    {
+        std::uint64_t count;
+        std::uint64_t min;
+        std::uint64_t max;
+        double mean;
+        std::uint64_t p50;
+        std::uint64_t p90;
+        std::uint64_t p99;
+        std::uint64_t p999;
+    };
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // bucket_index: Maps a value to its bucket in O(1): the shift that keeps SUB_BITS significant bits, then the remaining mantissa.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    constexpr std::uint32_t bucket_index(std::uint64_t value) noexcept
+    {
+        value                     = std::min(value, HISTOGRAM_MAX_VALUE);
+        const std::uint32_t shift = std::max(static_cast<std::uint32_t>(std::bit_width(value)), HISTOGRAM_SUB_BITS) - HISTOGRAM_SUB_BITS;
+        return (shift << (HISTOGRAM_SUB_BITS - 1)) + static_cast<std::uint32_t>(value >> shift);
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // bucket_lowest: Smallest value that lands in bucket index. The bucket spans 2^shift values from there.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    constexpr std::uint64_t bucket_lowest(std::uint32_t index, std::uint32_t* p_shift) noexcept
+    {
+        const std::uint32_t shift = std::max(index >> (HISTOGRAM_SUB_BITS - 1), 1u) - 1;
+        *p_shift                  = shift;
+        return static_cast<std::uint64_t>(index - (shift << (HISTOGRAM_SUB_BITS - 1))) << shift;
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // record: Counts one value. Relaxed single-writer updates, so concurrent readers see a slightly stale but valid histogram.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline void record(histogram* p_histogram, std::uint64_t value) noexcept
+    {
+        histogram::State* p_state           = &p_histogram->state;
+        std::atomic<std::uint64_t>* p_count = &p_state->counts[bucket_index(value)];
+        p_count->store(p_count->load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        p_state->total.store(p_state->total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        p_state->sum.store(p_state->sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        if (value < p_state->min.load(std::memory_order_relaxed))
+        {
+            p_state->min.store(value, std::memory_order_relaxed);
+        }
+        if (value > p_state->max.load(std::memory_order_relaxed))
+        {
+            p_state->max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // reset: Clears every count. Must not race with record.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void reset(histogram* p_histogram) noexcept;
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // merge: Adds every count of p_from into p_into. p_into must not be recorded into concurrently; p_from may be.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void merge(histogram* p_into, const histogram* p_from) noexcept;
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // value_at_percentile: The highest value equivalent to the given percentile (0 - 100), clamped to the recorded max. 0 when empty.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    std::uint64_t value_at_percentile(const histogram* p_histogram, double percentile) noexcept;
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // summarize: Count, extremes, mean and the usual tail percentiles in one pass.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    Summary summarize(const histogram* p_histogram) noexcept;
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // serialize: Appends a compact encoding (header plus the non-empty buckets) to p_out.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void serialize(const histogram* p_histogram, std::vector<std::byte>* p_out);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // deserialize: Adds a serialized histogram into p_into, so several encodings can be aggregated. Returns ZC_INVALID_FORMAT for
+    // truncated or foreign data and leaves p_into untouched in that case.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    Result deserialize(span<const std::byte> data, histogram* p_into);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+
+#include "small_function.hpp"
+#include "time.hpp"
+
+namespace zp
+{
+    // a named piece of state tasks read or write, e.g. "input", "net incoming" or "command buffers". only identity matters.
+    using TaskResource = std::uint32_t;
+
+    // a frame's work as a dependency graph, built once and run every frame on zp::jobs. each task declares the resources it
+    // reads and writes, and edges follow from declaration order the way a render graph derives them: a task runs after the
+    // last earlier writer of anything it touches, and a writer also after every earlier reader since that writer. declaration
+    // order is therefore always a valid serial order, so a graph cannot contain a cycle.
+    // scheduling is critical-path first: every run times its tasks, and the next run releases ready tasks in order of the
+    // longest remaining chain behind them. a finishing task continues straight into its most urgent newly ready successor on
+    // the same thread and queues the rest, most urgent first for thieves. graph_run allocates nothing once warm.
+    // tasks may be added until graph_compile; not thread safe, and graph_run must not overlap itself.
+    struct task_graph
+    {
+        struct State
+        {
+            struct Internal;
+
+            Internal* p_i        = nullptr;
+            std::uint64_t runs   = 0;
+            ens critical_path_ns = 0; // longest chain of task times in the last run.
+        };
+        State state;
+    };
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // graph_init: Allocates an empty graph.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void graph_init(task_graph* p_graph);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // graph_exit: Releases the graph and its tasks.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void graph_exit(task_graph* p_graph);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // graph_resource: A new resource handle. name is kept for debugging and must outlive the graph.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    TaskResource graph_resource(task_graph* p_graph, const char* name);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // graph_add: Declares a task and returns its index. name must outlive the graph.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    std::uint32_t graph_add(task_graph* p_graph, const char* name, small_function<void()> work, std::initializer_list<TaskResource> reads, std::initializer_list<TaskResource> writes);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // graph_compile: Derives the edges and sizes every per-run array. Call once after the last graph_add.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void graph_compile(task_graph* p_graph);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // graph_run: Runs every task once, in parallel wherever the edges allow, and returns when all have finished. Without a
+    // running zp::jobs pool the tasks run in declaration order on the calling thread.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void graph_run(task_graph* p_graph);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // graph_depends_on: True when task runs only after before has finished, directly or through other tasks.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    bool graph_depends_on(const task_graph* p_graph, std::uint32_t task, std::uint32_t before);
+}
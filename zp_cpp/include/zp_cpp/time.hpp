@@ -1,14 +1,22 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
 namespace zp
 {
     using ens = uint64_t;
 
     // =========================================================================================================================================
     // =========================================================================================================================================
-    // now: Returns the current system time in nanoseconds since epoch.
+    // now: Returns clock::now_ns: monotonic nanoseconds from the active clock source. Never goes backwards; not wall-clock time.
     // =========================================================================================================================================
     // =========================================================================================================================================
     ens now();
@@ -20,3 +28,166 @@ namespace zp
     // =========================================================================================================================================
     float calc_interp(ens started, ens now, ens dur);
 }
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// =========================================================================================================================================
+// =========================================================================================================================================
+namespace zp::clock
+{
+    // how long calibration() spends measuring the tick rate on first use.
+    constexpr ens CALIBRATION_NS = 5'000'000;
+
+    // maps raw ticks onto the steady_ns timeline: ns = ns_base + (ticks - tick_base) * ns_per_tick.
+    struct Calibration
+    {
+        std::uint64_t tick_base;
+        ens ns_base;
+        double ns_per_tick;
+        bool is_invariant; // false when the TSC may stop or change rate, in which case fast_ns uses steady_ns instead.
+    };
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // steady_ns: std::chrono::steady_clock in nanoseconds (CLOCK_MONOTONIC on Linux, QueryPerformanceCounter on Windows). Unaffected
+    // by NTP steps or settimeofday.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline ens steady_ns() noexcept
+    {
+        return static_cast<ens>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // ticks: Raw timestamp counter (rdtsc). The cheapest timestamp there is, but the CPU may reorder it around neighbouring loads
+    // and stores. Falls back to steady_ns where there is no TSC.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline std::uint64_t ticks() noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+        return __rdtsc();
+#else
+        return steady_ns();
+#endif
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // ticks_ordered: Timestamp counter read with rdtscp, which waits for every earlier instruction to finish. Use it for the end of
+    // a measured region.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline std::uint64_t ticks_ordered() noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+        unsigned int aux;
+        return __rdtscp(&aux);
+#else
+        return steady_ns();
+#endif
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // calibrate: Measures the tick rate against steady_ns, blocking for CALIBRATION_NS. Most code wants calibration() instead.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    Calibration calibrate();
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // calibration: The process-wide mapping, calibrated once on first use. Inline so later calls cost only the static's guard check.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline const Calibration& calibration() noexcept
+    {
+        static const Calibration calibration = calibrate();
+        return calibration;
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // ticks_to_ns: Converts a ticks() reading to the steady_ns timeline.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline ens ticks_to_ns(std::uint64_t tick) noexcept
+    {
+        const Calibration& cal = calibration();
+        const double offset    = static_cast<double>(static_cast<std::int64_t>(tick - cal.tick_base)) * cal.ns_per_tick;
+        return cal.ns_base + static_cast<ens>(static_cast<std::int64_t>(offset));
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // ticks_to_duration_ns: Converts a difference of two ticks() readings to nanoseconds.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline ens ticks_to_duration_ns(std::uint64_t tick_delta) noexcept
+    {
+        return static_cast<ens>(static_cast<double>(tick_delta) * calibration().ns_per_tick);
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // fast_ns: steady_ns read through the TSC. A few nanoseconds instead of a vDSO call, and never goes backwards. Tracks steady_ns
+    // to within the calibration error (a few ppm).
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline ens fast_ns() noexcept
+    {
+        if (!calibration().is_invariant) [[unlikely]]
+        {
+            return steady_ns();
+        }
+        return ticks_to_ns(ticks());
+    }
+
+    // the active time source behind now_ns. nullptr means fast_ns.
+    using SourceFn                        = ens (*)() noexcept;
+
+    inline std::atomic<SourceFn> g_source = nullptr;
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // now_ns: The active clock source. Code that should run deterministically under a virtual clock (deadlines, debounce windows,
+    // frame pacing) reads time here; code measuring real work (profiling, I/O latency) reads fast_ns directly.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    inline ens now_ns() noexcept
+    {
+        const SourceFn p_source = g_source.load(std::memory_order_acquire);
+        return p_source == nullptr ? fast_ns() : p_source();
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // set_source: Installs a clock source for now_ns, or restores fast_ns with nullptr. The source must never go backwards.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void set_source(SourceFn p_source);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // sleep_until: Waits until now_ns reaches deadline_ns. On the real clock it sleeps and spins the last spin_ns to hide scheduler
+    // overshoot. A manual virtual clock jumps straight to the deadline, and a scaled one sleeps the real time the scaled gap needs.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void sleep_until(ens deadline_ns, ens spin_ns = 0);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // use_virtual_clock: Makes now_ns a virtual clock starting at start_ns. With rate 0 it only moves through advance_virtual_clock
+    // and sleep_until; with rate N it also runs at N times real time.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void use_virtual_clock(ens start_ns, double rate);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // advance_virtual_clock: Moves the virtual clock forward by delta_ns.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void advance_virtual_clock(ens delta_ns);
+}
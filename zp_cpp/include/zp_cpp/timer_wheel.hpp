@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "time.hpp"
+
+namespace zp
+{
+    using TimerId                                 = std::uint64_t;
+
+    constexpr TimerId INVALID_TIMER               = 0;
+    constexpr std::uint32_t TIMER_WHEEL_LEVELS    = 4;
+    constexpr std::uint32_t TIMER_WHEEL_SLOT_BITS = 8;
+    constexpr std::uint32_t TIMER_WHEEL_SLOTS     = 1u << TIMER_WHEEL_SLOT_BITS;
+
+    // hierarchical hashed timer wheel (Varghese & Lauck). four levels of 256 slots cover 2^32 ticks (~49 days at the default
+    // 1 ms tick); later deadlines park in the top level and are re-filed as it cascades. schedule and cancel are O(1), and
+    // advance costs O(1) per elapsed tick plus the timers that fire or cascade. empty stretches of the bottom level are skipped.
+    // deadlines are zp::clock::steady_ns / fast_ns times. not thread safe: one thread schedules, cancels and advances.
+    struct timer_wheel
+    {
+        struct Config
+        {
+            ens tick_ns = 1'000'000;
+        };
+        Config config;
+
+        struct State
+        {
+            struct Internal;
+
+            Internal* p_i = nullptr;
+        };
+        State state;
+    };
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // wheel_init: Allocates the wheel's slots with tick 0 at now_ns.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void wheel_init(timer_wheel* p_wheel, ens now_ns);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // wheel_exit: Drops every pending timer without running it and releases the wheel.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void wheel_exit(timer_wheel* p_wheel);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // wheel_schedule_at: Runs callback from the first wheel_advance at or after deadline_ns, rounded up to a whole tick. Deadlines
+    // already passed fire on the next tick.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    TimerId wheel_schedule_at(timer_wheel* p_wheel, ens deadline_ns, std::function<void()> callback);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // wheel_schedule_after: wheel_schedule_at relative to the wheel's current time.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    TimerId wheel_schedule_after(timer_wheel* p_wheel, ens delay_ns, std::function<void()> callback);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // wheel_cancel: Removes a pending timer. Returns false when it already fired, was cancelled or never existed.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    bool wheel_cancel(timer_wheel* p_wheel, TimerId id);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // wheel_advance: Moves the wheel to now_ns and runs every timer that came due, in deadline order by tick. Callbacks may schedule
+    // and cancel timers; anything they schedule fires on a later tick. Returns how many callbacks ran.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    std::size_t wheel_advance(timer_wheel* p_wheel, ens now_ns);
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // wheel_pending: Number of scheduled timers that have not fired or been cancelled.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    std::size_t wheel_pending(const timer_wheel* p_wheel);
+}
@@ -0,0 +1,168 @@
+#include "zp_cpp/async.hpp"
+#include "zp_cpp/concurrent_event.hpp"
+#include "zp_cpp/timer_wheel.hpp"
+
+#include <algorithm>
+#include <vector>
+
+struct zp::executor::State::Internal
+{
+    timer_wheel timers;
+    dispatch_queue posted;                         // resumptions from other threads, e.g. jobs finishing offloaded work.
+    std::vector<std::coroutine_handle<>> ready;    // resumed by the next exec_poll.
+    std::vector<std::coroutine_handle<>> resuming; // kept between polls so steady-state polling does not allocate.
+    std::vector<small_function<void()>> pollers;
+    std::vector<std::coroutine_handle<>> spawned;  // spawned tasks that have not finished.
+};
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// exec_init: Allocates the executor with its timers starting at clock::now_ns.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::exec_init(executor* p_exec)
+{
+    p_exec->state.p_i = new executor::State::Internal();
+    wheel_init(&p_exec->state.p_i->timers, clock::now_ns());
+    dispatch_init(&p_exec->state.p_i->posted);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// exec_exit: Destroys the unfinished spawned tasks, which destroys any task each one is awaiting with it and takes any
+// async_queue waiter among them off its queue, then drops the pending timers and posts without resuming anything.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::exec_exit(executor* p_exec)
+{
+    executor::State::Internal* p_i = p_exec->state.p_i;
+    for (const std::coroutine_handle<> handle : p_i->spawned)
+    {
+        handle.destroy();
+    }
+    wheel_exit(&p_i->timers);
+    dispatch_exit(&p_i->posted);
+
+    delete p_i;
+    p_exec->state.p_i     = nullptr;
+    p_exec->state.spawned = 0;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// exec_poll: Pollers and timers only mark coroutines ready, and posts from other threads are drained into the same list, so
+// everything resumes from one place. The list is swapped out first so whatever those coroutines schedule waits for the next poll.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::size_t zp::exec_poll(executor* p_exec)
+{
+    executor::State::Internal* p_i = p_exec->state.p_i;
+    for (const small_function<void()>& poller : p_i->pollers)
+    {
+        poller();
+    }
+    wheel_advance(&p_i->timers, clock::now_ns());
+    dispatch_drain(&p_i->posted);
+
+    p_i->resuming.swap(p_i->ready);
+    for (const std::coroutine_handle<> handle : p_i->resuming)
+    {
+        handle.resume();
+    }
+    const std::size_t resumed = p_i->resuming.size();
+    p_i->resuming.clear();
+
+    p_exec->state.resumed     += resumed;
+    return resumed;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// exec_add_poller: Runs poller at the start of every exec_poll.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::exec_add_poller(executor* p_exec, small_function<void()> poller)
+{
+    p_exec->state.p_i->pollers.push_back(std::move(poller));
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// exec_schedule: Resumes handle from the next exec_poll.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::exec_schedule(executor* p_exec, std::coroutine_handle<> handle)
+{
+    p_exec->state.p_i->ready.push_back(handle);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// exec_schedule_at: Parks handle on the timer wheel, which marks it ready once the deadline passes.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::exec_schedule_at(executor* p_exec, ens deadline_ns, std::coroutine_handle<> handle)
+{
+    executor::State::Internal* p_i = p_exec->state.p_i;
+    wheel_schedule_at(&p_i->timers, deadline_ns, [p_i, handle]() { p_i->ready.push_back(handle); });
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// exec_call_at: Puts callback itself on the timer wheel, which exec_poll advances before resuming anything.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::TimerId zp::exec_call_at(executor* p_exec, ens deadline_ns, std::function<void()> callback)
+{
+    return wheel_schedule_at(&p_exec->state.p_i->timers, deadline_ns, std::move(callback));
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// exec_cancel_call: Cancels the callback's timer.
+// =========================================================================================================================================
+// =========================================================================================================================================
+bool zp::exec_cancel_call(executor* p_exec, TimerId id)
+{
+    return wheel_cancel(&p_exec->state.p_i->timers, id);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// exec_post: Queues handle for the next exec_poll through the executor's dispatch queue.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::exec_post(executor* p_exec, std::coroutine_handle<> handle)
+{
+    executor::State::Internal* p_i = p_exec->state.p_i;
+    dispatch_post(&p_i->posted, [p_i, handle]() { p_i->ready.push_back(handle); });
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// exec_adopt: Tracks handle as a spawned task until exec_release.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::exec_adopt(executor* p_exec, std::coroutine_handle<> handle)
+{
+    p_exec->state.p_i->spawned.push_back(handle);
+    ++p_exec->state.spawned;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// exec_release: Stops tracking and destroys a spawned task that has finished.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::exec_release(executor* p_exec, std::coroutine_handle<> handle)
+{
+    std::vector<std::coroutine_handle<>>& spawned = p_exec->state.p_i->spawned;
+    const auto it                                 = std::find(spawned.begin(), spawned.end(), handle);
+    if (it != spawned.end())
+    {
+        *it = spawned.back();
+        spawned.pop_back();
+        --p_exec->state.spawned;
+    }
+    handle.destroy();
+}
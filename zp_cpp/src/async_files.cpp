@@ -0,0 +1,34 @@
+#include "zp_cpp/async_files.hpp"
+
+#include <system_error>
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// async_read: Sizes a buffer for the file and runs read_file into it on a zp::jobs worker. path is taken by value so it lives in
+// the coroutine frame rather than in the caller's.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::task<zp::files::FileContents> zp::files::async_read(std::filesystem::path path)
+{
+    co_return co_await zp::async_offload(
+        [&path]()
+        {
+            FileContents contents = {};
+            std::error_code ec;
+            const std::uintmax_t file_size = std::filesystem::file_size(path, ec);
+            if (ec)
+            {
+                contents.result = zp::Result::ZC_FILE_NOT_FOUND;
+                return contents;
+            }
+
+            contents.bytes.resize(file_size);
+            zp::span<std::byte> file_span;
+            contents.result = read_file(path, {contents.bytes.data(), contents.bytes.size()}, &file_span);
+            if (contents.result != zp::Result::ZC_SUCCESS)
+            {
+                contents.bytes.clear();
+            }
+            return contents;
+        });
+}
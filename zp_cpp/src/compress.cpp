@@ -0,0 +1,892 @@
+#include "zp_cpp/compress.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace
+{
+    constexpr std::size_t MIN_MATCH          = 4;
+    constexpr std::size_t LAST_LITERALS      = 5;
+    constexpr std::size_t MF_LIMIT           = 12;
+    constexpr std::size_t MAX_DISTANCE       = 65535;
+    constexpr int FAST_HASH_BITS             = 12;
+    constexpr int HIGH_HASH_BITS             = 15;
+    constexpr int HIGH_MAX_ATTEMPTS          = 64;
+    constexpr std::size_t FRAME_HEADER_SIZE  = 12;
+    constexpr std::uint32_t UNCOMPRESSED_BIT = 0x80000000u;
+
+    constexpr std::uint32_t PRIME32_1        = 0x9e3779b1u;
+    constexpr std::uint32_t PRIME32_2        = 0x85ebca77u;
+    constexpr std::uint32_t PRIME32_3        = 0xc2b2ae3du;
+    constexpr std::uint32_t PRIME32_4        = 0x27d4eb2fu;
+    constexpr std::uint32_t PRIME32_5        = 0x165667b1u;
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // read32: Unaligned little-endian 32-bit load.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    std::uint32_t read32(const std::byte* p)
+    {
+        std::uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // append32: Appends a little-endian u32 to a byte vector.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void append32(std::vector<std::byte>* p_out, std::uint32_t value)
+    {
+        const std::size_t old_size = p_out->size();
+        p_out->resize(old_size + sizeof(value));
+        std::memcpy(p_out->data() + old_size, &value, sizeof(value));
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // hash4: Multiplicative hash of the 4 bytes starting a candidate match.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    std::uint32_t hash4(std::uint32_t seq, int bits)
+    {
+        return (seq * 2654435761u) >> (32 - bits);
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // match_length: Counts equal bytes at p and p_ref, 8 at a time, without reading at or past p_limit.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    std::size_t match_length(const std::byte* p, const std::byte* p_ref, const std::byte* p_limit)
+    {
+        const std::byte* const p_start = p;
+        while (p_limit - p >= 8)
+        {
+            std::uint64_t word;
+            std::uint64_t ref_word;
+            std::memcpy(&word, p, sizeof(word));
+            std::memcpy(&ref_word, p_ref, sizeof(ref_word));
+            const std::uint64_t diff = word ^ ref_word;
+            if (diff != 0)
+            {
+                // little endian: the lowest set bit belongs to the first differing byte.
+                return static_cast<std::size_t>(p - p_start) + (std::countr_zero(diff) >> 3);
+            }
+            p     += 8;
+            p_ref += 8;
+        }
+        while (p < p_limit && *p == *p_ref)
+        {
+            ++p;
+            ++p_ref;
+        }
+        return static_cast<std::size_t>(p - p_start);
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // write_length: Writes the 255-run extension of a literal or match length that overflowed its 4-bit token field.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    std::byte* write_length(std::byte* p, std::size_t length)
+    {
+        while (length >= 255)
+        {
+            *p++    = std::byte{255};
+            length -= 255;
+        }
+        *p++ = static_cast<std::byte>(length);
+        return p;
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // read_length: Reads a 255-run length extension, failing when it runs past p_end.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    bool read_length(const std::byte** pp, const std::byte* p_end, std::size_t* p_length)
+    {
+        std::uint32_t step;
+        do
+        {
+            if (*pp >= p_end)
+            {
+                return false;
+            }
+            step       = std::to_integer<std::uint32_t>(*(*pp)++);
+            *p_length += step;
+        } while (step == 255);
+        return true;
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // checksum_round: One xxh32 accumulator round.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    std::uint32_t checksum_round(std::uint32_t acc, std::uint32_t input)
+    {
+        acc += input * PRIME32_2;
+        acc  = std::rotl(acc, 13);
+        acc *= PRIME32_1;
+        return acc;
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // append_block: Compresses one frame block into p_out, falling back to a stored block when compression does not help.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void append_block(zp::compress::encoder* p_encoder, zp::span<const std::byte> src, std::vector<std::byte>* p_out)
+    {
+        zp::compress::encoder::State& state = p_encoder->state;
+        state.scratch.resize(zp::compress::compress_bound(src.count));
+
+        zp::span<std::byte> compressed;
+        const zp::Result result = zp::compress::compress_block(src, {state.scratch.data(), state.scratch.size()}, p_encoder->config.level, &compressed);
+
+        if (result != zp::Result::ZC_SUCCESS || compressed.count >= src.count)
+        {
+            append32(p_out, static_cast<std::uint32_t>(src.count) | UNCOMPRESSED_BIT);
+            p_out->insert(p_out->end(), src.p, src.p + src.count);
+            return;
+        }
+
+        append32(p_out, static_cast<std::uint32_t>(compressed.count));
+        p_out->insert(p_out->end(), compressed.p, compressed.p + compressed.count);
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// compress_block: Compresses src into dst using the LZ4 block format. FAST is a greedy single-probe matcher, HIGH searches
+// hash chains with one step of lazy evaluation. dst should hold compress_bound(src.count) bytes.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::Result zp::compress::compress_block(span<const std::byte> src, span<std::byte> dst, Level level, span<std::byte>* p_out)
+{
+    // =============================================================================================
+    // =============================================================================================
+    // Guard: match tables store positions as 32-bit offsets.
+    // =============================================================================================
+    // =============================================================================================
+    {
+        if (src.count > 0x7fffffff)
+        {
+            return Result::ZC_OUT_OF_BOUNDS;
+        }
+    }
+
+    const std::byte* const p_src = src.p;
+    const std::byte* const p_end = src.p + src.count;
+    std::byte* const p_oend      = dst.p + dst.count;
+
+    // =============================================================================================
+    // =============================================================================================
+    // Find matches and emit sequences. As the block format requires, no match starts within MF_LIMIT bytes of the end and
+    // the final LAST_LITERALS bytes are always literals.
+    // =============================================================================================
+    // =============================================================================================
+    Result result             = Result::ZC_SUCCESS;
+    std::byte* p_op           = dst.p;
+    const std::byte* p_anchor = p_src;
+    {
+        if (src.count >= MF_LIMIT + 1)
+        {
+            const std::byte* const p_match_limit = p_end - LAST_LITERALS;
+            const std::byte* const p_mf_limit    = p_end - MF_LIMIT;
+
+            // FAST keeps one candidate per hash on the stack. HIGH keeps every position of the 64K window in hash chains: head
+            // holds position + 1 (0 = empty) and chain holds the distance back to the previous position with the same hash.
+            std::uint32_t fast_table[1 << FAST_HASH_BITS] = {};
+            std::vector<std::uint32_t> head;
+            std::vector<std::uint16_t> chain;
+            std::uint32_t next_insert = 0;
+            if (level == Level::HIGH)
+            {
+                head.assign(1 << HIGH_HASH_BITS, 0);
+                chain.assign(MAX_DISTANCE + 1, 0);
+            }
+
+            auto find_high = [&](const std::byte* p, const std::byte** pp_ref) -> std::size_t
+            {
+                const std::uint32_t pos = static_cast<std::uint32_t>(p - p_src);
+                while (next_insert < pos)
+                {
+                    const std::uint32_t h        = hash4(read32(p_src + next_insert), HIGH_HASH_BITS);
+                    const std::uint32_t distance = head[h] == 0 ? 0 : next_insert + 1 - head[h];
+                    chain[next_insert & MAX_DISTANCE] = distance > MAX_DISTANCE ? 0 : static_cast<std::uint16_t>(distance);
+                    head[h]                           = next_insert + 1;
+                    ++next_insert;
+                }
+
+                const std::uint32_t seq = read32(p);
+                std::uint32_t candidate = head[hash4(seq, HIGH_HASH_BITS)];
+                std::size_t best        = 0;
+                for (int attempt = 0; candidate != 0 && attempt < HIGH_MAX_ATTEMPTS; ++attempt)
+                {
+                    const std::uint32_t ref = candidate - 1;
+                    if (pos - ref > MAX_DISTANCE)
+                    {
+                        break;
+                    }
+
+                    if (read32(p_src + ref) == seq)
+                    {
+                        const std::size_t len = MIN_MATCH + match_length(p + MIN_MATCH, p_src + ref + MIN_MATCH, p_match_limit);
+                        if (len > best)
+                        {
+                            best    = len;
+                            *pp_ref = p_src + ref;
+                        }
+                    }
+
+                    const std::uint16_t distance = chain[ref & MAX_DISTANCE];
+                    if (distance == 0)
+                    {
+                        break;
+                    }
+                    candidate -= distance;
+                }
+                return best;
+            };
+
+            const std::byte* p_ip = p_src;
+            while (p_ip <= p_mf_limit)
+            {
+                const std::byte* p_ref = nullptr;
+                std::size_t len        = 0;
+
+                if (level == Level::FAST)
+                {
+                    const std::uint32_t seq = read32(p_ip);
+                    const std::uint32_t h   = hash4(seq, FAST_HASH_BITS);
+                    p_ref                   = p_src + fast_table[h];
+                    fast_table[h]           = static_cast<std::uint32_t>(p_ip - p_src);
+
+                    if (p_ref < p_ip && static_cast<std::size_t>(p_ip - p_ref) <= MAX_DISTANCE && read32(p_ref) == seq)
+                    {
+                        len = MIN_MATCH + match_length(p_ip + MIN_MATCH, p_ref + MIN_MATCH, p_match_limit);
+
+                        // pull the match start back over pending literals that also match.
+                        while (p_ip > p_anchor && p_ref > p_src && p_ip[-1] == p_ref[-1])
+                        {
+                            --p_ip;
+                            --p_ref;
+                            ++len;
+                        }
+                    }
+                }
+                else
+                {
+                    len = find_high(p_ip, &p_ref);
+                    if (len != 0 && p_ip + 1 <= p_mf_limit)
+                    {
+                        const std::byte* p_next_ref = nullptr;
+                        const std::size_t next_len  = find_high(p_ip + 1, &p_next_ref);
+                        if (next_len > len + 1)
+                        {
+                            ++p_ip;
+                            len   = next_len;
+                            p_ref = p_next_ref;
+                        }
+                    }
+                }
+
+                if (len == 0)
+                {
+                    // FAST skips ahead faster the longer it goes without a match, so incompressible data stays cheap.
+                    p_ip += level == Level::FAST ? 1 + ((p_ip - p_anchor) >> 6) : 1;
+                    continue;
+                }
+
+                const std::size_t lit_len = static_cast<std::size_t>(p_ip - p_anchor);
+                const std::size_t needed  = 1 + lit_len / 255 + 1 + lit_len + 2 + len / 255 + 1;
+                if (static_cast<std::size_t>(p_oend - p_op) < needed)
+                {
+                    result = Result::ZC_OUT_OF_BOUNDS;
+                    break;
+                }
+
+                std::byte* const p_token = p_op++;
+                std::uint32_t token;
+                if (lit_len >= 15)
+                {
+                    token = 15 << 4;
+                    p_op  = write_length(p_op, lit_len - 15);
+                }
+                else
+                {
+                    token = static_cast<std::uint32_t>(lit_len) << 4;
+                }
+
+                std::memcpy(p_op, p_anchor, lit_len);
+                p_op                       += lit_len;
+                const std::uint16_t offset  = static_cast<std::uint16_t>(p_ip - p_ref);
+                std::memcpy(p_op, &offset, sizeof(offset));
+                p_op += sizeof(offset);
+
+                const std::size_t match_code = len - MIN_MATCH;
+                if (match_code >= 15)
+                {
+                    token |= 15;
+                    p_op   = write_length(p_op, match_code - 15);
+                }
+                else
+                {
+                    token |= static_cast<std::uint32_t>(match_code);
+                }
+                *p_token  = static_cast<std::byte>(token);
+
+                p_ip     += len;
+                p_anchor  = p_ip;
+
+                // seed the table just behind the new anchor so that short repeats right after a match are found.
+                if (level == Level::FAST)
+                {
+                    fast_table[hash4(read32(p_ip - 2), FAST_HASH_BITS)] = static_cast<std::uint32_t>(p_ip - 2 - p_src);
+                }
+            }
+        }
+    }
+
+    // =============================================================================================
+    // =============================================================================================
+    // Emit the trailing literals as the final, match-less sequence.
+    // =============================================================================================
+    // =============================================================================================
+    {
+        if (result == Result::ZC_SUCCESS)
+        {
+            const std::size_t lit_len = static_cast<std::size_t>(p_end - p_anchor);
+            if (static_cast<std::size_t>(p_oend - p_op) < 1 + lit_len / 255 + 1 + lit_len)
+            {
+                return Result::ZC_OUT_OF_BOUNDS;
+            }
+
+            if (lit_len >= 15)
+            {
+                *p_op++ = static_cast<std::byte>(15 << 4);
+                p_op    = write_length(p_op, lit_len - 15);
+            }
+            else
+            {
+                *p_op++ = static_cast<std::byte>(lit_len << 4);
+            }
+
+            if (lit_len > 0)
+            {
+                std::memcpy(p_op, p_anchor, lit_len);
+                p_op += lit_len;
+            }
+
+            p_out->p     = dst.p;
+            p_out->count = static_cast<std::size_t>(p_op - dst.p);
+        }
+    }
+
+    return result;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// decompress_block: Decodes an LZ4 block into dst. Every read and write is bounds checked so corrupt input fails with
+// ZC_INVALID_FORMAT instead of touching memory outside src or dst.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::Result zp::compress::decompress_block(span<const std::byte> src, span<std::byte> dst, span<std::byte>* p_out)
+{
+    const std::byte* p_ip        = src.p;
+    const std::byte* const p_end = src.p + src.count;
+    std::byte* p_op              = dst.p;
+    std::byte* const p_oend      = dst.p + dst.count;
+
+    // =============================================================================================
+    // =============================================================================================
+    // Decode sequences until the input ends right after a literal run.
+    // =============================================================================================
+    // =============================================================================================
+    {
+        while (true)
+        {
+            if (p_ip >= p_end)
+            {
+                return Result::ZC_INVALID_FORMAT;
+            }
+            const std::uint32_t token = std::to_integer<std::uint32_t>(*p_ip++);
+
+            std::size_t lit_len       = token >> 4;
+            if (lit_len == 15 && !read_length(&p_ip, p_end, &lit_len))
+            {
+                return Result::ZC_INVALID_FORMAT;
+            }
+            if (static_cast<std::size_t>(p_end - p_ip) < lit_len || static_cast<std::size_t>(p_oend - p_op) < lit_len)
+            {
+                return Result::ZC_INVALID_FORMAT;
+            }
+
+            // short runs copy a fixed 16 bytes when both sides have room, which compiles to a single vector move.
+            if (lit_len <= 16 && p_end - p_ip >= 16 && p_oend - p_op >= 16)
+            {
+                std::memcpy(p_op, p_ip, 16);
+            }
+            else if (lit_len > 0)
+            {
+                std::memcpy(p_op, p_ip, lit_len);
+            }
+            p_op += lit_len;
+            p_ip += lit_len;
+
+            if (p_ip == p_end)
+            {
+                break;
+            }
+
+            if (p_end - p_ip < 2)
+            {
+                return Result::ZC_INVALID_FORMAT;
+            }
+            std::uint16_t offset16;
+            std::memcpy(&offset16, p_ip, sizeof(offset16));
+            p_ip                     += sizeof(offset16);
+            const std::size_t offset  = offset16;
+            if (offset == 0 || offset > static_cast<std::size_t>(p_op - dst.p))
+            {
+                return Result::ZC_INVALID_FORMAT;
+            }
+
+            std::size_t match_len = token & 15;
+            if (match_len == 15 && !read_length(&p_ip, p_end, &match_len))
+            {
+                return Result::ZC_INVALID_FORMAT;
+            }
+            match_len += MIN_MATCH;
+            if (static_cast<std::size_t>(p_oend - p_op) < match_len)
+            {
+                return Result::ZC_INVALID_FORMAT;
+            }
+
+            // wide copies may run up to one chunk past the match end; those bytes are rewritten by the next sequence or lie past
+            // the decoded size. overlapping short offsets replicate a pattern and must go byte by byte.
+            const std::byte* p_match     = p_op - offset;
+            std::byte* const p_match_end = p_op + match_len;
+            if (offset >= 16 && p_oend - p_match_end >= 16)
+            {
+                while (p_op < p_match_end)
+                {
+                    std::memcpy(p_op, p_match, 16);
+                    p_op    += 16;
+                    p_match += 16;
+                }
+            }
+            else if (offset >= 8 && p_oend - p_match_end >= 8)
+            {
+                while (p_op < p_match_end)
+                {
+                    std::memcpy(p_op, p_match, 8);
+                    p_op    += 8;
+                    p_match += 8;
+                }
+            }
+            else if (offset == 1)
+            {
+                std::memset(p_op, std::to_integer<int>(*p_match), match_len);
+            }
+            else
+            {
+                for (std::size_t i = 0; i < match_len; ++i)
+                {
+                    p_op[i] = p_match[i];
+                }
+            }
+            p_op = p_match_end;
+        }
+    }
+
+    p_out->p     = dst.p;
+    p_out->count = static_cast<std::size_t>(p_op - dst.p);
+    return Result::ZC_SUCCESS;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// checksum_reset: Starts a new xxh32 (seed 0) digest.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::compress::checksum_reset(Checksum* p_checksum) noexcept
+{
+    *p_checksum      = {};
+    p_checksum->v[0] = PRIME32_1 + PRIME32_2;
+    p_checksum->v[1] = PRIME32_2;
+    p_checksum->v[2] = 0;
+    p_checksum->v[3] = 0u - PRIME32_1;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// checksum_update: Feeds data into the digest. Input is consumed in 16-byte stripes; a partial stripe waits in mem.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::compress::checksum_update(Checksum* p_checksum, span<const std::byte> data) noexcept
+{
+    if (data.count == 0)
+    {
+        return;
+    }
+
+    const std::byte* p           = data.p;
+    const std::byte* const p_end = data.p + data.count;
+    p_checksum->total_len       += data.count;
+
+    // =============================================================================================
+    // =============================================================================================
+    // Top up a pending partial stripe first.
+    // =============================================================================================
+    // =============================================================================================
+    {
+        if (p_checksum->mem_size + data.count < 16)
+        {
+            std::memcpy(p_checksum->mem + p_checksum->mem_size, p, data.count);
+            p_checksum->mem_size += static_cast<std::uint32_t>(data.count);
+            return;
+        }
+
+        if (p_checksum->mem_size > 0)
+        {
+            const std::size_t fill = 16 - p_checksum->mem_size;
+            std::memcpy(p_checksum->mem + p_checksum->mem_size, p, fill);
+
+            const std::byte* p_mem = reinterpret_cast<const std::byte*>(p_checksum->mem);
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                p_checksum->v[lane] = checksum_round(p_checksum->v[lane], read32(p_mem + lane * 4));
+            }
+            p                    += fill;
+            p_checksum->mem_size  = 0;
+        }
+    }
+
+    // =============================================================================================
+    // =============================================================================================
+    // Consume whole stripes, then keep the tail for the next call.
+    // =============================================================================================
+    // =============================================================================================
+    {
+        while (p_end - p >= 16)
+        {
+            p_checksum->v[0]  = checksum_round(p_checksum->v[0], read32(p));
+            p_checksum->v[1]  = checksum_round(p_checksum->v[1], read32(p + 4));
+            p_checksum->v[2]  = checksum_round(p_checksum->v[2], read32(p + 8));
+            p_checksum->v[3]  = checksum_round(p_checksum->v[3], read32(p + 12));
+            p                += 16;
+        }
+
+        if (p < p_end)
+        {
+            std::memcpy(p_checksum->mem, p, static_cast<std::size_t>(p_end - p));
+            p_checksum->mem_size = static_cast<std::uint32_t>(p_end - p);
+        }
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// checksum_digest: Finalises the digest without modifying the running state.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::uint32_t zp::compress::checksum_digest(const Checksum* p_checksum) noexcept
+{
+    std::uint32_t h;
+    if (p_checksum->total_len >= 16)
+    {
+        h = std::rotl(p_checksum->v[0], 1) + std::rotl(p_checksum->v[1], 7) + std::rotl(p_checksum->v[2], 12) + std::rotl(p_checksum->v[3], 18);
+    }
+    else
+    {
+        h = p_checksum->v[2] + PRIME32_5;
+    }
+    h += static_cast<std::uint32_t>(p_checksum->total_len);
+
+    // =============================================================================================
+    // =============================================================================================
+    // Mix in the buffered tail, 4 bytes then 1 byte at a time, and avalanche.
+    // =============================================================================================
+    // =============================================================================================
+    {
+        const std::byte* p     = reinterpret_cast<const std::byte*>(p_checksum->mem);
+        const std::byte* p_end = p + p_checksum->mem_size;
+        while (p_end - p >= 4)
+        {
+            h += read32(p) * PRIME32_3;
+            h  = std::rotl(h, 17) * PRIME32_4;
+            p += 4;
+        }
+        while (p < p_end)
+        {
+            h += std::to_integer<std::uint32_t>(*p) * PRIME32_5;
+            h  = std::rotl(h, 11) * PRIME32_1;
+            ++p;
+        }
+
+        h ^= h >> 15;
+        h *= PRIME32_2;
+        h ^= h >> 13;
+        h *= PRIME32_3;
+        h ^= h >> 16;
+    }
+
+    return h;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// encoder_write: Buffers input and appends every completed frame block to p_out. The frame header is emitted on first use.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::compress::encoder_write(encoder* p_encoder, span<const std::byte> data, std::vector<std::byte>* p_out)
+{
+    encoder::State& state        = p_encoder->state;
+    const std::size_t block_size = std::clamp<std::size_t>(p_encoder->config.block_size, 1, MAX_BLOCK_SIZE);
+
+    // =============================================================================================
+    // =============================================================================================
+    // Emit the frame header: magic, version, level, reserved, block size.
+    // =============================================================================================
+    // =============================================================================================
+    {
+        if (!state.header_written)
+        {
+            append32(p_out, FRAME_MAGIC);
+            p_out->push_back(static_cast<std::byte>(FRAME_VERSION));
+            p_out->push_back(static_cast<std::byte>(p_encoder->config.level));
+            p_out->push_back(std::byte{0});
+            p_out->push_back(std::byte{0});
+            append32(p_out, static_cast<std::uint32_t>(block_size));
+
+            checksum_reset(&state.checksum);
+            state.pending.clear();
+            state.header_written = true;
+        }
+    }
+
+    checksum_update(&state.checksum, data);
+
+    // =============================================================================================
+    // =============================================================================================
+    // Complete a pending partial block first, then compress whole blocks straight from data and keep the tail.
+    // =============================================================================================
+    // =============================================================================================
+    {
+        const std::byte* p           = data.p;
+        const std::byte* const p_end = data.p + data.count;
+
+        if (!state.pending.empty())
+        {
+            const std::size_t take = std::min(block_size - state.pending.size(), static_cast<std::size_t>(p_end - p));
+            state.pending.insert(state.pending.end(), p, p + take);
+            p += take;
+
+            if (state.pending.size() < block_size)
+            {
+                return;
+            }
+            append_block(p_encoder, {state.pending.data(), state.pending.size()}, p_out);
+            state.pending.clear();
+        }
+
+        while (static_cast<std::size_t>(p_end - p) >= block_size)
+        {
+            append_block(p_encoder, {p, block_size}, p_out);
+            p += block_size;
+        }
+
+        state.pending.insert(state.pending.end(), p, p_end);
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// encoder_finish: Flushes the last partial block, the end mark and the content checksum, then resets the encoder for reuse.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::compress::encoder_finish(encoder* p_encoder, std::vector<std::byte>* p_out)
+{
+    encoder_write(p_encoder, {nullptr, 0}, p_out);
+
+    encoder::State& state = p_encoder->state;
+    if (!state.pending.empty())
+    {
+        append_block(p_encoder, {state.pending.data(), state.pending.size()}, p_out);
+    }
+
+    append32(p_out, 0);
+    append32(p_out, checksum_digest(&state.checksum));
+
+    state.pending.clear();
+    state.header_written = false;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// decoder_feed: Consumes any amount of frame bytes and appends decoded content to p_out. Returns ZC_CHECKSUM_MISMATCH when
+// the content checksum fails and ZC_INVALID_FORMAT for malformed frames.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::Result zp::compress::decoder_feed(decoder* p_decoder, span<const std::byte> data, std::vector<std::byte>* p_out)
+{
+    decoder::State& state = p_decoder->state;
+    if (data.count > 0)
+    {
+        state.pending.insert(state.pending.end(), data.p, data.p + data.count);
+    }
+
+    // =============================================================================================
+    // =============================================================================================
+    // Advance through every frame part that pending holds completely; partial parts wait for the next call.
+    // =============================================================================================
+    // =============================================================================================
+    Result result      = Result::ZC_SUCCESS;
+    std::size_t cursor = 0;
+    {
+        bool progress = true;
+        while (result == Result::ZC_SUCCESS && progress)
+        {
+            const std::byte* p          = state.pending.data() + cursor;
+            const std::size_t available = state.pending.size() - cursor;
+            progress                    = false;
+
+            switch (state.stage)
+            {
+            case decoder::Stage::HEADER:
+                if (available < FRAME_HEADER_SIZE)
+                {
+                    break;
+                }
+                state.block_size = read32(p + 8);
+                if (read32(p) != FRAME_MAGIC || std::to_integer<std::uint32_t>(p[4]) != FRAME_VERSION || state.block_size == 0 || state.block_size > MAX_BLOCK_SIZE)
+                {
+                    result = Result::ZC_INVALID_FORMAT;
+                    break;
+                }
+                checksum_reset(&state.checksum);
+                cursor      += FRAME_HEADER_SIZE;
+                state.stage  = decoder::Stage::BLOCK_HEADER;
+                progress     = true;
+                break;
+
+            case decoder::Stage::BLOCK_HEADER:
+                if (available < 4)
+                {
+                    break;
+                }
+                state.block_header = read32(p);
+                if ((state.block_header & ~UNCOMPRESSED_BIT) > compress_bound(state.block_size))
+                {
+                    result = Result::ZC_INVALID_FORMAT;
+                    break;
+                }
+                cursor      += 4;
+                state.stage  = state.block_header == 0 ? decoder::Stage::CHECKSUM : decoder::Stage::BLOCK;
+                progress     = true;
+                break;
+
+            case decoder::Stage::BLOCK:
+            {
+                const std::size_t stored_size = state.block_header & ~UNCOMPRESSED_BIT;
+                if (available < stored_size)
+                {
+                    break;
+                }
+
+                const std::size_t old_size = p_out->size();
+                if ((state.block_header & UNCOMPRESSED_BIT) != 0)
+                {
+                    if (stored_size > state.block_size)
+                    {
+                        result = Result::ZC_INVALID_FORMAT;
+                        break;
+                    }
+                    p_out->insert(p_out->end(), p, p + stored_size);
+                }
+                else
+                {
+                    p_out->resize(old_size + state.block_size);
+
+                    span<std::byte> decoded;
+                    result = decompress_block({p, stored_size}, {p_out->data() + old_size, state.block_size}, &decoded);
+                    p_out->resize(result == Result::ZC_SUCCESS ? old_size + decoded.count : old_size);
+                    if (result != Result::ZC_SUCCESS)
+                    {
+                        break;
+                    }
+                }
+
+                checksum_update(&state.checksum, {p_out->data() + old_size, p_out->size() - old_size});
+                cursor      += stored_size;
+                state.stage  = decoder::Stage::BLOCK_HEADER;
+                progress     = true;
+                break;
+            }
+
+            case decoder::Stage::CHECKSUM:
+                if (available < 4)
+                {
+                    break;
+                }
+                if (read32(p) != checksum_digest(&state.checksum))
+                {
+                    result = Result::ZC_CHECKSUM_MISMATCH;
+                    break;
+                }
+                cursor      += 4;
+                state.stage  = decoder::Stage::DONE;
+                progress     = true;
+                break;
+
+            case decoder::Stage::DONE:
+                if (available > 0)
+                {
+                    result = Result::ZC_INVALID_FORMAT;
+                }
+                break;
+            }
+        }
+
+        state.pending.erase(state.pending.begin(), state.pending.begin() + static_cast<std::ptrdiff_t>(cursor));
+    }
+
+    return result;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// compress_frame: One-shot helper over the streaming encoder.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::compress::compress_frame(span<const std::byte> src, Level level, std::vector<std::byte>* p_out)
+{
+    encoder enc      = {};
+    enc.config.level = level;
+    encoder_write(&enc, src, p_out);
+    encoder_finish(&enc, p_out);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// decompress_frame: One-shot helper over the streaming decoder. Fails with ZC_INVALID_FORMAT when the frame is truncated.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::Result zp::compress::decompress_frame(span<const std::byte> src, std::vector<std::byte>* p_out)
+{
+    decoder dec         = {};
+    const Result result = decoder_feed(&dec, src, p_out);
+    if (result != Result::ZC_SUCCESS)
+    {
+        return result;
+    }
+    return dec.state.stage == decoder::Stage::DONE ? Result::ZC_SUCCESS : Result::ZC_INVALID_FORMAT;
+}
@@ -0,0 +1,131 @@
+#include "zp_cpp/concurrent_event.hpp"
+
+#include <thread>
+
+struct zp::dispatch_queue::State::Internal
+{
+    std::mutex mutex;
+    std::vector<small_function<void()>> posted;
+    std::vector<small_function<void()>> running; // kept between drains so steady-state draining does not allocate.
+};
+
+namespace
+{
+    // read sections the calling thread is inside, across every rcu_epoch.
+    thread_local std::uint32_t t_read_depth = 0;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// dispatch_init: Allocates the queue.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::dispatch_init(dispatch_queue* p_queue)
+{
+    p_queue->state.p_i = new dispatch_queue::State::Internal();
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// dispatch_exit: Drops any work still queued without running it and releases the queue.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::dispatch_exit(dispatch_queue* p_queue)
+{
+    delete p_queue->state.p_i;
+    p_queue->state.p_i = nullptr;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// dispatch_post: Queues work for the owner's next dispatch_drain.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::dispatch_post(dispatch_queue* p_queue, small_function<void()> work)
+{
+    std::lock_guard<std::mutex> lock(p_queue->state.p_i->mutex);
+    p_queue->state.p_i->posted.push_back(std::move(work));
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// dispatch_drain: Swaps the posted work out under the lock, then runs it without holding it.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::size_t zp::dispatch_drain(dispatch_queue* p_queue)
+{
+    dispatch_queue::State::Internal* p_i = p_queue->state.p_i;
+    {
+        std::lock_guard<std::mutex> lock(p_i->mutex);
+        p_i->running.swap(p_i->posted);
+    }
+
+    for (const small_function<void()>& work : p_i->running)
+    {
+        work();
+    }
+    const std::size_t ran = p_i->running.size();
+    p_i->running.clear();
+    return ran;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// rcu_read_lock: Counts the reader against the current epoch's parity. If the epoch moved before the count landed, a writer may
+// already have checked that parity, so back out and retry against the new epoch.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::uint64_t zp::rcu_read_lock(rcu_epoch* p_rcu)
+{
+    for (;;)
+    {
+        const std::uint64_t epoch = p_rcu->epoch.load();
+        p_rcu->readers[epoch & 1].fetch_add(1);
+        if (p_rcu->epoch.load() == epoch)
+        {
+            ++t_read_depth;
+            return epoch;
+        }
+        p_rcu->readers[epoch & 1].fetch_sub(1);
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// rcu_read_unlock: Leaves the read section entered at epoch.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::rcu_read_unlock(rcu_epoch* p_rcu, std::uint64_t epoch)
+{
+    --t_read_depth;
+    p_rcu->readers[epoch & 1].fetch_sub(1, std::memory_order_release);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// rcu_synchronize: Flips the epoch and drains the parity it left, twice. Readers that saw the old pointer entered under one of
+// the two parities, and any reader entering after a flip reads the new pointer.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::rcu_synchronize(rcu_epoch* p_rcu)
+{
+    std::lock_guard<std::mutex> lock(p_rcu->synchronize_mutex);
+    for (int flip = 0; flip < 2; ++flip)
+    {
+        const std::uint64_t epoch = p_rcu->epoch.fetch_add(1);
+        while (p_rcu->readers[epoch & 1].load(std::memory_order_acquire) != 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// rcu_in_read_section: True while the calling thread is inside any read section.
+// =========================================================================================================================================
+// =========================================================================================================================================
+bool zp::rcu_in_read_section()
+{
+    return t_read_depth != 0;
+}
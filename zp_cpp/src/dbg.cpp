@@ -0,0 +1,423 @@
+#include "zp_cpp/dbg.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr std::size_t QUEUE_CAPACITY = 1024; // power of two
+    constexpr std::size_t QUEUE_MASK     = QUEUE_CAPACITY - 1;
+    constexpr std::size_t MAX_BATCH      = 64;
+
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        std::string line;
+    };
+
+    // bounded multi-producer multi-consumer queue of console lines (Vyukov). lines move in and out by swapping strings, so the
+    // buffers cycle between producers, cells and the writer without reallocating. producers pop too: under backpressure they
+    // discard the oldest line rather than block.
+    struct Sink
+    {
+        Cell cells[QUEUE_CAPACITY];
+        alignas(64) std::atomic<std::size_t> enqueue_pos = 0;
+        alignas(64) std::atomic<std::size_t> dequeue_pos = 0;
+        alignas(64) std::atomic<std::uint32_t> wake      = 0;
+        std::atomic<bool> waiting                        = false;
+        std::atomic<bool> in_flight                      = false;
+        std::atomic<bool> stopping                       = false;
+        std::atomic<std::uint64_t> dropped               = 0;
+        std::atomic<std::uint64_t> dropped_total         = 0;
+        std::thread writer;
+    };
+
+    struct TimestampCache
+    {
+        std::int64_t ms    = -1;
+        std::time_t second = -1;
+        char text[16];
+    };
+
+    // never destroyed: lines logged from static destructors after the atexit drain are written synchronously instead.
+    Sink* g_p_sink = nullptr;
+    std::once_flag g_sink_once;
+
+    thread_local std::ostringstream t_stream;
+    thread_local std::string t_discard;
+    thread_local TimestampCache t_timestamp;
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // try_push: Swaps *p_line into the next free cell. Returns false when the queue is full.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    bool try_push(Sink* p_sink, std::string* p_line)
+    {
+        std::size_t pos = p_sink->enqueue_pos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell                = p_sink->cells[pos & QUEUE_MASK];
+            const std::size_t seq     = cell.sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff < 0)
+            {
+                return false;
+            }
+            if (diff > 0)
+            {
+                pos = p_sink->enqueue_pos.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (p_sink->enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                cell.line.swap(*p_line);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // try_pop: Swaps the oldest published line into *p_line. Returns false when nothing is ready.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    bool try_pop(Sink* p_sink, std::string* p_line)
+    {
+        std::size_t pos = p_sink->dequeue_pos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell                = p_sink->cells[pos & QUEUE_MASK];
+            const std::size_t seq     = cell.sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff < 0)
+            {
+                return false;
+            }
+            if (diff > 0)
+            {
+                pos = p_sink->dequeue_pos.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (p_sink->dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                cell.line.swap(*p_line);
+                cell.sequence.store(pos + QUEUE_CAPACITY, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // write_all: writev that retries on EINTR and resumes after short writes. Other errors drop the rest of the batch.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void write_all(iovec* p_iov, int count)
+    {
+        while (count > 0)
+        {
+            ssize_t written = writev(STDOUT_FILENO, p_iov, count);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return;
+            }
+
+            while (count > 0 && static_cast<std::size_t>(written) >= p_iov->iov_len)
+            {
+                written -= static_cast<ssize_t>(p_iov->iov_len);
+                ++p_iov;
+                --count;
+            }
+            if (count > 0)
+            {
+                p_iov->iov_base = static_cast<char*>(p_iov->iov_base) + written;
+                p_iov->iov_len -= static_cast<std::size_t>(written);
+            }
+        }
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // run_writer: Console writer thread entry. Pops up to MAX_BATCH lines and writes them with one writev, prefixed by a notice when
+    // producers had to drop lines. Sleeps on an atomic wait when the queue is empty.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void run_writer(Sink* p_sink)
+    {
+        std::string batch[MAX_BATCH];
+        iovec iov[MAX_BATCH + 1];
+        std::string notice;
+
+        while (true)
+        {
+            // =============================================================================================
+            // =============================================================================================
+            // Take a batch. in_flight is raised before popping so console_flush never sees an empty queue while lines are unwritten.
+            // =============================================================================================
+            // =============================================================================================
+            std::size_t count     = 0;
+            std::uint64_t dropped = 0;
+            {
+                p_sink->in_flight.store(true);
+                while (count < MAX_BATCH && try_pop(p_sink, &batch[count]))
+                {
+                    ++count;
+                }
+                dropped = p_sink->dropped.exchange(0, std::memory_order_relaxed);
+            }
+
+            // =============================================================================================
+            // =============================================================================================
+            // Idle: exit when stopping, otherwise sleep until a producer bumps wake. waiting is published before the final emptiness
+            // check, so a producer either sees it and wakes us or its line is seen by the check.
+            // =============================================================================================
+            // =============================================================================================
+            if (count == 0 && dropped == 0)
+            {
+                p_sink->in_flight.store(false);
+                if (p_sink->stopping.load())
+                {
+                    break;
+                }
+
+                const std::uint32_t wake = p_sink->wake.load();
+                p_sink->waiting.store(true);
+                if (p_sink->dequeue_pos.load() == p_sink->enqueue_pos.load() && !p_sink->stopping.load())
+                {
+                    p_sink->wake.wait(wake);
+                }
+                p_sink->waiting.store(false);
+                continue;
+            }
+
+            // =============================================================================================
+            // =============================================================================================
+            // Write the batch with one writev and hand the emptied strings back for the next swap.
+            // =============================================================================================
+            // =============================================================================================
+            {
+                int iov_count = 0;
+                if (dropped > 0)
+                {
+                    notice                   = "\033[31m[dbg] " + std::to_string(dropped) + " console lines dropped\033[0m\n";
+                    iov[iov_count].iov_base  = notice.data();
+                    iov[iov_count++].iov_len = notice.size();
+                }
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    iov[iov_count].iov_base  = batch[i].data();
+                    iov[iov_count++].iov_len = batch[i].size();
+                }
+
+                write_all(iov, iov_count);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    batch[i].clear();
+                }
+                p_sink->in_flight.store(false);
+            }
+        }
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // stop_sink: atexit hook. Lets the writer drain what is queued and join it; later lines go out synchronously.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void stop_sink()
+    {
+        g_p_sink->stopping.store(true);
+        g_p_sink->wake.fetch_add(1);
+        g_p_sink->wake.notify_one();
+        g_p_sink->writer.join();
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // sink: Creates the sink and its writer thread on first use.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    Sink* sink()
+    {
+        std::call_once(g_sink_once, []()
+        {
+            g_p_sink = new Sink();
+            for (std::size_t i = 0; i < QUEUE_CAPACITY; ++i)
+            {
+                g_p_sink->cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            g_p_sink->writer = std::thread(run_writer, g_p_sink);
+            std::atexit(stop_sink);
+        });
+        return g_p_sink;
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// stream: Per-thread stream every console line is built in. console_write hands its buffer back, so it is normally empty here.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::ostringstream& zp::dbg::stream()
+{
+    if (t_stream.tellp() > 0)
+    {
+        t_stream.str(std::string());
+    }
+    t_stream.clear();
+    return t_stream;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// timestamp: Local wall-clock "HH:MM:SS.mmm". localtime runs once per second and the text is rebuilt at most once per millisecond.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::string_view zp::dbg::timestamp()
+{
+    const std::int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    if (ms == t_timestamp.ms)
+    {
+        return std::string_view(t_timestamp.text, 12);
+    }
+
+    const std::time_t second = static_cast<std::time_t>(ms / 1000);
+    if (second != t_timestamp.second)
+    {
+        std::tm tm_local;
+#if defined(_WIN32) || defined(_WIN64)
+        localtime_s(&tm_local, &second);
+#else
+        localtime_r(&second, &tm_local);
+#endif
+        std::strftime(t_timestamp.text, sizeof(t_timestamp.text), "%H:%M:%S.", &tm_local);
+        t_timestamp.second = second;
+    }
+
+    const int milli      = static_cast<int>(ms % 1000);
+    t_timestamp.text[9]  = static_cast<char>('0' + milli / 100);
+    t_timestamp.text[10] = static_cast<char>('0' + milli / 10 % 10);
+    t_timestamp.text[11] = static_cast<char>('0' + milli % 10);
+    t_timestamp.ms       = ms;
+    return std::string_view(t_timestamp.text, 12);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// console_write: Queues the line built in oss and returns without touching stdout. When the queue is full the oldest line is
+// dropped; the writer reports how many.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::dbg::console_write(std::ostringstream& oss)
+{
+    Sink* p_sink     = sink();
+    std::string line = std::move(oss).str();
+
+    // =================================================================================================
+    // =================================================================================================
+    // After the atexit drain there is no writer left: write through.
+    // =================================================================================================
+    // =================================================================================================
+    if (p_sink->stopping.load(std::memory_order_acquire))
+    {
+        std::size_t offset = 0;
+        while (offset < line.size())
+        {
+            const ssize_t written = write(STDOUT_FILENO, line.data() + offset, line.size() - offset);
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (written <= 0)
+            {
+                break;
+            }
+            offset += static_cast<std::size_t>(written);
+        }
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Queue the line, evicting the oldest while full, and wake the writer if it is asleep.
+    // =================================================================================================
+    // =================================================================================================
+    else
+    {
+        while (!try_push(p_sink, &line))
+        {
+            if (try_pop(p_sink, &t_discard))
+            {
+                p_sink->dropped.fetch_add(1, std::memory_order_relaxed);
+                p_sink->dropped_total.fetch_add(1, std::memory_order_relaxed);
+                t_discard.clear();
+            }
+        }
+
+        if (p_sink->waiting.load())
+        {
+            p_sink->wake.fetch_add(1);
+            p_sink->wake.notify_one();
+        }
+    }
+
+    line.clear();
+    oss.str(std::move(line));
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// console_flush: Blocks until every queued line has been written.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::dbg::console_flush()
+{
+    Sink* p_sink = sink();
+    while (!p_sink->stopping.load())
+    {
+        if (p_sink->dequeue_pos.load() == p_sink->enqueue_pos.load() && !p_sink->in_flight.load())
+        {
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// console_dropped: Lines discarded under backpressure since startup.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::uint64_t zp::dbg::console_dropped()
+{
+    return sink()->dropped_total.load(std::memory_order_relaxed);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// report_suppressed: Summary line of a throttled console site, formatted like _DBG_EMIT with the site's recorded location.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::dbg::report_suppressed(const zp::log::SiteThrottle* p_throttle, std::uint64_t suppressed)
+{
+    std::ostringstream& oss = stream();
+    oss << "\033[33m[" << timestamp() << "] \033[34m[" << p_throttle->file << ":" << p_throttle->line << "]" << p_throttle->colour << " " << suppressed << " messages suppressed\033[0m\n";
+    console_write(oss);
+}
@@ -0,0 +1,86 @@
+#include "zp_cpp/event_queue.hpp"
+
+#include <atomic>
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// next_queue_type_index: Hands out the process-wide channel index of one event type.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::uint32_t zp::next_queue_type_index()
+{
+    static std::atomic<std::uint32_t> next = 0;
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// dispatch_all: Delivers every channel's batch in first-seen order, then merges the channels' events by sequence number. Channels
+// created by a handler start with the next call.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::dispatch_all(event_queue* p_queue)
+{
+    const std::size_t count = p_queue->state.order.size();
+
+    // =================================================================================================
+    // =================================================================================================
+    // Take every channel's pending events and hand each batch to its span handlers.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            // copied: a handler that creates a channel may reallocate channels mid-dispatch.
+            const event_queue::Channel channel = p_queue->state.channels[p_queue->state.order[i]];
+            channel.begin(channel.p_channel.get());
+        }
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Deliver the single events oldest first. A queue holds a handful of types, so each step scans them all for the lowest
+    // sequence number rather than keeping a heap.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        while (true)
+        {
+            std::size_t earliest = count;
+            std::uint64_t lowest = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const event_queue::Channel& channel = p_queue->state.channels[p_queue->state.order[i]];
+                std::uint64_t sequence              = 0;
+                if (channel.next(channel.p_channel.get(), &sequence) && (earliest == count || sequence < lowest))
+                {
+                    earliest = i;
+                    lowest   = sequence;
+                }
+            }
+            if (earliest == count)
+            {
+                break;
+            }
+
+            const event_queue::Channel channel = p_queue->state.channels[p_queue->state.order[earliest]];
+            channel.deliver(channel.p_channel.get());
+        }
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// queue_pending: Events waiting for the next dispatch_all, across all types.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::size_t zp::queue_pending(const event_queue* p_queue)
+{
+    std::size_t pending = 0;
+    for (const std::uint32_t index : p_queue->state.order)
+    {
+        const event_queue::Channel& channel = p_queue->state.channels[index];
+        pending                            += channel.pending(channel.p_channel.get());
+    }
+    return pending;
+}
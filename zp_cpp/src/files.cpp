@@ -1,12 +1,255 @@
 #include "zp_cpp/files.hpp"
+#include "zp_cpp/jobs.hpp"
+#include "zp_cpp/prof.hpp"
+#include "zp_cpp/stats.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <fstream>
 #include <functional>
 #include <map>
+#include <mutex>
+#include <set>
 #include <string>
 #include <thread>
+#include <unordered_set>
 #include <vector>
 
+#include <fcntl.h>
+#include <unistd.h>
+
+struct zp::files::async_writer::State::Internal
+{
+    struct Job
+    {
+        std::filesystem::path path;
+        std::shared_ptr<const std::vector<std::byte>> data;
+        std::promise<zp::Result> promise;
+        std::chrono::steady_clock::time_point queued_at;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Job> queue;
+    bool stopping;
+    std::uint64_t tmp_seq;
+    std::thread worker;
+
+    std::atomic<std::size_t> bytes_in_flight;
+    std::atomic<std::uint64_t> writes_completed;
+    std::atomic<std::uint64_t> writes_failed;
+    std::atomic<std::uint64_t> last_latency_ns;
+    zp::stats::histogram latency; // recorded by the worker only.
+};
+
+namespace
+{
+    constexpr std::uint32_t SNAPSHOT_MAGIC   = 0x5344505a; // "ZPDS" little endian
+    constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+
+    struct SnapshotHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t count;
+    };
+
+    // followed by the optional content hash and then path_len bytes of the '/'-separated path relative to the watched dir.
+    struct SnapshotRecord
+    {
+        std::uint64_t path_hash;
+        std::uint64_t size;
+        std::int64_t last_write;
+        std::uint32_t path_len;
+        std::uint32_t has_content_hash;
+    };
+
+    struct ScanResult
+    {
+        std::filesystem::path path;
+        std::filesystem::file_time_type last_write;
+        std::uintmax_t size;
+    };
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // hash_file: Hashes the full contents of a file. Returns false when the file cannot be read.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    bool hash_file(const std::filesystem::path& path, zp::hash::hash256* p_out)
+    {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs.is_open())
+        {
+            return false;
+        }
+
+        const std::vector<char> contents((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        *p_out = zp::hash::hash_data(contents.data(), contents.size());
+        return true;
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // run_writer: Worker loop for async_writer. Each batch writes all of its temp files first, then fsyncs and renames them
+    // together and syncs every touched directory once, so one durability round covers several files.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void run_writer(zp::files::async_writer* p_writer)
+    {
+        zp::files::async_writer::State::Internal* p_i = p_writer->state.p_i;
+
+        std::vector<zp::files::async_writer::State::Internal::Job> batch;
+        while (true)
+        {
+            // =====================================================================================
+            // =====================================================================================
+            // Wait for work and take up to max_batch jobs off the queue. Exit once stopped and drained.
+            // =====================================================================================
+            // =====================================================================================
+            std::uint64_t first_seq;
+            {
+                std::unique_lock<std::mutex> lock(p_i->mutex);
+                p_i->cv.wait(lock, [p_i]() { return p_i->stopping || !p_i->queue.empty(); });
+                if (p_i->queue.empty())
+                {
+                    break;
+                }
+
+                while (!p_i->queue.empty() && batch.size() < p_writer->config.max_batch)
+                {
+                    batch.push_back(std::move(p_i->queue.front()));
+                    p_i->queue.pop_front();
+                }
+
+                first_seq     = p_i->tmp_seq;
+                p_i->tmp_seq += batch.size();
+            }
+
+            // =====================================================================================
+            // =====================================================================================
+            // Write every job into a sibling temp file without syncing yet.
+            // =====================================================================================
+            // =====================================================================================
+            std::vector<int> fds(batch.size(), -1);
+            std::vector<std::filesystem::path> tmp_paths(batch.size());
+            std::vector<zp::Result> results(batch.size(), zp::Result::ZC_SUCCESS);
+            {
+                for (std::size_t i = 0; i < batch.size(); ++i)
+                {
+                    tmp_paths[i] = batch[i].path;
+                    tmp_paths[i] += ".tmp." + std::to_string(first_seq + i);
+
+                    fds[i]       = ::open(tmp_paths[i].c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                    if (fds[i] < 0)
+                    {
+                        results[i] = zp::Result::ZC_FILE_ACCESS_ERROR;
+                        continue;
+                    }
+
+                    const std::byte* p_bytes = batch[i].data->data();
+                    std::size_t remaining    = batch[i].data->size();
+                    while (remaining > 0)
+                    {
+                        const ssize_t written = ::write(fds[i], p_bytes, remaining);
+                        if (written < 0 && errno == EINTR)
+                        {
+                            continue;
+                        }
+                        if (written < 0)
+                        {
+                            results[i] = zp::Result::ZC_FILE_WRITE_ERROR;
+                            break;
+                        }
+                        p_bytes   += written;
+                        remaining -= static_cast<std::size_t>(written);
+                    }
+                }
+            }
+
+            // =====================================================================================
+            // =====================================================================================
+            // Sync, close and atomically rename each temp file over its target, then sync each touched directory once.
+            // =====================================================================================
+            // =====================================================================================
+            {
+                std::set<std::filesystem::path> dirs;
+                for (std::size_t i = 0; i < batch.size(); ++i)
+                {
+                    if (fds[i] < 0)
+                    {
+                        continue;
+                    }
+
+                    if (results[i] == zp::Result::ZC_SUCCESS && ::fsync(fds[i]) != 0)
+                    {
+                        results[i] = zp::Result::ZC_FILE_WRITE_ERROR;
+                    }
+                    ::close(fds[i]);
+
+                    if (results[i] == zp::Result::ZC_SUCCESS && std::rename(tmp_paths[i].c_str(), batch[i].path.c_str()) != 0)
+                    {
+                        results[i] = zp::Result::ZC_FILE_WRITE_ERROR;
+                    }
+
+                    if (results[i] != zp::Result::ZC_SUCCESS)
+                    {
+                        ::unlink(tmp_paths[i].c_str());
+                        continue;
+                    }
+
+                    const std::filesystem::path dir = batch[i].path.parent_path();
+                    dirs.insert(dir.empty() ? std::filesystem::path(".") : dir);
+                }
+
+                for (const auto& dir : dirs)
+                {
+                    const int dir_fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                    if (dir_fd >= 0)
+                    {
+                        ::fsync(dir_fd);
+                        ::close(dir_fd);
+                    }
+                }
+            }
+
+            // =====================================================================================
+            // =====================================================================================
+            // Record metrics and complete the futures.
+            // =====================================================================================
+            // =====================================================================================
+            {
+                const auto done_at = std::chrono::steady_clock::now();
+                for (std::size_t i = 0; i < batch.size(); ++i)
+                {
+                    const std::uint64_t latency_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(done_at - batch[i].queued_at).count());
+
+                    p_i->last_latency_ns.store(latency_ns, std::memory_order_relaxed);
+                    zp::stats::record(&p_i->latency, latency_ns);
+
+                    if (results[i] == zp::Result::ZC_SUCCESS)
+                    {
+                        p_i->writes_completed.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    else
+                    {
+                        p_i->writes_failed.fetch_add(1, std::memory_order_relaxed);
+                    }
+
+                    p_i->bytes_in_flight.fetch_sub(batch[i].data->size(), std::memory_order_relaxed);
+                    batch[i].promise.set_value(results[i]);
+                }
+                batch.clear();
+            }
+        }
+    }
+}
+
 // =========================================================================================================================================
 // =========================================================================================================================================
 // read_file: Modern span-based version that reads file contents into a span buffer with proper error handling.
@@ -75,50 +318,267 @@ zp::Result zp::files::write_file(const std::filesystem::path& path, zp::span<con
 
 // =========================================================================================================================================
 // =========================================================================================================================================
-// poll_dir: Polls directory for file changes, invoking callbacks for created, modified, or destroyed files.
+// start_writer: Allocates the writer internals and spawns the worker thread that drains queued writes.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::files::start_writer(async_writer* p_writer)
+{
+    p_writer->state.p_i           = new async_writer::State::Internal();
+    p_writer->state.p_i->stopping = false;
+    p_writer->state.p_i->tmp_seq  = 0;
+    p_writer->state.p_i->worker   = std::thread(run_writer, p_writer);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// stop_writer: Finishes every queued write, joins the worker thread and releases the writer internals.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::files::stop_writer(async_writer* p_writer)
+{
+    if (p_writer->state.p_i == nullptr)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(p_writer->state.p_i->mutex);
+        p_writer->state.p_i->stopping = true;
+    }
+    p_writer->state.p_i->cv.notify_one();
+    p_writer->state.p_i->worker.join();
+
+    delete p_writer->state.p_i;
+    p_writer->state.p_i = nullptr;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// write_file_async: Queues data to be written to path via temp file plus rename. Never blocks on I/O; returns ZC_QUEUE_FULL
+// when max_queued writes are already pending. The future resolves with the result of the write once it is durable.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::Result zp::files::write_file_async(async_writer* p_writer, const std::filesystem::path& path, std::shared_ptr<const std::vector<std::byte>> data, std::future<Result>* p_out)
+{
+    async_writer::State::Internal* p_i = p_writer->state.p_i;
+
+    // =============================================================================================
+    // =============================================================================================
+    // Enqueue the job unless the queue is already at capacity.
+    // =============================================================================================
+    // =============================================================================================
+    {
+        std::lock_guard<std::mutex> lock(p_i->mutex);
+        if (p_i->queue.size() >= p_writer->config.max_queued)
+        {
+            return Result::ZC_QUEUE_FULL;
+        }
+
+        async_writer::State::Internal::Job job;
+        job.path      = path;
+        job.data      = std::move(data);
+        job.queued_at = std::chrono::steady_clock::now();
+        *p_out        = job.promise.get_future();
+
+        p_i->bytes_in_flight.fetch_add(job.data->size(), std::memory_order_relaxed);
+        p_i->queue.push_back(std::move(job));
+    }
+
+    p_i->cv.notify_one();
+    return Result::ZC_SUCCESS;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// get_metrics: Returns a snapshot of queue depth, bytes in flight, write counters and the latency distribution.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::files::async_writer::Metrics zp::files::get_metrics(const async_writer* p_writer)
+{
+    async_writer::State::Internal* p_i = p_writer->state.p_i;
+
+    async_writer::Metrics metrics      = {};
+    {
+        std::lock_guard<std::mutex> lock(p_i->mutex);
+        metrics.queue_depth = p_i->queue.size();
+    }
+    metrics.bytes_in_flight  = p_i->bytes_in_flight.load(std::memory_order_relaxed);
+    metrics.writes_completed = p_i->writes_completed.load(std::memory_order_relaxed);
+    metrics.writes_failed    = p_i->writes_failed.load(std::memory_order_relaxed);
+    metrics.last_latency_ns  = p_i->last_latency_ns.load(std::memory_order_relaxed);
+    metrics.max_latency_ns   = p_i->latency.state.max.load(std::memory_order_relaxed);
+    metrics.total_latency_ns = p_i->latency.state.sum.load(std::memory_order_relaxed);
+    metrics.p50_latency_ns   = zp::stats::value_at_percentile(&p_i->latency, 50.0);
+    metrics.p99_latency_ns   = zp::stats::value_at_percentile(&p_i->latency, 99.0);
+    metrics.p999_latency_ns  = zp::stats::value_at_percentile(&p_i->latency, 99.9);
+    return metrics;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// poll_dir: Polls directory for file changes, invoking callbacks for created, modified, or destroyed files. Subdirectories
+// below config.dir are stat'ed in parallel on zp::jobs; callbacks always run on the calling thread.
 // =========================================================================================================================================
 // =========================================================================================================================================
 void zp::files::poll_dir(dir_watcher* p_dir_watcher)
 {
-    // ====================================================================================================
-    // ====================================================================================================
-    // Detect new and modified files by comparing last write times against known state.
-    // ====================================================================================================
-    // ====================================================================================================
+    ZP_PROF_ZONE("files::poll_dir");
+
+    // =============================================================================================
+    // =============================================================================================
+    // Split the top level into loose files and subdirectory roots that can be scanned independently.
+    // =============================================================================================
+    // =============================================================================================
+    std::vector<ScanResult> top_files;
+    std::vector<std::filesystem::path> roots;
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(p_dir_watcher->config.dir))
+        {
+            if (entry.is_directory() && !entry.is_symlink())
+            {
+                roots.push_back(entry.path());
+            }
+            else if (std::filesystem::is_regular_file(entry))
+            {
+                top_files.push_back({entry.path(), entry.last_write_time(), entry.file_size()});
+            }
+        }
+    }
+
+    // =============================================================================================
+    // =============================================================================================
+    // Stat every subdirectory tree in parallel. Each root gets its own result list so merging keeps a stable order, and
+    // files vanishing mid-scan are skipped rather than thrown on a worker thread. A directory that cannot be read, other than
+    // one deleted mid-scan, marks its root incomplete and is skipped while the rest of the root is still scanned.
+    // =============================================================================================
+    // =============================================================================================
+    std::vector<std::vector<ScanResult>> root_results(roots.size());
+    std::vector<char> root_incomplete(roots.size(), 0);
     {
-        for (const auto& entry : std::filesystem::recursive_directory_iterator(p_dir_watcher->config.dir))
+        const auto scan_roots = [&](std::uint64_t first, std::uint64_t last)
         {
-            if (!std::filesystem::is_regular_file(entry))
+            for (std::uint64_t r = first; r < last; ++r)
             {
-                continue;
+                std::vector<std::filesystem::path> dirs = {roots[r]};
+                while (!dirs.empty())
+                {
+                    const std::filesystem::path dir = std::move(dirs.back());
+                    dirs.pop_back();
+
+                    std::error_code ec;
+                    for (std::filesystem::directory_iterator it(dir, ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+                    {
+                        std::error_code entry_ec;
+                        if (it->is_directory(entry_ec) && !it->is_symlink(entry_ec))
+                        {
+                            dirs.push_back(it->path());
+                            continue;
+                        }
+                        if (!it->is_regular_file(entry_ec))
+                        {
+                            continue;
+                        }
+
+                        const std::filesystem::file_time_type last_write = it->last_write_time(entry_ec);
+                        const std::uintmax_t size                        = entry_ec ? 0 : it->file_size(entry_ec);
+                        if (!entry_ec)
+                        {
+                            root_results[r].push_back({it->path(), last_write, size});
+                        }
+                    }
+                    if (ec && ec != std::errc::no_such_file_or_directory)
+                    {
+                        root_incomplete[r] = 1;
+                    }
+                }
             }
+        };
+        zp::jobs::parallel_for(0, roots.size(), scan_roots, 1);
+    }
 
-            const std::filesystem::path& path                = entry.path();
-            const std::filesystem::file_time_type& last_time = entry.last_write_time();
+    // =============================================================================================
+    // =============================================================================================
+    // Detect new and modified files by comparing size and last write time against known state. With hash_contents a
+    // changed timestamp over identical bytes is absorbed silently.
+    // =============================================================================================
+    // =============================================================================================
+    std::unordered_set<std::filesystem::path> seen;
+    {
+        auto visit = [&](const ScanResult& result)
+        {
+            seen.insert(result.path);
 
-            if (!p_dir_watcher->state.known.contains(path))
+            auto it = p_dir_watcher->state.known.find(result.path);
+            if (it == p_dir_watcher->state.known.end())
             {
-                p_dir_watcher->state.known.insert({path, last_time});
-                p_dir_watcher->config.on_file_created(path);
+                dir_watcher::Record record = {result.last_write, result.size, false, {}};
+                if (p_dir_watcher->config.hash_contents)
+                {
+                    record.has_content_hash = hash_file(result.path, &record.content_hash);
+                }
+
+                p_dir_watcher->state.known.insert({result.path, record});
+                p_dir_watcher->config.on_file_created(result.path);
             }
-            else if (p_dir_watcher->state.known.at(path) != last_time)
+            else if (it->second.last_write != result.last_write || it->second.size != result.size)
             {
-                p_dir_watcher->state.known[path] = last_time;
-                p_dir_watcher->config.on_file_modified(path);
+                dir_watcher::Record& record = it->second;
+                record.last_write           = result.last_write;
+                record.size                 = result.size;
+
+                bool same_content           = false;
+                if (p_dir_watcher->config.hash_contents)
+                {
+                    zp::hash::hash256 content_hash = {};
+                    const bool hashed              = hash_file(result.path, &content_hash);
+                    same_content                   = hashed && record.has_content_hash && content_hash == record.content_hash;
+                    record.has_content_hash        = hashed;
+                    record.content_hash            = content_hash;
+                }
+
+                if (!same_content)
+                {
+                    p_dir_watcher->config.on_file_modified(result.path);
+                }
+            }
+        };
+
+        for (const auto& result : top_files)
+        {
+            visit(result);
+        }
+        for (const auto& results : root_results)
+        {
+            for (const auto& result : results)
+            {
+                visit(result);
             }
         }
     }
 
-    // ====================================================================================================
-    // ====================================================================================================
-    // Detect destroyed files by checking if known paths still exist on filesystem.
-    // ====================================================================================================
-    // ====================================================================================================
+    // =============================================================================================
+    // =============================================================================================
+    // Detect destroyed files as known paths that the scan no longer saw. Paths under an incomplete root are left for a
+    // later poll, since not seeing them proves nothing.
+    // =============================================================================================
+    // =============================================================================================
     {
+        const auto under_incomplete_root = [&](const std::filesystem::path& path)
+        {
+            for (std::size_t r = 0; r < roots.size(); ++r)
+            {
+                if (root_incomplete[r] && std::mismatch(roots[r].begin(), roots[r].end(), path.begin(), path.end()).first == roots[r].end())
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
+
         std::vector<std::filesystem::path> destroyed;
-        for (auto&& [path, last_write] : p_dir_watcher->state.known)
+        for (auto&& [path, record] : p_dir_watcher->state.known)
         {
-            if (!std::filesystem::exists(path))
+            if (!seen.contains(path) && !under_incomplete_root(path))
             {
                 destroyed.push_back(path);
             }
@@ -132,6 +592,162 @@ void zp::files::poll_dir(dir_watcher* p_dir_watcher)
     }
 }
 
+// =========================================================================================================================================
+// =========================================================================================================================================
+// save_snapshot: Serializes the watcher's known state so a later process can resume polling without re-reporting every file.
+// Records store paths relative to config.dir and are written to a temp file that is renamed over snapshot_path.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::Result zp::files::save_snapshot(const dir_watcher* p_dir_watcher, const std::filesystem::path& snapshot_path)
+{
+    // =============================================================================================
+    // =============================================================================================
+    // Encode the header followed by one record per known file.
+    // =============================================================================================
+    // =============================================================================================
+    std::vector<std::byte> bytes;
+    {
+        auto append = [&bytes](const void* p, std::size_t size)
+        {
+            const std::byte* p_bytes = static_cast<const std::byte*>(p);
+            bytes.insert(bytes.end(), p_bytes, p_bytes + size);
+        };
+
+        SnapshotHeader header = {SNAPSHOT_MAGIC, SNAPSHOT_VERSION, p_dir_watcher->state.known.size()};
+        append(&header, sizeof(header));
+
+        for (auto&& [path, record] : p_dir_watcher->state.known)
+        {
+            const std::string rel            = path.lexically_relative(p_dir_watcher->config.dir).generic_string();
+
+            SnapshotRecord snapshot_record   = {};
+            snapshot_record.path_hash        = zp::hash::hash_str(rel);
+            snapshot_record.size             = record.size;
+            snapshot_record.last_write       = record.last_write.time_since_epoch().count();
+            snapshot_record.path_len         = static_cast<std::uint32_t>(rel.size());
+            snapshot_record.has_content_hash = record.has_content_hash ? 1 : 0;
+
+            append(&snapshot_record, sizeof(snapshot_record));
+            if (record.has_content_hash)
+            {
+                append(&record.content_hash, sizeof(record.content_hash));
+            }
+            append(rel.data(), rel.size());
+        }
+    }
+
+    // =============================================================================================
+    // =============================================================================================
+    // Write to a sibling temp file and rename it into place so a crash never leaves a truncated snapshot.
+    // =============================================================================================
+    // =============================================================================================
+    {
+        std::filesystem::path tmp_path  = snapshot_path;
+        tmp_path                       += ".tmp";
+
+        const Result result             = write_file(tmp_path, span<const std::byte>{bytes.data(), bytes.size()});
+        if (result != Result::ZC_SUCCESS)
+        {
+            return result;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tmp_path, snapshot_path, ec);
+        if (ec)
+        {
+            return Result::ZC_FILE_WRITE_ERROR;
+        }
+    }
+
+    return Result::ZC_SUCCESS;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// load_snapshot: Replaces the watcher's known state with a snapshot written by save_snapshot. The next poll_dir then only
+// reports files that changed since the snapshot was taken.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::Result zp::files::load_snapshot(dir_watcher* p_dir_watcher, const std::filesystem::path& snapshot_path)
+{
+    // =============================================================================================
+    // =============================================================================================
+    // Read the whole snapshot into memory.
+    // =============================================================================================
+    // =============================================================================================
+    std::vector<std::byte> bytes;
+    {
+        std::ifstream ifs(snapshot_path, std::ios::binary);
+        if (!ifs.is_open())
+        {
+            return Result::ZC_FILE_NOT_FOUND;
+        }
+
+        bytes.resize(std::filesystem::file_size(snapshot_path));
+        ifs.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!ifs.good())
+        {
+            return Result::ZC_FILE_READ_ERROR;
+        }
+    }
+
+    // =============================================================================================
+    // =============================================================================================
+    // Decode the records, checking bounds and each path hash before anything is committed to the watcher.
+    // =============================================================================================
+    // =============================================================================================
+    std::unordered_map<std::filesystem::path, dir_watcher::Record> known;
+    {
+        std::size_t offset = 0;
+        auto take          = [&bytes, &offset](void* p, std::size_t size)
+        {
+            if (size > bytes.size() - offset)
+            {
+                return false;
+            }
+            std::memcpy(p, bytes.data() + offset, size);
+            offset += size;
+            return true;
+        };
+
+        SnapshotHeader header = {};
+        if (!take(&header, sizeof(header)) || header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION)
+        {
+            return Result::ZC_INVALID_FORMAT;
+        }
+
+        for (std::uint64_t i = 0; i < header.count; ++i)
+        {
+            SnapshotRecord snapshot_record = {};
+            dir_watcher::Record record     = {};
+            std::string rel;
+
+            bool ok                        = take(&snapshot_record, sizeof(snapshot_record));
+            if (ok && snapshot_record.has_content_hash)
+            {
+                ok = take(&record.content_hash, sizeof(record.content_hash));
+            }
+            if (ok)
+            {
+                rel.resize(snapshot_record.path_len);
+                ok = take(rel.data(), rel.size()) && zp::hash::hash_str(rel) == snapshot_record.path_hash;
+            }
+            if (!ok)
+            {
+                return Result::ZC_INVALID_FORMAT;
+            }
+
+            record.last_write       = std::filesystem::file_time_type(std::filesystem::file_time_type::duration(snapshot_record.last_write));
+            record.size             = snapshot_record.size;
+            record.has_content_hash = snapshot_record.has_content_hash != 0;
+            known.insert({p_dir_watcher->config.dir / rel, record});
+        }
+    }
+
+    p_dir_watcher->state.known = std::move(known);
+    return Result::ZC_SUCCESS;
+}
+
 // =========================================================================================================================================
 // =========================================================================================================================================
 // has_changed: Checks if the file has changed since the last poll.
@@ -0,0 +1,171 @@
+#include "zp_cpp/frame_loop.hpp"
+
+#include <algorithm>
+
+struct zp::frame_loop::State::Internal
+{
+    ens last_start_ns;
+    ens next_frame_ns; // pacing deadline of the next frame; 0 until the first frame sets it.
+    ens accumulator_ns;
+    stats::histogram frame_times;
+    stats::histogram work_times;
+};
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// loop_init: Allocates the loop's timing state. The first frame starts timing from here.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::loop_init(frame_loop* p_loop)
+{
+    p_loop->config.sim_step_ns        = std::max<ens>(p_loop->config.sim_step_ns, 1);
+    p_loop->state.p_i                 = new frame_loop::State::Internal();
+    p_loop->state.p_i->last_start_ns  = clock::now_ns();
+    p_loop->state.p_i->next_frame_ns  = 0;
+    p_loop->state.p_i->accumulator_ns = 0;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// loop_exit: Releases the loop's timing state and histograms.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::loop_exit(frame_loop* p_loop)
+{
+    delete p_loop->state.p_i;
+    p_loop->state.p_i = nullptr;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// loop_frame: Accumulates the time since the last frame, runs the stages with as many whole simulation steps as fit, then paces.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::loop_frame(frame_loop* p_loop)
+{
+    frame_loop::State::Internal* p_i = p_loop->state.p_i;
+    const frame_loop::Config& config = p_loop->config;
+    const frame_loop::Stages& stages = p_loop->stages;
+    const ens start_ns               = clock::now_ns();
+
+    // =================================================================================================
+    // =================================================================================================
+    // Bank the elapsed time and clamp catch-up so one long stall cannot snowball into ever longer frames.
+    // =================================================================================================
+    // =================================================================================================
+    std::uint64_t steps              = 0;
+    {
+        if (p_loop->state.frames != 0)
+        {
+            stats::record(&p_i->frame_times, start_ns - p_i->last_start_ns);
+        }
+        p_i->accumulator_ns += start_ns - p_i->last_start_ns;
+        p_i->last_start_ns   = start_ns;
+
+        steps                = p_i->accumulator_ns / config.sim_step_ns;
+        if (steps > config.max_steps_per_frame)
+        {
+            p_loop->state.dropped_steps += steps - config.max_steps_per_frame;
+            p_i->accumulator_ns         -= (steps - config.max_steps_per_frame) * config.sim_step_ns;
+            steps                        = config.max_steps_per_frame;
+        }
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Stages, always in this order.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        if (stages.poll_input)
+        {
+            stages.poll_input();
+        }
+        if (stages.receive)
+        {
+            stages.receive();
+        }
+        for (std::uint64_t i = 0; i < steps; ++i)
+        {
+            if (stages.simulate)
+            {
+                stages.simulate(config.sim_step_ns);
+            }
+            p_i->accumulator_ns -= config.sim_step_ns;
+            ++p_loop->state.sim_steps;
+        }
+        if (stages.send)
+        {
+            stages.send();
+        }
+        if (stages.update_ui)
+        {
+            stages.update_ui();
+        }
+
+        p_loop->state.alpha = static_cast<float>(static_cast<double>(p_i->accumulator_ns) / static_cast<double>(config.sim_step_ns));
+        if (stages.render)
+        {
+            stages.render(p_loop->state.alpha);
+        }
+    }
+
+    const ens end_ns = clock::now_ns();
+    stats::record(&p_i->work_times, end_ns - start_ns);
+    ++p_loop->state.frames;
+
+    // =================================================================================================
+    // =================================================================================================
+    // Pace to target_frame_ns through clock::sleep_until, which spins the last spin_ns since sleeps overshoot by up to a
+    // scheduler tick. A frame that ran over resyncs the schedule instead of rushing the following frames to catch up.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        if (config.target_frame_ns == 0)
+        {
+            return;
+        }
+
+        p_i->next_frame_ns = (p_i->next_frame_ns == 0 ? start_ns : p_i->next_frame_ns) + config.target_frame_ns;
+        if (p_i->next_frame_ns <= end_ns)
+        {
+            p_i->next_frame_ns = end_ns;
+            return;
+        }
+
+        clock::sleep_until(p_i->next_frame_ns, config.spin_ns);
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// loop_run: Runs frames until keep_running returns false.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::loop_run(frame_loop* p_loop, const std::function<bool()>& keep_running)
+{
+    while (keep_running())
+    {
+        loop_frame(p_loop);
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// loop_frame_times: Start-to-start frame intervals in nanoseconds, pacing included.
+// =========================================================================================================================================
+// =========================================================================================================================================
+const zp::stats::histogram* zp::loop_frame_times(const frame_loop* p_loop)
+{
+    return &p_loop->state.p_i->frame_times;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// loop_work_times: Time spent in the stages of each frame, pacing excluded.
+// =========================================================================================================================================
+// =========================================================================================================================================
+const zp::stats::histogram* zp::loop_work_times(const frame_loop* p_loop)
+{
+    return &p_loop->state.p_i->work_times;
+}
@@ -1,4 +1,5 @@
 #include "zp_cpp/gpu.hpp"
+#include "zp_cpp/prof.hpp"
 
 // ================================================================================================================
 // ================================================================================================================
@@ -12,6 +13,8 @@ void zp::gpu::passes::as_work::Instance::record_init(VkCommandBuffer cmd_buff) {
 // ================================================================================================================
 void zp::gpu::passes::as_work::Instance::record_cmd_buff(VkCommandBuffer cmd_buff)
 {
+    ZP_PROF_ZONE("gpu::as_work::record_cmd_buff");
+
     // ============================================================================================
     // ============================================================================================
     // rebuild requested blases
@@ -1,4 +1,5 @@
 #include "zp_cpp/gpu.hpp"
+#include "zp_cpp/prof.hpp"
 
 using namespace zp::gpu;
 using namespace zp::gpu::passes;
@@ -62,6 +63,8 @@ void compute::init(Instance* p_inst)
 // ========================================================================================================================================
 void compute::record_cmd_buff(Instance* p_inst, VkCommandBuffer cmd_buff, std::vector<DispatchReq>* p_dispatch_reqs)
 {
+    ZP_PROF_ZONE("gpu::compute::record_cmd_buff");
+
     // ========================================================================================
     // ========================================================================================
     // ========================================================================================
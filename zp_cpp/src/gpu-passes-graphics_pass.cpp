@@ -1,4 +1,5 @@
 #include "zp_cpp/gpu.hpp"
+#include "zp_cpp/prof.hpp"
 
 using namespace zp::gpu;
 using namespace zp::gpu::passes;
@@ -68,6 +69,8 @@ void graphics::init(Instance* p_inst)
 // ========================================================================================================================================
 void graphics::record_cmd_buff(Instance* p_inst, VkCommandBuffer cmd_buff, DeviceLocalImage* p_colour, DeviceLocalImage* p_depth, bool should_clear, std::vector<DrawReq>* p_draw_reqs)
 {
+    ZP_PROF_ZONE("gpu::graphics::record_cmd_buff");
+
     // ========================================================================================
     // ========================================================================================
     // ========================================================================================
@@ -1,4 +1,5 @@
 #include "zp_cpp/gpu.hpp"
+#include "zp_cpp/prof.hpp"
 
 using namespace zp::gpu;
 using namespace zp::gpu::passes;
@@ -489,6 +490,8 @@ void zp::gpu::passes::rt_pass::Instance::update_buffs()
 // ====================================================================================================================
 void zp::gpu::passes::rt_pass::Instance::record_cmd_buff(VkCommandBuffer cmd_buff, DeviceLocalImage* p_target)
 {
+    ZP_PROF_ZONE("gpu::rt_pass::record_cmd_buff");
+
     update_descriptors(p_target);
 
     if (!p_i->is_pipelines_init || !p_i->is_descriptors_init)
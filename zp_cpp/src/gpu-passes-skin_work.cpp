@@ -1,4 +1,5 @@
 #include "zp_cpp/gpu.hpp"
+#include "zp_cpp/prof.hpp"
 
 #include "zp_cpp/gpu/shader_hex.hpp"
 
@@ -129,6 +130,8 @@ void zp::gpu::passes::skin_work::Instance::update_buffs()
 // ====================================================================================================================
 void zp::gpu::passes::skin_work::Instance::record_cmd_buff(VkCommandBuffer cmd_buff)
 {
+    ZP_PROF_ZONE("gpu::skin_work::record_cmd_buff");
+
     // verts
     {
         vkCmdBindPipeline(cmd_buff, VK_PIPELINE_BIND_POINT_COMPUTE, state.pipeline_verts);
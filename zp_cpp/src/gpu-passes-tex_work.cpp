@@ -1,4 +1,5 @@
 #include "zp_cpp/gpu.hpp"
+#include "zp_cpp/prof.hpp"
 
 // ====================================================================================================================
 // ====================================================================================================================
@@ -53,6 +54,8 @@ void zp::gpu::passes::tex_work::Instance::update_buffs()
 // ====================================================================================================================
 void zp::gpu::passes::tex_work::Instance::record_cmd_buff(VkCommandBuffer cmd_buff)
 {
+    ZP_PROF_ZONE("gpu::tex_work::record_cmd_buff");
+
     for (auto&& staged_upload : state.staged_uploads)
     {
         util::record_trans_image_layout(setup.p_inst, cmd_buff, staged_upload.p_img->handle, staged_upload.p_img->format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
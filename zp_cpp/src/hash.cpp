@@ -1,3 +1,5 @@
+#define ZP_LOG_MODULE zp::log::MODULE_HASH
+
 #include "zp_cpp/hash.hpp"
 
 #include <openssl/evp.h>
@@ -45,7 +47,7 @@ hash256 hash::hash_data(const void* data, std::uint64_t size) noexcept
 
     if (ok != 1 || md_len != 32)
     {
-        ERR("failed hash");
+        ERR_RATE(10, "failed hash");
         std::memset(out.bytes, 0, sizeof(out.bytes));
     }
 
@@ -62,6 +64,22 @@ hash256 hash::hash_data(zp::span<const std::byte> data) noexcept
     return hash_data(static_cast<const void*>(data.p), static_cast<std::uint64_t>(data.count));
 }
 
+// =========================================================================================================================================
+// =========================================================================================================================================
+// hash_str: Computes a 64-bit FNV-1a hash of a string for cheap keys such as paths. Not collision resistant.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::uint64_t hash::hash_str(std::string_view str) noexcept
+{
+    std::uint64_t acc = 1469598103934665603ull;
+    for (const char c : str)
+    {
+        acc ^= static_cast<unsigned char>(c);
+        acc *= 1099511628211ull;
+    }
+    return acc;
+}
+
 // =========================================================================================================================================
 // =========================================================================================================================================
 // to_str: Converts hash256 to lowercase hexadecimal string representation (64 characters).
@@ -0,0 +1,571 @@
+#include "zp_cpp/jobs.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+    // recycled job nodes a thread keeps before it hands half to the shared spares. nodes are recycled by whichever thread ran
+    // them, so without the spares a thread that mostly steals would hoard the nodes another thread keeps allocating. init stocks
+    // NODE_CACHE_MAX nodes per worker: a thread only allocates when its cache and the spares are empty, which the other workers'
+    // caches can only cause once NODE_CACHE_MAX or more jobs are in flight.
+    constexpr std::size_t NODE_CACHE_MAX = 64;
+
+    // rounds an idle worker keeps looking for work before it sleeps.
+    constexpr int IDLE_SPINS             = 64;
+
+    struct JobNode
+    {
+        zp::jobs::Job job;
+        zp::jobs::counter* p_counter;
+    };
+
+    // Chase-Lev work-stealing deque with a fixed ring (Lê et al., "Correct and Efficient Work-Stealing for Weak Memory Models").
+    // the owner pushes and pops at bottom; thieves take from top, and the owner races them with a CAS only for the last job.
+    // sequentially consistent operations stand in for the paper's fences, which ThreadSanitizer cannot follow.
+    struct Deque
+    {
+        alignas(64) std::atomic<std::int64_t> top    = 0;
+        alignas(64) std::atomic<std::int64_t> bottom = 0;
+        alignas(64) std::atomic<JobNode*> slots[zp::jobs::DEQUE_CAPACITY];
+    };
+
+    struct Pool
+    {
+        std::vector<std::unique_ptr<Deque>> deques; // indexed by worker.
+        std::vector<std::thread> threads;           // workers 1 and up.
+        std::mutex inject_mutex;
+        std::vector<JobNode*> injected;             // from threads outside the pool; taken oldest first.
+        std::size_t injected_head                 = 0;
+        std::atomic<std::uint32_t> injected_count = 0;
+        std::atomic<std::uint32_t> wake_epoch     = 0;
+        std::atomic<std::uint32_t> sleepers       = 0;
+        std::atomic<bool> stopping                = false;
+        bool pin_workers                          = false;
+    };
+
+    // a fixed array, so a thread's first job allocates nothing for its cache.
+    struct NodeCache
+    {
+        JobNode* free[NODE_CACHE_MAX + 1];
+        std::size_t count = 0;
+
+        ~NodeCache()
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                delete free[i];
+            }
+        }
+    };
+
+    struct SpareNodes
+    {
+        std::mutex mutex;
+        std::vector<JobNode*> nodes;
+
+        ~SpareNodes()
+        {
+            for (JobNode* p_node : nodes)
+            {
+                delete p_node;
+            }
+        }
+    };
+
+    std::atomic<Pool*> g_pool          = nullptr;
+
+    thread_local std::int32_t t_worker = -1;
+    thread_local std::uint32_t t_rng   = 0x9e3779b9u;
+    thread_local NodeCache t_nodes;
+    SpareNodes g_spare_nodes;
+
+    // =============================================================================================================================
+    // =============================================================================================================================
+    // deque_push: Owner only. False when the ring is full.
+    // =============================================================================================================================
+    // =============================================================================================================================
+    bool deque_push(Deque* p_deque, JobNode* p_node)
+    {
+        const std::int64_t bottom = p_deque->bottom.load(std::memory_order_relaxed);
+        const std::int64_t top    = p_deque->top.load(std::memory_order_acquire);
+        if (bottom - top >= static_cast<std::int64_t>(zp::jobs::DEQUE_CAPACITY))
+        {
+            return false;
+        }
+        p_deque->slots[bottom & (zp::jobs::DEQUE_CAPACITY - 1)].store(p_node, std::memory_order_relaxed);
+        p_deque->bottom.store(bottom + 1);
+        return true;
+    }
+
+    // =============================================================================================================================
+    // =============================================================================================================================
+    // deque_pop: Owner only. Takes the newest job; for the last one it races the thieves for top.
+    // =============================================================================================================================
+    // =============================================================================================================================
+    JobNode* deque_pop(Deque* p_deque)
+    {
+        const std::int64_t bottom = p_deque->bottom.load(std::memory_order_relaxed) - 1;
+        p_deque->bottom.store(bottom);
+        std::int64_t top = p_deque->top.load();
+        if (top > bottom)
+        {
+            p_deque->bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        JobNode* p_node = p_deque->slots[bottom & (zp::jobs::DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (top == bottom)
+        {
+            if (!p_deque->top.compare_exchange_strong(top, top + 1))
+            {
+                p_node = nullptr;
+            }
+            p_deque->bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return p_node;
+    }
+
+    // =============================================================================================================================
+    // =============================================================================================================================
+    // deque_steal: Any thread. Takes the oldest job, or nullptr when empty or another thread won it.
+    // =============================================================================================================================
+    // =============================================================================================================================
+    JobNode* deque_steal(Deque* p_deque)
+    {
+        std::int64_t top          = p_deque->top.load();
+        const std::int64_t bottom = p_deque->bottom.load();
+        if (top >= bottom)
+        {
+            return nullptr;
+        }
+
+        JobNode* p_node = p_deque->slots[top & (zp::jobs::DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (!p_deque->top.compare_exchange_strong(top, top + 1))
+        {
+            return nullptr;
+        }
+        return p_node;
+    }
+
+    // =============================================================================================================================
+    // =============================================================================================================================
+    // deque_empty: Owner only; thieves may empty it further at any time.
+    // =============================================================================================================================
+    // =============================================================================================================================
+    bool deque_empty(const Deque* p_deque)
+    {
+        return p_deque->bottom.load(std::memory_order_relaxed) <= p_deque->top.load(std::memory_order_relaxed);
+    }
+
+    // =============================================================================================================================
+    // =============================================================================================================================
+    // acquire_node: A recycled node from the calling thread's cache, refilled from the shared spares when empty, or a new one.
+    // =============================================================================================================================
+    // =============================================================================================================================
+    JobNode* acquire_node(zp::jobs::Job job, zp::jobs::counter* p_counter)
+    {
+        if (t_nodes.count == 0)
+        {
+            std::lock_guard<std::mutex> lock(g_spare_nodes.mutex);
+            const std::size_t take = std::min(g_spare_nodes.nodes.size(), NODE_CACHE_MAX / 2);
+            std::copy(g_spare_nodes.nodes.end() - take, g_spare_nodes.nodes.end(), t_nodes.free);
+            g_spare_nodes.nodes.resize(g_spare_nodes.nodes.size() - take);
+            t_nodes.count = take;
+        }
+
+        JobNode* p_node = nullptr;
+        if (t_nodes.count == 0)
+        {
+            p_node = new JobNode();
+        }
+        else
+        {
+            p_node = t_nodes.free[--t_nodes.count];
+        }
+        p_node->job       = std::move(job);
+        p_node->p_counter = p_counter;
+        return p_node;
+    }
+
+    // =============================================================================================================================
+    // =============================================================================================================================
+    // execute: Runs the job, destroys its captures, recycles the node and only then counts it finished, so a waiter never
+    // returns while the job still holds anything.
+    // =============================================================================================================================
+    // =============================================================================================================================
+    void execute(JobNode* p_node)
+    {
+        p_node->job();
+        p_node->job                   = {};
+        zp::jobs::counter* p_counter  = p_node->p_counter;
+        t_nodes.free[t_nodes.count++] = p_node;
+        if (t_nodes.count > NODE_CACHE_MAX)
+        {
+            std::lock_guard<std::mutex> lock(g_spare_nodes.mutex);
+            g_spare_nodes.nodes.insert(g_spare_nodes.nodes.end(), t_nodes.free + t_nodes.count - NODE_CACHE_MAX / 2, t_nodes.free + t_nodes.count);
+            t_nodes.count -= NODE_CACHE_MAX / 2;
+        }
+
+        if (p_counter != nullptr)
+        {
+            p_counter->pending.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    // =============================================================================================================================
+    // =============================================================================================================================
+    // find_job: The calling thread's newest job, else the oldest injected one, else one stolen from a random victim onwards.
+    // =============================================================================================================================
+    // =============================================================================================================================
+    JobNode* find_job(Pool* p_pool)
+    {
+        if (t_worker >= 0)
+        {
+            if (JobNode* p_node = deque_pop(p_pool->deques[t_worker].get()))
+            {
+                return p_node;
+            }
+        }
+
+        if (p_pool->injected_count.load() != 0)
+        {
+            std::lock_guard<std::mutex> lock(p_pool->inject_mutex);
+            if (p_pool->injected_head < p_pool->injected.size())
+            {
+                JobNode* p_node = p_pool->injected[p_pool->injected_head++];
+                if (p_pool->injected_head == p_pool->injected.size())
+                {
+                    p_pool->injected.clear();
+                    p_pool->injected_head = 0;
+                }
+                p_pool->injected_count.fetch_sub(1);
+                return p_node;
+            }
+        }
+
+        t_rng                        ^= t_rng << 13;
+        t_rng                        ^= t_rng >> 17;
+        t_rng                        ^= t_rng << 5;
+        const std::uint32_t count     = static_cast<std::uint32_t>(p_pool->deques.size());
+        for (std::uint32_t i = 0, victim = t_rng % count; i < count; ++i, victim = (victim + 1) % count)
+        {
+            if (static_cast<std::int32_t>(victim) == t_worker)
+            {
+                continue;
+            }
+            if (JobNode* p_node = deque_steal(p_pool->deques[victim].get()))
+            {
+                return p_node;
+            }
+        }
+        return nullptr;
+    }
+
+    // =============================================================================================================================
+    // =============================================================================================================================
+    // wake_one: Wakes a sleeping worker, if any, after a job was queued. Workers register as sleepers before their last look
+    // for work, so either that look finds the job or this sees the sleeper and moves the epoch it waits on.
+    // =============================================================================================================================
+    // =============================================================================================================================
+    void wake_one(Pool* p_pool)
+    {
+        if (p_pool->sleepers.load() != 0)
+        {
+            p_pool->wake_epoch.fetch_add(1);
+            p_pool->wake_epoch.notify_one();
+        }
+    }
+
+    // =============================================================================================================================
+    // =============================================================================================================================
+    // submit: Pushes onto the calling worker's deque, or the injection queue from outside the pool. Runs inline without a
+    // pool or when the deque is full.
+    // =============================================================================================================================
+    // =============================================================================================================================
+    void submit(JobNode* p_node)
+    {
+        Pool* p_pool = g_pool.load(std::memory_order_acquire);
+        if (p_pool == nullptr || (t_worker >= 0 && !deque_push(p_pool->deques[t_worker].get(), p_node)))
+        {
+            execute(p_node);
+            return;
+        }
+        if (t_worker < 0)
+        {
+            std::lock_guard<std::mutex> lock(p_pool->inject_mutex);
+            p_pool->injected.push_back(p_node);
+            p_pool->injected_count.fetch_add(1);
+        }
+        wake_one(p_pool);
+    }
+
+    // =============================================================================================================================
+    // =============================================================================================================================
+    // pin_to_core: Restricts the calling thread to one core.
+    // =============================================================================================================================
+    // =============================================================================================================================
+    void pin_to_core(std::uint32_t worker)
+    {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(worker % std::max(1u, std::thread::hardware_concurrency()), &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        (void)worker;
+#endif
+    }
+
+    // =============================================================================================================================
+    // =============================================================================================================================
+    // worker_main: Runs jobs until shutdown finds every queue empty. An idle worker spins a little, then sleeps on wake_epoch.
+    // =============================================================================================================================
+    // =============================================================================================================================
+    void worker_main(Pool* p_pool, std::int32_t index)
+    {
+        t_worker = index;
+        if (p_pool->pin_workers)
+        {
+            pin_to_core(static_cast<std::uint32_t>(index));
+        }
+
+        int idle = 0;
+        for (;;)
+        {
+            if (JobNode* p_node = find_job(p_pool))
+            {
+                execute(p_node);
+                idle = 0;
+                continue;
+            }
+            if (++idle < IDLE_SPINS)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            const std::uint32_t epoch = p_pool->wake_epoch.load();
+            p_pool->sleepers.fetch_add(1);
+            JobNode* p_node           = find_job(p_pool);
+            if (p_node == nullptr && !p_pool->stopping.load())
+            {
+                p_pool->wake_epoch.wait(epoch);
+            }
+            p_pool->sleepers.fetch_sub(1);
+
+            if (p_node != nullptr)
+            {
+                execute(p_node);
+                idle = 0;
+            }
+            else if (p_pool->stopping.load())
+            {
+                break;
+            }
+        }
+        t_worker = -1;
+    }
+
+    struct Range
+    {
+        std::uint64_t grain;
+        void (*body)(const void* p_body, std::uint64_t first, std::uint64_t last);
+        const void* p_body;
+        zp::jobs::counter done;
+    };
+
+    // =============================================================================================================================
+    // =============================================================================================================================
+    // run_range: Lazy binary splitting. Works through [first, last) a grain at a time, and whenever the worker's deque has run
+    // dry, which is what a thief taking the last split looks like, pushes the upper half of what is left for the next thief.
+    // =============================================================================================================================
+    // =============================================================================================================================
+    void run_range(Range* p_range, std::uint64_t first, std::uint64_t last)
+    {
+        Pool* p_pool   = g_pool.load(std::memory_order_acquire);
+        Deque* p_deque = p_pool != nullptr && t_worker >= 0 ? p_pool->deques[t_worker].get() : nullptr;
+        while (first < last)
+        {
+            if (p_deque != nullptr && last - first > p_range->grain && deque_empty(p_deque))
+            {
+                const std::uint64_t mid = first + (last - first) / 2;
+                zp::jobs::run([p_range, mid, last]() { run_range(p_range, mid, last); }, &p_range->done);
+                last = mid;
+                continue;
+            }
+
+            const std::uint64_t chunk = std::min(last, first + p_range->grain);
+            p_range->body(p_range->p_body, first, chunk);
+            first = chunk;
+        }
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// init: Starts config.worker_count - 1 worker threads and makes the caller worker 0.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::jobs::init(const Config& config)
+{
+    const std::uint32_t count = config.worker_count != 0 ? config.worker_count : std::max(1u, std::thread::hardware_concurrency());
+
+    Pool* p_pool              = new Pool();
+    p_pool->pin_workers       = config.pin_workers;
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        p_pool->deques.push_back(std::make_unique<Deque>());
+    }
+
+    // stock the spares up front, with room for every node, so the pool neither allocates nodes nor grows the spares while warming.
+    {
+        std::lock_guard<std::mutex> lock(g_spare_nodes.mutex);
+        const std::size_t stock = NODE_CACHE_MAX * count;
+        g_spare_nodes.nodes.reserve(stock);
+        while (g_spare_nodes.nodes.size() + t_nodes.count < stock)
+        {
+            g_spare_nodes.nodes.push_back(new JobNode());
+        }
+    }
+
+    t_worker = 0;
+    if (config.pin_workers)
+    {
+        pin_to_core(0);
+    }
+    g_pool.store(p_pool, std::memory_order_release);
+    for (std::uint32_t i = 1; i < count; ++i)
+    {
+        p_pool->threads.emplace_back(worker_main, p_pool, static_cast<std::int32_t>(i));
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// shutdown: Drains what worker 0 can reach, then stops the workers, which each finish once every queue is empty.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::jobs::shutdown()
+{
+    Pool* p_pool = g_pool.load(std::memory_order_acquire);
+    if (p_pool == nullptr)
+    {
+        return;
+    }
+
+    while (JobNode* p_node = find_job(p_pool))
+    {
+        execute(p_node);
+    }
+    p_pool->stopping.store(true);
+    p_pool->wake_epoch.fetch_add(1);
+    p_pool->wake_epoch.notify_all();
+    for (std::thread& thread : p_pool->threads)
+    {
+        thread.join();
+    }
+
+    g_pool.store(nullptr, std::memory_order_release);
+    t_worker = -1;
+    delete p_pool;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// worker_count: Workers in the running pool including worker 0, or 1 when no pool is running.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::uint32_t zp::jobs::worker_count()
+{
+    const Pool* p_pool = g_pool.load(std::memory_order_acquire);
+    return p_pool != nullptr ? static_cast<std::uint32_t>(p_pool->deques.size()) : 1;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// worker_index: The calling thread's worker index, or -1 for threads outside the pool.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::int32_t zp::jobs::worker_index()
+{
+    return t_worker;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// run: Queues job, counting it against p_counter until it has finished.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::jobs::run(Job job, counter* p_counter)
+{
+    if (p_counter != nullptr)
+    {
+        p_counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    submit(acquire_node(std::move(job), p_counter));
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// wait: Runs queued jobs until p_counter reaches zero, yielding when there are none to run.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::jobs::wait(counter* p_counter)
+{
+    while (p_counter->pending.load(std::memory_order_acquire) != 0)
+    {
+        Pool* p_pool = g_pool.load(std::memory_order_acquire);
+        if (p_pool != nullptr)
+        {
+            if (JobNode* p_node = find_job(p_pool))
+            {
+                execute(p_node);
+                continue;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// parallel_for_erased: A worker starts splitting the range itself; a thread outside the pool hands the whole range to the
+// pool as one job and helps from the injection queue while it waits.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::jobs::parallel_for_erased(std::uint64_t begin, std::uint64_t end, std::uint64_t grain, void (*body)(const void* p_body, std::uint64_t first, std::uint64_t last), const void* p_body)
+{
+    if (end <= begin)
+    {
+        return;
+    }
+
+    const std::uint64_t workers = worker_count();
+    const std::uint64_t count   = end - begin;
+    grain                       = grain != 0 ? grain : std::max<std::uint64_t>(1, count / (workers * 8));
+    if (workers == 1 || count <= grain)
+    {
+        body(p_body, begin, end);
+        return;
+    }
+
+    Range range = {grain, body, p_body, {}};
+    if (t_worker >= 0)
+    {
+        run_range(&range, begin, end);
+    }
+    else
+    {
+        run([p_range = &range, begin, end]() { run_range(p_range, begin, end); }, &range.done);
+    }
+    wait(&range.done);
+}
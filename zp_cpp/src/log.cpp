@@ -1,10 +1,906 @@
 #include "zp_cpp/log.hpp"
+#include "zp_cpp/compress.hpp"
 #include <iostream>
 #include <filesystem>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <ctime>
-#include <iomanip>
-#include <sstream>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr std::size_t MAX_PRODUCERS     = 64;
+    constexpr std::size_t MAX_ASYNC_LOGGERS = 8;
+    constexpr int FATAL_SIGNALS[]           = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+
+    // single-producer single-consumer byte ring. the owning thread publishes whole lines by advancing head; the writer thread
+    // consumes them by advancing tail. both counters grow without wrapping and are masked on access.
+    struct Ring
+    {
+        alignas(64) std::atomic<std::uint64_t> head;
+        alignas(64) std::atomic<std::uint64_t> tail;
+        std::uint64_t mask;
+        std::unique_ptr<char[]> p_data;
+    };
+
+    struct ThreadRing
+    {
+        std::uint64_t logger_id;
+        std::shared_ptr<Ring> ring;
+    };
+
+    struct TimestampCache
+    {
+        std::time_t second = -1;
+        char text[32];
+    };
+
+    struct Site
+    {
+        std::uint32_t level;
+        std::string file;
+        std::uint32_t line;
+        std::string fmt;
+        std::vector<std::uint8_t> arg_types;
+    };
+
+    thread_local std::vector<ThreadRing> t_rings;
+    thread_local TimestampCache t_timestamp;
+    thread_local std::string t_line;
+    thread_local std::string t_record;
+    thread_local std::string t_format;
+    thread_local std::string t_message;
+
+    std::atomic<std::uint64_t> g_next_logger_id = 1;
+    std::once_flag g_signal_handlers_once;
+
+    // fatal-signal drains in flight. a drain counts itself before it reads the logger registry or a descriptor, so whoever takes
+    // a logger or a descriptor away waits for this to reach zero before freeing or closing it.
+    std::atomic<int> g_signal_drains = 0;
+
+    // binary call sites live for the whole process; a deque keeps existing entries in place while new ones register.
+    std::mutex g_sites_mutex;
+    std::deque<Site> g_sites;
+    std::atomic<std::uint32_t> g_site_count = 0;
+    struct sigaction g_previous_actions[std::size(FATAL_SIGNALS)];
+
+    // throttled sites that have dropped a call, and the summary thread that reports them. started by the first registration.
+    std::mutex g_throttles_mutex;
+    std::vector<zp::log::SiteThrottle*> g_throttles;
+    std::mutex g_summary_mutex;
+    std::condition_variable g_summary_cv;
+    bool g_summary_stopping = false;
+    std::thread g_summary_thread;
+}
+
+struct zp::log::Logger::Internal
+{
+    zp::log::Logger* logger;
+    std::uint64_t id;
+    std::atomic<int> fd;
+    std::size_t ring_bytes;
+    std::uint32_t flush_interval_ms;
+
+    // owners keeps rings alive until cleanup; slots mirrors it as plain atomics so the writer and the signal handler can walk it
+    // without locks. a ring whose thread has exited is handed to the next thread that registers rather than freed, so a slot
+    // only ever goes from null to a ring that outlives every reader.
+    std::mutex registry_mutex;
+    std::shared_ptr<Ring> owners[MAX_PRODUCERS];
+    std::atomic<Ring*> slots[MAX_PRODUCERS];
+
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+    std::atomic<bool> wake_requested;
+    std::atomic<bool> stopping;
+    std::thread writer;
+
+    // rotation: the rotator renames the active file and publishes a fresh one in next_fd; the thread that owns the file writes
+    // (the async writer, or the rotator itself in sync mode) swaps it in under log_mutex at a line boundary.
+    std::uint64_t rotate_bytes;
+    std::uint32_t rotate_interval_ms;
+    std::uint32_t archive_seq;
+    std::atomic<std::uint64_t> segment_bytes;
+    std::atomic<std::int64_t> segment_start_ns;
+    std::atomic<int> next_fd;
+    std::filesystem::path next_archive;
+    std::string binary_header;
+    std::mutex rotate_mutex;
+    std::condition_variable rotate_cv;
+    std::atomic<bool> rotate_requested;
+    std::thread rotator;
+
+    // closed segments waiting for the low-priority compressor.
+    std::mutex compress_mutex;
+    std::condition_variable compress_cv;
+    std::deque<std::filesystem::path> compress_queue;
+    std::thread compressor;
+};
+
+namespace
+{
+    std::atomic<zp::log::Logger::Internal*> g_async_loggers[MAX_ASYNC_LOGGERS];
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // local_time: Thread-safe local time of a unix second.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void local_time(std::time_t seconds, std::tm* p_out)
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        localtime_s(p_out, &seconds);
+#else
+        localtime_r(&seconds, p_out);
+#endif
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // write_all: Writes every byte, retrying on EINTR and short writes. Async-signal-safe.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void write_all(int fd, const char* p, std::size_t size)
+    {
+        while (size > 0)
+        {
+            const ssize_t n = ::write(fd, p, size);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return;
+            }
+            p    += n;
+            size -= static_cast<std::size_t>(n);
+        }
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // append_raw: Appends the bytes of a trivially copyable value.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    template <typename T> void append_raw(std::string* p_out, const T& value)
+    {
+        p_out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // append_site_definitions: Appends RECORD_SITE records for the registered sites in [first, last).
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void append_site_definitions(std::string* p_out, std::uint32_t first, std::uint32_t last)
+    {
+        std::lock_guard<std::mutex> sites_lock(g_sites_mutex);
+        for (std::uint32_t id = first; id < last && id < g_sites.size(); ++id)
+        {
+            const Site& site = g_sites[id];
+            p_out->push_back(static_cast<char>(zp::log::RECORD_SITE));
+            append_raw(p_out, id);
+            append_raw(p_out, static_cast<std::uint8_t>(site.level));
+            append_raw(p_out, site.line);
+            append_raw(p_out, static_cast<std::uint8_t>(site.arg_types.size()));
+            p_out->append(reinterpret_cast<const char*>(site.arg_types.data()), site.arg_types.size());
+            append_raw(p_out, static_cast<std::uint16_t>(site.file.size()));
+            p_out->append(site.file);
+            append_raw(p_out, static_cast<std::uint16_t>(site.fmt.size()));
+            p_out->append(site.fmt);
+        }
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // count_segment_bytes: Adds written bytes to the active segment. The write that crosses rotate_bytes wakes the rotator once;
+    // nobody waits for it.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void count_segment_bytes(zp::log::Logger::Internal* p_i, std::size_t size)
+    {
+        if (p_i == nullptr)
+        {
+            return;
+        }
+
+        const std::uint64_t total = p_i->segment_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        if (p_i->rotate_bytes > 0 && total >= p_i->rotate_bytes && !p_i->rotate_requested.exchange(true, std::memory_order_acq_rel))
+        {
+            p_i->rotate_cv.notify_one();
+        }
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // await_signal_drains: Waits out fatal-signal drains that may still hold a logger or descriptor the caller just unpublished.
+    // Both sides use sequentially consistent operations, so either the drain sees the caller's store or the caller sees the drain.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void await_signal_drains()
+    {
+        while (g_signal_drains.load() != 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // swap_segment: Switches writes to the segment the rotator prepared, if any. Binary loggers first give it a header and every site
+    // definition written so far, so each segment decodes on its own. The closed segment gives back its unused preallocation and
+    // is queued for compression.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void swap_segment(zp::log::Logger::Internal* p_i)
+    {
+        const int new_fd = p_i->next_fd.exchange(-1, std::memory_order_acq_rel);
+        if (new_fd < 0)
+        {
+            return;
+        }
+
+        zp::log::Logger* logger = p_i->logger;
+        std::lock_guard<std::mutex> lock(logger->log_mutex);
+
+        // =============================================================================================
+        // =============================================================================================
+        // Write the binary prologue, then publish the new descriptor.
+        // =============================================================================================
+        // =============================================================================================
+        int old_fd = -1;
+        {
+            if (logger->config.binary)
+            {
+                std::string prologue = p_i->binary_header;
+                append_site_definitions(&prologue, 0, logger->sites_written.load(std::memory_order_relaxed));
+                write_all(new_fd, prologue.data(), prologue.size());
+            }
+
+            old_fd = logger->fd.exchange(new_fd, std::memory_order_acq_rel);
+            p_i->fd.store(new_fd);
+            p_i->segment_bytes.store(0, std::memory_order_relaxed);
+            p_i->segment_start_ns.store(static_cast<std::int64_t>(zp::clock::steady_ns()), std::memory_order_relaxed);
+            p_i->rotate_requested.store(false, std::memory_order_release);
+        }
+
+        // =============================================================================================
+        // =============================================================================================
+        // Retire the old segment once no fatal-signal drain can still be writing to its descriptor.
+        // =============================================================================================
+        // =============================================================================================
+        {
+            await_signal_drains();
+#if defined(__linux__)
+            struct stat st = {};
+            if (p_i->rotate_bytes > 0 && fstat(old_fd, &st) == 0 && static_cast<std::uint64_t>(st.st_size) < p_i->rotate_bytes)
+            {
+                fallocate(old_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, st.st_size, static_cast<off_t>(p_i->rotate_bytes) - st.st_size);
+            }
+#endif
+            ::close(old_fd);
+
+            if (logger->config.compress_segments)
+            {
+                {
+                    std::lock_guard<std::mutex> compress_lock(p_i->compress_mutex);
+                    p_i->compress_queue.push_back(p_i->next_archive);
+                }
+                p_i->compress_cv.notify_one();
+            }
+        }
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // run_summaries: Summary thread entry. Wakes four times per summary window so a site that went quiet is reported soon after its
+    // window passes.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void run_summaries()
+    {
+        std::unique_lock<std::mutex> lock(g_summary_mutex);
+        while (!g_summary_stopping)
+        {
+            g_summary_cv.wait_for(lock, std::chrono::nanoseconds(zp::log::SUPPRESSION_SUMMARY_NS / 4), []() { return g_summary_stopping; });
+            lock.unlock();
+            zp::log::throttle_flush_summaries();
+            lock.lock();
+        }
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // stop_summaries: atexit hook. Stops and joins the summary thread before the registry is destroyed.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void stop_summaries()
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_summary_mutex);
+            g_summary_stopping = true;
+        }
+        g_summary_cv.notify_one();
+        g_summary_thread.join();
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // on_fatal_signal: Drains every async logger straight to its file, then restores the previous disposition and re-raises so the
+    // default action (core dump) or a chained handler still runs. Only atomics and write(2) are used. A line the writer thread is
+    // writing at the same moment may appear twice, but none are lost. Counted in g_signal_drains for the whole drain, so cleanup
+    // cannot free a logger or its rings, nor a rotation close its descriptor, under it.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void on_fatal_signal(int sig, siginfo_t*, void*)
+    {
+        // =================================================================================================
+        // =================================================================================================
+        // Write out the unconsumed bytes of every ring, in at most two pieces when the range wraps.
+        // =================================================================================================
+        // =================================================================================================
+        {
+            g_signal_drains.fetch_add(1);
+            for (std::atomic<zp::log::Logger::Internal*>& registered : g_async_loggers)
+            {
+                zp::log::Logger::Internal* p_i = registered.load();
+                if (p_i == nullptr)
+                {
+                    continue;
+                }
+
+                for (std::atomic<Ring*>& slot : p_i->slots)
+                {
+                    Ring* p_ring = slot.load(std::memory_order_acquire);
+                    if (p_ring == nullptr)
+                    {
+                        continue;
+                    }
+
+                    const std::uint64_t head  = p_ring->head.load(std::memory_order_acquire);
+                    const std::uint64_t tail  = p_ring->tail.load(std::memory_order_acquire);
+                    const std::size_t start   = tail & p_ring->mask;
+                    const std::size_t pending = head - tail;
+                    const std::size_t first   = std::min<std::size_t>(pending, p_ring->mask + 1 - start);
+                    write_all(p_i->fd, p_ring->p_data.get() + start, first);
+                    write_all(p_i->fd, p_ring->p_data.get(), pending - first);
+                    p_ring->tail.store(head, std::memory_order_release);
+                }
+            }
+            g_signal_drains.fetch_sub(1);
+        }
+
+        for (std::size_t i = 0; i < std::size(FATAL_SIGNALS); ++i)
+        {
+            if (FATAL_SIGNALS[i] == sig)
+            {
+                sigaction(sig, &g_previous_actions[i], nullptr);
+            }
+        }
+        raise(sig);
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // run_writer: Writer thread entry. Every flush interval (or when a producer finds its ring full) it gathers all rings into one
+    // batch and writes it with a single write call. Tails advance only after the write, so a crash mid-batch repeats lines rather
+    // than losing them.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void run_writer(zp::log::Logger::Internal* p_i)
+    {
+        std::vector<char> batch;
+        Ring* rings[MAX_PRODUCERS];
+        std::uint64_t heads[MAX_PRODUCERS];
+
+        while (true)
+        {
+            // read stopping before gathering: everything published before cleanup set it is covered by this final pass.
+            const bool stopping = p_i->stopping.load(std::memory_order_acquire);
+
+            // =============================================================================================
+            // =============================================================================================
+            // Gather the published bytes of every ring into the batch.
+            // =============================================================================================
+            // =============================================================================================
+            {
+                for (std::size_t i = 0; i < MAX_PRODUCERS; ++i)
+                {
+                    rings[i] = p_i->slots[i].load(std::memory_order_acquire);
+                    if (rings[i] == nullptr)
+                    {
+                        continue;
+                    }
+
+                    heads[i]                  = rings[i]->head.load(std::memory_order_acquire);
+                    const std::uint64_t tail  = rings[i]->tail.load(std::memory_order_relaxed);
+                    const std::size_t start   = tail & rings[i]->mask;
+                    const std::size_t pending = heads[i] - tail;
+                    const std::size_t first   = std::min<std::size_t>(pending, rings[i]->mask + 1 - start);
+                    batch.insert(batch.end(), rings[i]->p_data.get() + start, rings[i]->p_data.get() + start + first);
+                    batch.insert(batch.end(), rings[i]->p_data.get(), rings[i]->p_data.get() + (pending - first));
+                }
+            }
+
+            // =============================================================================================
+            // =============================================================================================
+            // Write the batch, then release the consumed ring space to the producers.
+            // =============================================================================================
+            // =============================================================================================
+            {
+                if (!batch.empty())
+                {
+                    write_all(p_i->fd, batch.data(), batch.size());
+                    count_segment_bytes(p_i, batch.size());
+                    batch.clear();
+                }
+
+                for (std::size_t i = 0; i < MAX_PRODUCERS; ++i)
+                {
+                    if (rings[i] != nullptr)
+                    {
+                        rings[i]->tail.store(heads[i], std::memory_order_release);
+                    }
+                }
+            }
+
+            // switch to a freshly rotated segment between batches, so a batch never straddles two files.
+            swap_segment(p_i);
+
+            if (stopping)
+            {
+                break;
+            }
+
+            std::unique_lock<std::mutex> lock(p_i->wake_mutex);
+            p_i->wake_cv.wait_for(lock, std::chrono::milliseconds(p_i->flush_interval_ms), [p_i]() { return p_i->wake_requested.exchange(false, std::memory_order_acq_rel) || p_i->stopping.load(std::memory_order_acquire); });
+        }
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // submit: Hands one complete line or binary record to the logger, through this thread's ring in async mode or a single locked
+    // write otherwise.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void submit(zp::log::Logger* logger, const char* p, std::size_t size)
+    {
+        // =============================================================================================
+        // =============================================================================================
+        // Async: find this thread's ring for this logger, registering one on first use. Registration takes over a drained ring whose
+        // thread has exited (the registry holds the last reference) before it allocates a new one. Rings of loggers that have since
+        // been cleaned up are dropped here.
+        // =============================================================================================
+        // =============================================================================================
+        Ring* p_ring = nullptr;
+        {
+            zp::log::Logger::Internal* p_i = logger->p_i;
+            if (p_i != nullptr && logger->config.async)
+            {
+                for (const ThreadRing& thread_ring : t_rings)
+                {
+                    if (thread_ring.logger_id == p_i->id)
+                    {
+                        p_ring = thread_ring.ring.get();
+                    }
+                }
+
+                if (p_ring == nullptr)
+                {
+                    std::erase_if(t_rings, [](const ThreadRing& thread_ring) { return thread_ring.ring.use_count() == 1; });
+
+                    std::lock_guard<std::mutex> lock(p_i->registry_mutex);
+                    for (std::size_t i = 0; i < MAX_PRODUCERS; ++i)
+                    {
+                        std::shared_ptr<Ring>& owner = p_i->owners[i];
+                        if (owner && (owner.use_count() != 1 || owner->head.load(std::memory_order_acquire) != owner->tail.load(std::memory_order_acquire)))
+                        {
+                            continue;
+                        }
+
+                        if (!owner)
+                        {
+                            std::uint64_t capacity = 1;
+                            while (capacity < p_i->ring_bytes)
+                            {
+                                capacity <<= 1;
+                            }
+
+                            owner         = std::make_shared<Ring>();
+                            owner->mask   = capacity - 1;
+                            owner->p_data = std::make_unique<char[]>(capacity);
+                            p_i->slots[i].store(owner.get(), std::memory_order_release);
+                        }
+                        t_rings.push_back({p_i->id, owner});
+                        p_ring = owner.get();
+                        break;
+                    }
+                }
+            }
+        }
+
+        // =============================================================================================
+        // =============================================================================================
+        // Sync mode, more producers than ring slots, or a line larger than a ring: a single write under the mutex keeps lines whole.
+        // =============================================================================================
+        // =============================================================================================
+        {
+            if (p_ring == nullptr || size > p_ring->mask + 1)
+            {
+                std::lock_guard<std::mutex> lock(logger->log_mutex);
+                write_all(logger->fd, p, size);
+                count_segment_bytes(logger->p_i, size);
+                return;
+            }
+        }
+
+        // =============================================================================================
+        // =============================================================================================
+        // Copy the whole line into the ring and publish it with one release store. A full ring wakes the writer and waits for space.
+        // =============================================================================================
+        // =============================================================================================
+        {
+            const std::uint64_t capacity = p_ring->mask + 1;
+            const std::uint64_t head     = p_ring->head.load(std::memory_order_relaxed);
+            while (head + size - p_ring->tail.load(std::memory_order_acquire) > capacity)
+            {
+                logger->p_i->wake_requested.store(true, std::memory_order_release);
+                logger->p_i->wake_cv.notify_one();
+                std::this_thread::yield();
+            }
+
+            const std::size_t start = head & p_ring->mask;
+            const std::size_t first = std::min<std::size_t>(size, capacity - start);
+            std::memcpy(p_ring->p_data.get() + start, p, first);
+            std::memcpy(p_ring->p_data.get(), p + first, size - first);
+            p_ring->head.store(head + size, std::memory_order_release);
+        }
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // run_rotator: Rotation thread entry. Wakes when a write crosses rotate_bytes, or periodically for rotate_interval_ms, and
+    // prepares the next segment off the hot path: renames the active file, opens a fresh one and preallocates it so appends do not
+    // allocate blocks. Writers keep appending to the renamed file until the swap.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void run_rotator(zp::log::Logger::Internal* p_i)
+    {
+        const std::filesystem::path& active = p_i->logger->file_path;
+        const std::uint32_t poll_ms         = p_i->rotate_interval_ms > 0 ? std::min<std::uint32_t>(p_i->rotate_interval_ms, 100) : 100;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(p_i->rotate_mutex);
+                p_i->rotate_cv.wait_for(lock, std::chrono::milliseconds(poll_ms), [p_i]() { return (p_i->rotate_requested.load(std::memory_order_acquire) && p_i->next_fd.load(std::memory_order_acquire) < 0) || p_i->stopping.load(std::memory_order_acquire); });
+            }
+            if (p_i->stopping.load(std::memory_order_acquire))
+            {
+                break;
+            }
+
+            // =============================================================================================
+            // =============================================================================================
+            // Decide. An empty segment is never rotated for age, and nothing happens while a prepared segment awaits its swap.
+            // =============================================================================================
+            // =============================================================================================
+            {
+                const std::uint64_t bytes = p_i->segment_bytes.load(std::memory_order_relaxed);
+                const std::int64_t age_ns = static_cast<std::int64_t>(zp::clock::steady_ns()) - p_i->segment_start_ns.load(std::memory_order_relaxed);
+                const bool by_size        = p_i->rotate_bytes > 0 && bytes >= p_i->rotate_bytes;
+                const bool by_age         = p_i->rotate_interval_ms > 0 && bytes > 0 && age_ns >= static_cast<std::int64_t>(p_i->rotate_interval_ms) * 1'000'000;
+                if ((!by_size && !by_age) || p_i->next_fd.load(std::memory_order_acquire) >= 0)
+                {
+                    continue;
+                }
+            }
+
+            // =============================================================================================
+            // =============================================================================================
+            // Rename the active file to its archive name and open a preallocated replacement.
+            // =============================================================================================
+            // =============================================================================================
+            int fd = -1;
+            {
+                const std::time_t now = std::time(nullptr);
+                std::tm tm_local;
+                local_time(now, &tm_local);
+                char stamp[32];
+                std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm_local);
+
+                std::filesystem::path archive = active;
+                archive.replace_filename(active.stem().string() + "." + stamp + "." + std::to_string(p_i->archive_seq++) + active.extension().string());
+
+                std::error_code ec;
+                std::filesystem::rename(active, archive, ec);
+                if (ec)
+                {
+                    continue;
+                }
+
+                fd = ::open(active.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+                if (fd < 0)
+                {
+                    std::filesystem::rename(archive, active, ec);
+                    continue;
+                }
+#if defined(__linux__)
+                if (p_i->rotate_bytes > 0)
+                {
+                    fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(p_i->rotate_bytes));
+                }
+#endif
+                p_i->next_archive = archive;
+            }
+
+            // =============================================================================================
+            // =============================================================================================
+            // Publish it. The async writer swaps at its next batch boundary; in sync mode this thread swaps under log_mutex.
+            // =============================================================================================
+            // =============================================================================================
+            {
+                p_i->next_fd.store(fd, std::memory_order_release);
+                if (p_i->logger->config.async)
+                {
+                    p_i->wake_requested.store(true, std::memory_order_release);
+                    p_i->wake_cv.notify_one();
+                }
+                else
+                {
+                    swap_segment(p_i);
+                }
+            }
+        }
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // run_compressor: Compression thread entry. Runs at the lowest CPU priority and streams each closed segment through the frame
+    // encoder into <segment>.zplz, removing the original only once the compressed copy is complete.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void run_compressor(zp::log::Logger::Internal* p_i)
+    {
+#if defined(__linux__)
+        setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#endif
+
+        std::vector<std::byte> chunk(256 * 1024);
+        std::vector<std::byte> frame;
+
+        while (true)
+        {
+            // =============================================================================================
+            // =============================================================================================
+            // Take the next segment. The queue is drained before the thread exits.
+            // =============================================================================================
+            // =============================================================================================
+            std::filesystem::path segment;
+            {
+                std::unique_lock<std::mutex> lock(p_i->compress_mutex);
+                p_i->compress_cv.wait(lock, [p_i]() { return !p_i->compress_queue.empty() || p_i->stopping.load(std::memory_order_acquire); });
+                if (p_i->compress_queue.empty())
+                {
+                    break;
+                }
+                segment = std::move(p_i->compress_queue.front());
+                p_i->compress_queue.pop_front();
+            }
+
+            // =============================================================================================
+            // =============================================================================================
+            // Stream it through the encoder.
+            // =============================================================================================
+            // =============================================================================================
+            {
+                std::filesystem::path compressed = segment;
+                compressed                      += ".zplz";
+
+                std::ifstream in(segment, std::ios::binary);
+                std::ofstream out(compressed, std::ios::binary | std::ios::trunc);
+                if (!in || !out)
+                {
+                    continue;
+                }
+
+                zp::compress::encoder encoder = {};
+                encoder.config.level          = zp::compress::Level::HIGH;
+                while (in)
+                {
+                    in.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+                    const std::size_t count = static_cast<std::size_t>(in.gcount());
+                    if (count == 0)
+                    {
+                        break;
+                    }
+                    zp::compress::encoder_write(&encoder, zp::span<const std::byte>{chunk.data(), count}, &frame);
+                    out.write(reinterpret_cast<const char*>(frame.data()), static_cast<std::streamsize>(frame.size()));
+                    frame.clear();
+                }
+                zp::compress::encoder_finish(&encoder, &frame);
+                out.write(reinterpret_cast<const char*>(frame.data()), static_cast<std::streamsize>(frame.size()));
+                frame.clear();
+                out.close();
+
+                std::error_code ec;
+                std::filesystem::remove(out ? segment : compressed, ec);
+            }
+        }
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // level_tag: Fixed-width level column shared by text lines and decoded binary records.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    const char* level_tag(std::uint32_t level)
+    {
+        switch (level)
+        {
+            case zp::log::Logger::INFO:  return "[INFO ] ";
+            case zp::log::Logger::WARN:  return "[WARN ] ";
+            case zp::log::Logger::ERROR: return "[ERROR] ";
+        }
+        return "[?????] ";
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // read_raw: Reads a trivially copyable value, failing when fewer than sizeof(T) bytes remain.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    template <typename T> bool read_raw(const char** pp, const char* p_end, T* p_value)
+    {
+        if (static_cast<std::size_t>(p_end - *pp) < sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(p_value, *pp, sizeof(T));
+        *pp += sizeof(T);
+        return true;
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // format_message: Substitutes a record's decoded arguments into the site's {} placeholders. {{ and }} are literal braces; any
+    // text between { and } is ignored, so std::format-style specs degrade to plain formatting.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    bool format_message(const Site& site, const char* p, const char* p_end, std::string* p_out)
+    {
+        std::size_t arg_idx = 0;
+        for (std::size_t i = 0; i < site.fmt.size(); ++i)
+        {
+            const char c = site.fmt[i];
+            if ((c == '{' || c == '}') && i + 1 < site.fmt.size() && site.fmt[i + 1] == c)
+            {
+                p_out->push_back(c);
+                ++i;
+                continue;
+            }
+
+            const std::size_t close = c == '{' ? site.fmt.find('}', i) : std::string::npos;
+            if (close == std::string::npos || arg_idx >= site.arg_types.size())
+            {
+                p_out->push_back(c);
+                continue;
+            }
+            i = close;
+
+            std::uint64_t bits = 0;
+            char text[32];
+            switch (site.arg_types[arg_idx++])
+            {
+                case zp::log::ARG_STRING:
+                {
+                    std::uint32_t size;
+                    if (!read_raw(&p, p_end, &size) || static_cast<std::size_t>(p_end - p) < size)
+                    {
+                        return false;
+                    }
+                    p_out->append(p, size);
+                    p += size;
+                    continue;
+                }
+                case zp::log::ARG_INT:
+                {
+                    std::int64_t value;
+                    if (!read_raw(&p, p_end, &value))
+                    {
+                        return false;
+                    }
+                    std::snprintf(text, sizeof(text), "%lld", static_cast<long long>(value));
+                    break;
+                }
+                case zp::log::ARG_DOUBLE:
+                {
+                    double value;
+                    if (!read_raw(&p, p_end, &value))
+                    {
+                        return false;
+                    }
+                    std::snprintf(text, sizeof(text), "%g", value);
+                    break;
+                }
+                default:
+                {
+                    if (!read_raw(&p, p_end, &bits))
+                    {
+                        return false;
+                    }
+                    const std::uint8_t type = site.arg_types[arg_idx - 1];
+                    if (type == zp::log::ARG_BOOL)
+                    {
+                        std::snprintf(text, sizeof(text), "%s", bits != 0 ? "true" : "false");
+                    }
+                    else if (type == zp::log::ARG_CHAR)
+                    {
+                        std::snprintf(text, sizeof(text), "%c", static_cast<char>(bits));
+                    }
+                    else if (type == zp::log::ARG_POINTER)
+                    {
+                        std::snprintf(text, sizeof(text), "0x%llx", static_cast<unsigned long long>(bits));
+                    }
+                    else
+                    {
+                        std::snprintf(text, sizeof(text), "%llu", static_cast<unsigned long long>(bits));
+                    }
+                    break;
+                }
+            }
+            p_out->append(text);
+        }
+        return true;
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // append_json_string: Appends text as a quoted, escaped JSON string.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void append_json_string(std::string* p_out, std::string_view text)
+    {
+        p_out->push_back('"');
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                p_out->push_back('\\');
+                p_out->push_back(c);
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                p_out->append(escaped);
+            }
+            else
+            {
+                p_out->push_back(c);
+            }
+        }
+        p_out->push_back('"');
+    }
+}
 
 // =========================================================================================================================================
 // =========================================================================================================================================
@@ -37,7 +933,8 @@ void zp::log::init(Logger* logger, const std::filesystem::path& file_path)
 
     // =================================================================================================
     // =================================================================================================
-    // Ensure log directory exists and open file stream.
+    // Ensure log directory exists and open the file for appending. Lines go out with plain write calls, so there is no stream
+    // buffer to flush or lose.
     // =================================================================================================
     // =================================================================================================
     {
@@ -48,32 +945,227 @@ void zp::log::init(Logger* logger, const std::filesystem::path& file_path)
             std::filesystem::create_directories(log_dir);
         }
 
-        logger->file_stream.open(logger->file_path, std::ios::app);
-        if (!logger->file_stream.is_open())
+        logger->fd = ::open(logger->file_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (logger->fd < 0)
         {
             std::cerr << "Failed to open log file: " << logger->file_path << std::endl;
         }
     }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Binary mode: anchor the calibrated TSC to wall-clock time and open a new file section with a header record. Each section re-defines
+    // the sites it uses, so appending to an existing file is fine.
+    // =================================================================================================
+    // =================================================================================================
+    std::string header;
+    {
+        logger->sites_written.store(0, std::memory_order_relaxed);
+        if (logger->config.binary && logger->fd >= 0)
+        {
+            const std::uint64_t tsc    = zp::clock::ticks();
+            const std::int64_t unix_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            const double tsc_hz        = 1e9 / zp::clock::calibration().ns_per_tick;
+
+            header.push_back(static_cast<char>(RECORD_HEADER));
+            append_raw(&header, BINARY_MAGIC);
+            append_raw(&header, BINARY_VERSION);
+            append_raw(&header, tsc_hz);
+            append_raw(&header, tsc);
+            append_raw(&header, unix_ns);
+            write_all(logger->fd, header.data(), header.size());
+        }
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Async or rotating loggers keep their background state in Internal.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        const bool rotating = logger->config.rotate_bytes > 0 || logger->config.rotate_interval_ms > 0;
+        if ((logger->config.async || rotating) && logger->fd >= 0)
+        {
+            Logger::Internal* p_i   = new Logger::Internal();
+            p_i->logger             = logger;
+            p_i->id                 = g_next_logger_id.fetch_add(1, std::memory_order_relaxed);
+            p_i->fd                 = logger->fd.load();
+            p_i->ring_bytes         = std::max<std::size_t>(logger->config.ring_bytes, 4096);
+            p_i->flush_interval_ms  = logger->config.flush_interval_ms;
+            p_i->rotate_bytes       = logger->config.rotate_bytes;
+            p_i->rotate_interval_ms = logger->config.rotate_interval_ms;
+            p_i->archive_seq        = 0;
+            p_i->next_fd            = -1;
+            p_i->binary_header      = header;
+            logger->p_i             = p_i;
+        }
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Rotation: the existing file counts towards the first segment, which is preallocated like the ones after it. The compressor
+    // only exists when segments are compressed.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        Logger::Internal* p_i = logger->p_i;
+        if (p_i != nullptr && (p_i->rotate_bytes > 0 || p_i->rotate_interval_ms > 0))
+        {
+            struct stat st = {};
+            p_i->segment_bytes.store(fstat(logger->fd, &st) == 0 ? static_cast<std::uint64_t>(st.st_size) : 0, std::memory_order_relaxed);
+            p_i->segment_start_ns.store(static_cast<std::int64_t>(zp::clock::steady_ns()), std::memory_order_relaxed);
+#if defined(__linux__)
+            if (p_i->rotate_bytes > static_cast<std::uint64_t>(st.st_size))
+            {
+                fallocate(logger->fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(p_i->rotate_bytes));
+            }
+#endif
+            p_i->rotator = std::thread(run_rotator, p_i);
+            if (logger->config.compress_segments)
+            {
+                p_i->compressor = std::thread(run_compressor, p_i);
+            }
+        }
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Async mode: start the writer thread and register for the fatal-signal drain.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        Logger::Internal* p_i = logger->p_i;
+        if (p_i != nullptr && logger->config.async)
+        {
+            p_i->writer = std::thread(run_writer, p_i);
+
+            for (std::atomic<Logger::Internal*>& registered : g_async_loggers)
+            {
+                Logger::Internal* p_expected = nullptr;
+                if (registered.compare_exchange_strong(p_expected, p_i, std::memory_order_acq_rel))
+                {
+                    break;
+                }
+            }
+
+            std::call_once(g_signal_handlers_once, []() {
+                for (std::size_t i = 0; i < std::size(FATAL_SIGNALS); ++i)
+                {
+                    struct sigaction action = {};
+                    action.sa_sigaction     = on_fatal_signal;
+                    action.sa_flags         = SA_SIGINFO;
+                    sigemptyset(&action.sa_mask);
+                    sigaction(FATAL_SIGNALS[i], &action, &g_previous_actions[i]);
+                }
+            });
+        }
+    }
 }
 
 // =========================================================================================================================================
 // =========================================================================================================================================
-// cleanup: Properly cleans up a logger instance.
+// cleanup: Properly cleans up a logger instance. Async loggers drain every ring before the file is closed.
 // =========================================================================================================================================
 // =========================================================================================================================================
 void zp::log::cleanup(Logger* logger)
 {
+    if (!logger->initialised)
+    {
+        return;
+    }
+
     // =================================================================================================
     // =================================================================================================
-    // Close file stream and reset logger state.
+    // Report what this logger's throttled sites dropped since their last summary, whether or not it is due, and unregister them
+    // while the logger still takes lines. A site registers again on its next dropped call.
     // =================================================================================================
     // =================================================================================================
     {
-        if (logger->initialised)
+        std::lock_guard<std::mutex> lock(g_throttles_mutex);
+        for (std::size_t i = 0; i < g_throttles.size();)
+        {
+            SiteThrottle* p_throttle = g_throttles[i];
+            if (p_throttle->logger != logger)
+            {
+                ++i;
+                continue;
+            }
+
+            const std::uint64_t suppressed = p_throttle->suppressed.exchange(0, std::memory_order_relaxed);
+            if (suppressed > 0)
+            {
+                p_throttle->report(p_throttle, suppressed);
+            }
+            p_throttle->registered.store(false, std::memory_order_relaxed);
+            g_throttles[i] = g_throttles.back();
+            g_throttles.pop_back();
+        }
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Stop the background threads (the writer after its final drain, the compressor once its queue is empty) and leave the signal
+    // registry before the state is freed. A fatal-signal drain that found this logger before it left is waited out.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        Logger::Internal* p_i = logger->p_i;
+        if (p_i != nullptr)
+        {
+            for (std::atomic<Logger::Internal*>& registered : g_async_loggers)
+            {
+                Logger::Internal* p_expected = p_i;
+                registered.compare_exchange_strong(p_expected, nullptr);
+            }
+            await_signal_drains();
+
+            {
+                std::lock_guard<std::mutex> lock(p_i->wake_mutex);
+                p_i->stopping.store(true, std::memory_order_release);
+            }
+
+            // the rotator goes first so no segment is prepared after the writer's final pass; one it left unswapped is swapped here.
+            if (p_i->rotator.joinable())
+            {
+                // an empty critical section orders the stopping store before the waiter's next predicate check.
+                {
+                    std::lock_guard<std::mutex> lock(p_i->rotate_mutex);
+                }
+                p_i->rotate_cv.notify_one();
+                p_i->rotator.join();
+            }
+            if (p_i->writer.joinable())
+            {
+                p_i->wake_cv.notify_one();
+                p_i->writer.join();
+            }
+            swap_segment(p_i);
+            if (p_i->compressor.joinable())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(p_i->compress_mutex);
+                }
+                p_i->compress_cv.notify_one();
+                p_i->compressor.join();
+            }
+
+            delete p_i;
+            logger->p_i = nullptr;
+        }
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Close the file and reset logger state.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        if (logger->fd >= 0)
         {
-            logger->file_stream.close();
-            logger->initialised = false;
+            ::close(logger->fd);
+            logger->fd = -1;
         }
+        logger->initialised = false;
     }
 }
 
@@ -84,40 +1176,399 @@ void zp::log::cleanup(Logger* logger)
 // =========================================================================================================================================
 void zp::log::log(Logger* logger, Logger::Level level, const std::string& message)
 {
-    std::lock_guard<std::mutex> lock(logger->log_mutex);
+    if (logger->fd < 0)
+    {
+        return;
+    }
 
     // =================================================================================================
     // =================================================================================================
-    // Format and write message to file.
+    // Binary mode: plain messages become records of a built-in "{}" site per level.
     // =================================================================================================
     // =================================================================================================
     {
-        if (logger->file_stream.is_open())
+        if (logger->config.binary)
+        {
+            static const std::uint8_t string_arg[]  = {ARG_STRING};
+            static const std::uint32_t text_sites[] = {
+                register_site(Logger::INFO, "", 0, "{}", string_arg, 1),
+                register_site(Logger::WARN, "", 0, "{}", string_arg, 1),
+                register_site(Logger::ERROR, "", 0, "{}", string_arg, 1),
+            };
+            log_binary(logger, text_sites[level], message);
+            return;
+        }
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Format the line into a reused thread-local buffer. local_time only runs when the second changes.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        const std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        if (now != t_timestamp.second)
         {
-            auto now               = std::chrono::system_clock::now();
-            std::time_t time_t_now = std::chrono::system_clock::to_time_t(now);
             std::tm tm_now;
+            local_time(now, &tm_now);
+            std::strftime(t_timestamp.text, sizeof(t_timestamp.text), "[%Y-%m-%d %H:%M:%S] ", &tm_now);
+            t_timestamp.second = now;
+        }
 
-#if defined(_WIN32) || defined(_WIN64)
-            localtime_s(&tm_now, &time_t_now);
-#else
-            localtime_r(&time_t_now, &tm_now);
-#endif
+        t_line.assign(t_timestamp.text);
+        t_line += level_tag(level);
+        t_line += message;
+        t_line += '\n';
+    }
+
+    submit(logger, t_line.data(), t_line.size());
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// register_site: Registers a binary call site once (from a function-local static) and returns its id.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::uint32_t zp::log::register_site(Logger::Level level, const char* file, int line, const char* fmt, const std::uint8_t* arg_types, std::uint8_t arg_count)
+{
+    const std::string_view path = file;
+    const std::size_t slash     = path.find_last_of("\\/");
+    const std::string_view base = slash == std::string_view::npos ? path : path.substr(slash + 1);
+
+    std::lock_guard<std::mutex> lock(g_sites_mutex);
+    g_sites.push_back({static_cast<std::uint32_t>(level), std::string(base), static_cast<std::uint32_t>(line), fmt, std::vector<std::uint8_t>(arg_types, arg_types + arg_count)});
+    g_site_count.store(static_cast<std::uint32_t>(g_sites.size()), std::memory_order_release);
+    return static_cast<std::uint32_t>(g_sites.size() - 1);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// record_buffer: Reused per-thread buffer that log_binary encodes into.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::string* zp::log::record_buffer()
+{
+    return &t_record;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// format_buffer: Reused per-thread buffer that log_format formats into.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::string* zp::log::format_buffer()
+{
+    return &t_format;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// throttle_register: Adds a site to the summary thread's list on its first dropped call, starting the thread if needed.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::log::throttle_register(SiteThrottle* p_throttle, SiteThrottle::ReportFn report, Logger* logger, Logger::Level level, const char* colour, const char* file, int line)
+{
+    std::lock_guard<std::mutex> lock(g_throttles_mutex);
+    if (p_throttle->registered.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    p_throttle->report = report;
+    p_throttle->logger = logger;
+    p_throttle->level  = level;
+    p_throttle->colour = colour;
+    p_throttle->file   = file;
+    p_throttle->line   = line;
+    g_throttles.push_back(p_throttle);
+    p_throttle->registered.store(true, std::memory_order_relaxed);
+
+    if (!g_summary_thread.joinable())
+    {
+        g_summary_thread = std::thread(run_summaries);
+        std::atexit(stop_summaries);
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// throttle_flush_summaries: Reports the dropped count of every registered site whose summary window has passed.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::log::throttle_flush_summaries()
+{
+    std::lock_guard<std::mutex> lock(g_throttles_mutex);
+    for (SiteThrottle* p_throttle : g_throttles)
+    {
+        const std::uint64_t suppressed = throttle_take_summary(p_throttle);
+        if (suppressed > 0)
+        {
+            p_throttle->report(p_throttle, suppressed);
+        }
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// report_suppressed: Writes a ZP_LOG_THROTTLED site's summary line to its logger.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::log::report_suppressed(const SiteThrottle* p_throttle, std::uint64_t suppressed)
+{
+    log_format(p_throttle->logger, p_throttle->level, p_throttle->file, p_throttle->line, "{} messages suppressed", suppressed);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// set_module_level: Disables every level below min_level for module. Sites read the mask relaxed, so a change reaches other
+// threads shortly after rather than immediately.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::log::set_module_level(std::uint32_t module, Logger::Level min_level)
+{
+    if (module >= MAX_MODULES)
+    {
+        return;
+    }
+
+    disabled_levels[module].store((1u << min_level) - 1, std::memory_order_relaxed);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// write_record: Submits an encoded RECORD_LOG. Text loggers format it immediately instead.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::log::write_record(Logger* logger, std::uint32_t site_id, const std::string& record)
+{
+    if (logger->fd < 0)
+    {
+        return;
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Text logger: format now, with the same "[file:line] " prefix the ZP_LOG_* macros add.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        if (!logger->config.binary)
+        {
+            std::uint32_t level;
+            {
+                std::lock_guard<std::mutex> lock(g_sites_mutex);
+                const Site& site = g_sites[site_id];
+                level            = site.level;
+                t_message.assign("[");
+                t_message       += site.file;
+                t_message       += ":";
+                t_message       += std::to_string(site.line);
+                t_message       += "] ";
+                format_message(site, record.data() + 17, record.data() + record.size(), &t_message);
+            }
+            log(logger, static_cast<Logger::Level>(level), t_message);
+            return;
+        }
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Binary logger: the definitions of every site up to this one go straight to the file before the record can, so a decoder
+    // always sees a site before its records. Only the first use of a new site takes this path.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        if (site_id >= logger->sites_written.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> lock(logger->log_mutex);
+            const std::uint32_t first = logger->sites_written.load(std::memory_order_relaxed);
+            const std::uint32_t last  = g_site_count.load(std::memory_order_acquire);
+
+            std::string definitions;
+            append_site_definitions(&definitions, first, last);
+            write_all(logger->fd, definitions.data(), definitions.size());
+            count_segment_bytes(logger->p_i, definitions.size());
+            logger->sites_written.store(std::max(first, last), std::memory_order_release);
+        }
+    }
 
-            std::ostringstream oss;
-            oss << "[" << std::put_time(&tm_now, "%Y-%m-%d %H:%M:%S") << "] ";
+    submit(logger, record.data(), record.size());
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// decode_binary: Turns a binary log file into one text line or one JSON object per record.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::Result zp::log::decode_binary(const std::filesystem::path& path, std::ostream& out, bool json)
+{
+    // =================================================================================================
+    // =================================================================================================
+    // Read the whole file. Decoding is offline, so simplicity wins over streaming.
+    // =================================================================================================
+    // =================================================================================================
+    std::string data;
+    {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs)
+        {
+            return Result::ZC_FILE_NOT_FOUND;
+        }
+        data.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
 
-            switch (level)
+        std::uint32_t magic = 0;
+        std::memcpy(&magic, data.data(), std::min(data.size(), sizeof(magic)));
+        if (magic == compress::FRAME_MAGIC)
+        {
+            std::vector<std::byte> decompressed;
+            if (compress::decompress_frame(span<const std::byte>{reinterpret_cast<const std::byte*>(data.data()), data.size()}, &decompressed) != Result::ZC_SUCCESS)
+            {
+                return Result::ZC_INVALID_FORMAT;
+            }
+            data.assign(reinterpret_cast<const char*>(decompressed.data()), decompressed.size());
+        }
+
+        if (data.empty() || static_cast<std::uint8_t>(data[0]) != RECORD_HEADER)
+        {
+            return Result::ZC_INVALID_FORMAT;
+        }
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Walk the records. Each header starts a section with its own clock calibration and site table.
+    // =================================================================================================
+    // =================================================================================================
+    Result result = Result::ZC_SUCCESS;
+    {
+        std::vector<Site> sites;
+        std::vector<bool> defined;
+        double tsc_hz            = 1e9;
+        std::uint64_t anchor_tsc = 0;
+        std::int64_t anchor_ns   = 0;
+        std::string line;
+
+        const char* p           = data.data();
+        const char* const p_end = data.data() + data.size();
+        while (p < p_end)
+        {
+            const std::uint8_t tag = static_cast<std::uint8_t>(*p++);
+
+            if (tag == RECORD_HEADER)
             {
-                case Logger::INFO:  oss << "[INFO ] "; break;
-                case Logger::WARN:  oss << "[WARN ] "; break;
-                case Logger::ERROR: oss << "[ERROR] "; break;
+                std::uint32_t magic;
+                std::uint32_t version;
+                if (!read_raw(&p, p_end, &magic) || !read_raw(&p, p_end, &version) || !read_raw(&p, p_end, &tsc_hz) || !read_raw(&p, p_end, &anchor_tsc) || !read_raw(&p, p_end, &anchor_ns) || magic != BINARY_MAGIC || version != BINARY_VERSION || !(tsc_hz > 0))
+                {
+                    result = Result::ZC_INVALID_FORMAT;
+                    break;
+                }
+                sites.clear();
+                defined.clear();
             }
+            else if (tag == RECORD_SITE)
+            {
+                Site site = {};
+                std::uint32_t id;
+                std::uint8_t level;
+                std::uint8_t arg_count;
+                std::uint16_t file_size;
+                std::uint16_t fmt_size;
+                bool valid = read_raw(&p, p_end, &id) && read_raw(&p, p_end, &level) && read_raw(&p, p_end, &site.line) && read_raw(&p, p_end, &arg_count);
+                valid      = valid && p_end - p >= arg_count;
+                if (valid)
+                {
+                    site.arg_types.assign(p, p + arg_count);
+                    p += arg_count;
+                }
+                valid = valid && read_raw(&p, p_end, &file_size) && p_end - p >= file_size;
+                if (valid)
+                {
+                    site.file.assign(p, file_size);
+                    p += file_size;
+                }
+                valid = valid && read_raw(&p, p_end, &fmt_size) && p_end - p >= fmt_size;
+                if (!valid)
+                {
+                    result = Result::ZC_INVALID_FORMAT;
+                    break;
+                }
+                site.fmt.assign(p, fmt_size);
+                p          += fmt_size;
+                site.level  = level;
+
+                if (id >= sites.size())
+                {
+                    sites.resize(id + 1);
+                    defined.resize(id + 1, false);
+                }
+                sites[id]   = std::move(site);
+                defined[id] = true;
+            }
+            else if (tag == RECORD_LOG)
+            {
+                std::uint32_t id;
+                std::uint64_t tsc;
+                std::uint32_t payload_size;
+                if (!read_raw(&p, p_end, &id) || !read_raw(&p, p_end, &tsc) || !read_raw(&p, p_end, &payload_size) || static_cast<std::size_t>(p_end - p) < payload_size || id >= sites.size() || !defined[id])
+                {
+                    result = Result::ZC_INVALID_FORMAT;
+                    break;
+                }
 
-            oss << message;
+                const Site& site = sites[id];
+                std::string message;
+                if (!format_message(site, p, p + payload_size, &message))
+                {
+                    result = Result::ZC_INVALID_FORMAT;
+                    break;
+                }
+                p += payload_size;
 
-            logger->file_stream << oss.str() << std::endl;
-            logger->file_stream.flush();
+                const double elapsed_ns  = static_cast<double>(static_cast<std::int64_t>(tsc - anchor_tsc)) * 1e9 / tsc_hz;
+                const std::int64_t ts_ns  = anchor_ns + static_cast<std::int64_t>(elapsed_ns);
+
+                line.clear();
+                if (json)
+                {
+                    static const char* level_names[] = {"INFO", "WARN", "ERROR"};
+                    line  = "{\"ts_ns\":" + std::to_string(ts_ns);
+                    line += ",\"level\":\"";
+                    line += site.level < 3 ? level_names[site.level] : "UNKNOWN";
+                    line += "\",\"file\":";
+                    append_json_string(&line, site.file);
+                    line += ",\"line\":" + std::to_string(site.line);
+                    line += ",\"msg\":";
+                    append_json_string(&line, message);
+                    line += "}";
+                }
+                else
+                {
+                    const std::time_t seconds = static_cast<std::time_t>(ts_ns / 1000000000);
+                    std::tm tm_ts;
+                    local_time(seconds, &tm_ts);
+
+                    char timestamp[48];
+                    const std::size_t n = std::strftime(timestamp, sizeof(timestamp), "[%Y-%m-%d %H:%M:%S", &tm_ts);
+                    std::snprintf(timestamp + n, sizeof(timestamp) - n, ".%06lld] ", static_cast<long long>((ts_ns % 1000000000) / 1000));
+
+                    line  = timestamp;
+                    line += level_tag(site.level);
+                    if (!site.file.empty())
+                    {
+                        line += "[" + site.file + ":" + std::to_string(site.line) + "] ";
+                    }
+                    line += message;
+                }
+                out << line << '\n';
+            }
+            else
+            {
+                result = Result::ZC_INVALID_FORMAT;
+                break;
+            }
         }
     }
+
+    return result;
 }
\ No newline at end of file
@@ -1,22 +1,34 @@
+#define ZP_LOG_MODULE zp::log::MODULE_NET
+
 #include "zp_cpp/net.hpp"
 
 #include <cstring>
 #include <enet/enet.h>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
 #include "zp_cpp/dbg.hpp"
+#include "zp_cpp/prof.hpp"
+#include "zp_cpp/time.hpp"
+#include "zp_cpp/timer_wheel.hpp"
 
 struct zp::net::server::State::Internal
 {
     ENetHost* host;
     std::unordered_set<ENetPeer*> connected_clients;
+    zp::timer_wheel timers; // advanced by handle_incoming.
+    std::unordered_map<ENetPeer*, zp::TimerId> disconnect_timers;
 };
 
 struct zp::net::client::State::Internal
 {
     ENetHost* host;
     ENetPeer* server;
+    ENetPeer* connecting;                                // connect_async's peer until handle_incoming sees the handshake end.
+    bool disconnecting;                                  // disconnect_async is waiting for handle_incoming to see the ack.
+    zp::async_queue<zp::net::client::NetEvent> received; // recv waiters. handle_incoming only pushes while one is waiting.
+    zp::async_queue<bool> handshake;                     // the waiting connect_async or disconnect_async, woken by handle_incoming.
 };
 
 namespace
@@ -36,7 +48,7 @@ namespace
         {
             char ip[zp::net::IPV4_ADDRSTRLEN];
             enet_address_get_host_ip(&peer->address, ip, sizeof(ip));
-            LOG("peer: " << peer << " connected from " << ip << ":" << peer->address.port);
+            LOG_RATE(10, "peer: " << peer << " connected from " << ip << ":" << peer->address.port);
         }
 
         // ============================================================================================
@@ -74,16 +86,24 @@ namespace
         // ============================================================================================
         // ============================================================================================
         {
-            LOG("peer: " << peer << " disconnected.");
+            LOG_RATE(10, "peer: " << peer << " disconnected.");
         }
 
         // ============================================================================================
         // ============================================================================================
-        // remove the peer from the active client registry.
+        // remove the peer from the active client registry and drop any pending force-reset deadline.
         // ============================================================================================
         // ============================================================================================
         {
-            p_inst->server_state.p_i->connected_clients.erase(peer);
+            zp::net::server::State::Internal* p_i = p_inst->server_state.p_i;
+            p_i->connected_clients.erase(peer);
+
+            const auto it = p_i->disconnect_timers.find(peer);
+            if (it != p_i->disconnect_timers.end())
+            {
+                zp::wheel_cancel(&p_i->timers, it->second);
+                p_i->disconnect_timers.erase(it);
+            }
         }
 
         // ============================================================================================
@@ -98,6 +118,76 @@ namespace
             p_inst->server_state.on_client_disconnected.trigger(evt);
         }
     }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // begin_connect: Resolves the configured server address and starts the ENet handshake. nullptr when no peer is free.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    ENetPeer* begin_connect(zp::net::Instance* p_inst)
+    {
+        ENetAddress address;
+        enet_address_set_host(&address, p_inst->client_config.server_addr.c_str());
+        address.port          = p_inst->client_config.server_port;
+
+        ENetPeer* server_peer = enet_host_connect(p_inst->client_state.p_i->host, &address, 2, 0);
+        if (server_peer == nullptr)
+        {
+            WARN("No available peers for initiating an ENet connection.");
+        }
+        return server_peer;
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // finish_connect: Records the server peer and raises the connected event, or resets the peer when the handshake failed.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    bool finish_connect(zp::net::Instance* p_inst, ENetPeer* server_peer, bool connected)
+    {
+        if (!connected)
+        {
+            WARN("Connection to server failed.");
+            enet_peer_reset(server_peer);
+            return false;
+        }
+
+        LOG("Connection to server succeeded.");
+        p_inst->client_state.transient   = {};
+        p_inst->client_state.p_i->server = server_peer;
+
+        p_inst->client_state.on_connected_to_server.trigger({});
+        return true;
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // finish_disconnect: Forgets the server peer, wakes pending recv calls and raises the disconnected event.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void finish_disconnect(zp::net::Instance* p_inst)
+    {
+        p_inst->client_state.transient          = {};
+        p_inst->client_state.p_i->server        = nullptr;
+        p_inst->client_state.p_i->disconnecting = false;
+        zp::async_cancel(&p_inst->client_state.p_i->received);
+
+        p_inst->client_state.on_disconnected_from_server.trigger({});
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // wake_handshake: Hands result to the connect_async or disconnect_async waiting on handle_incoming. One that already timed
+    // out has left the queue, and the result is dropped rather than kept for the next handshake.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void wake_handshake(zp::net::Instance* p_inst, bool result)
+    {
+        if (!p_inst->client_state.p_i->handshake.waiters.empty())
+        {
+            zp::async_push(&p_inst->client_state.p_i->handshake, result);
+        }
+    }
 }
 
 // =========================================================================================================================================
@@ -115,6 +205,7 @@ bool zp::net::server::start_server(zp::net::Instance* p_inst)
     {
         p_inst->server_state.p_i       = new zp::net::server::State::Internal();
         p_inst->server_state.p_i->host = nullptr;
+        zp::wheel_init(&p_inst->server_state.p_i->timers, zp::clock::now_ns());
     }
 
     ENetAddress addr               = {};
@@ -126,6 +217,7 @@ bool zp::net::server::start_server(zp::net::Instance* p_inst)
     if (p_inst->server_state.p_i->host == nullptr)
     {
         WARN("error occurred while trying to create an ENet server host");
+        zp::wheel_exit(&p_inst->server_state.p_i->timers);
         delete p_inst->server_state.p_i;
         p_inst->server_state.p_i = nullptr;
         return false;
@@ -161,6 +253,7 @@ void zp::net::server::stop_server(zp::net::Instance* p_inst)
     // ============================================================================================
     // ============================================================================================
     {
+        zp::wheel_exit(&p_inst->server_state.p_i->timers);
         delete p_inst->server_state.p_i;
         p_inst->server_state.p_i = nullptr;
     }
@@ -168,29 +261,27 @@ void zp::net::server::stop_server(zp::net::Instance* p_inst)
 
 // =========================================================================================================================================
 // =========================================================================================================================================
-// disconnect_client: Attempts graceful ENet disconnection for a single client and falls back to force reset.
+// disconnect_client: Requests a graceful ENet disconnect and schedules a force reset for when no ack arrives in time. The ack is
+// handled by handle_incoming like any other disconnect, which also cancels the deadline.
 // =========================================================================================================================================
 // =========================================================================================================================================
 void zp::net::server::disconnect_client(zp::net::Instance* p_inst, zp::net::server::NetId client)
 {
     WARN("disconnecting: " << client);
 
-    ENetPeer* peer = static_cast<ENetPeer*>(client);
+    ENetPeer* peer                        = static_cast<ENetPeer*>(client);
+    zp::net::server::State::Internal* p_i = p_inst->server_state.p_i;
 
     enet_peer_disconnect(peer, 0);
 
-    ENetEvent evt;
-    if (enet_host_service(p_inst->server_state.p_i->host, &evt, 2000) && evt.type == ENET_EVENT_TYPE_DISCONNECT)
-    {
-        WARN("clean disconnect");
-    }
-    else
+    const zp::ens deadline = zp::clock::now_ns() + zp::net::server::DISCONNECT_CLIENT_TIMEOUT_MS * 1'000'000ull;
+    zp::wheel_cancel(&p_i->timers, p_i->disconnect_timers[peer]);
+    p_i->disconnect_timers[peer] = zp::wheel_schedule_at(&p_i->timers, deadline, [p_inst, peer]()
     {
         WARN("no disconnect ack, force reset");
         enet_peer_reset(peer);
-    }
-
-    process_disconnect(p_inst, peer);
+        process_disconnect(p_inst, peer);
+    });
 }
 
 // =========================================================================================================================================
@@ -207,16 +298,31 @@ void zp::net::server::disconnect_all_clients(zp::net::Instance* p_inst)
         enet_peer_disconnect(peer, 0);
     }
 
-    ENetEvent evt;
-    std::uint32_t timeLeft    = zp::net::server::DISCONNECT_ALL_CLIENTS_TIMEOUT_MS;
-    const std::uint32_t slice = 100;
-    while (timeLeft > 0 && enet_host_service(p_inst->server_state.p_i->host, &evt, slice) > 0)
+    // ============================================================================================
+    // ============================================================================================
+    // service the host until every peer has acked or the monotonic deadline passes. enet blocks in real time, so this reads
+    // fast_ns rather than the possibly virtual clock::now_ns.
+    // ============================================================================================
+    // ============================================================================================
     {
-        if (evt.type == ENET_EVENT_TYPE_DISCONNECT)
+        ENetEvent evt;
+        const zp::ens deadline = zp::clock::fast_ns() + zp::net::server::DISCONNECT_ALL_CLIENTS_TIMEOUT_MS * 1'000'000ull;
+        for (zp::ens now = zp::clock::fast_ns(); now < deadline && !p_inst->server_state.p_i->connected_clients.empty(); now = zp::clock::fast_ns())
         {
-            process_disconnect(p_inst, evt.peer);
+            const enet_uint32 wait_ms = static_cast<enet_uint32>((deadline - now + 999'999) / 1'000'000);
+            if (enet_host_service(p_inst->server_state.p_i->host, &evt, wait_ms) <= 0)
+            {
+                continue;
+            }
+            if (evt.type == ENET_EVENT_TYPE_DISCONNECT)
+            {
+                process_disconnect(p_inst, evt.peer);
+            }
+            else if (evt.type == ENET_EVENT_TYPE_RECEIVE)
+            {
+                enet_packet_destroy(evt.packet);
+            }
         }
-        timeLeft = (timeLeft > slice ? timeLeft - slice : 0);
     }
 
     std::vector<ENetPeer*> leftovers;
@@ -247,6 +353,10 @@ void zp::net::server::disconnect_all_clients(zp::net::Instance* p_inst)
 // =========================================================================================================================================
 void zp::net::server::handle_incoming(zp::net::Instance* p_inst)
 {
+    ZP_PROF_ZONE("net::server::handle_incoming");
+
+    zp::wheel_advance(&p_inst->server_state.p_i->timers, zp::clock::now_ns());
+
     static ENetEvent event;
 
     p_inst->server_state.transient.incoming.clear();
@@ -316,6 +426,8 @@ void zp::net::server::handle_incoming(zp::net::Instance* p_inst)
 // =========================================================================================================================================
 void zp::net::server::handle_outgoing(zp::net::Instance* p_inst)
 {
+    ZP_PROF_ZONE("net::server::handle_outgoing");
+
     for (auto&& event : p_inst->server_state.transient.outgoing)
     {
         send_event(p_inst, std::move(event));
@@ -397,9 +509,11 @@ bool zp::net::client::start_client(zp::net::Instance* p_inst)
     // ============================================================================================
     // ============================================================================================
     {
-        p_inst->client_state.p_i         = new zp::net::client::State::Internal();
-        p_inst->client_state.p_i->host   = nullptr;
-        p_inst->client_state.p_i->server = nullptr;
+        p_inst->client_state.p_i                = new zp::net::client::State::Internal();
+        p_inst->client_state.p_i->host          = nullptr;
+        p_inst->client_state.p_i->server        = nullptr;
+        p_inst->client_state.p_i->connecting    = nullptr;
+        p_inst->client_state.p_i->disconnecting = false;
     }
 
     p_inst->client_state.p_i->host = enet_host_create(nullptr, 1, 2, 0, 0);
@@ -439,10 +553,13 @@ void zp::net::client::stop_client(zp::net::Instance* p_inst)
 
     // ============================================================================================
     // ============================================================================================
-    // release client internals allocated during start_client.
+    // release client internals allocated during start_client. tasks still waiting on them resume with nothing and find
+    // client_state.p_i changed.
     // ============================================================================================
     // ============================================================================================
     {
+        zp::async_cancel(&p_inst->client_state.p_i->handshake);
+        zp::async_cancel(&p_inst->client_state.p_i->received);
         delete p_inst->client_state.p_i;
         p_inst->client_state.p_i = nullptr;
     }
@@ -455,16 +572,9 @@ void zp::net::client::stop_client(zp::net::Instance* p_inst)
 // =========================================================================================================================================
 bool zp::net::client::connect_to_server(zp::net::Instance* p_inst)
 {
-    ENetAddress address;
-    ENetEvent event;
-
-    enet_address_set_host(&address, p_inst->client_config.server_addr.c_str());
-    address.port          = p_inst->client_config.server_port;
-
-    ENetPeer* server_peer = enet_host_connect(p_inst->client_state.p_i->host, &address, 2, 0);
+    ENetPeer* server_peer = begin_connect(p_inst);
     if (server_peer == nullptr)
     {
-        WARN("No available peers for initiating an ENet connection.");
         return false;
     }
 
@@ -473,25 +583,9 @@ bool zp::net::client::connect_to_server(zp::net::Instance* p_inst)
     // block until connection succeeds or timeout to determine handshake result.
     // ============================================================================================
     // ============================================================================================
-    {
-        if (enet_host_service(p_inst->client_state.p_i->host, &event, 5000) > 0 && event.type == ENET_EVENT_TYPE_CONNECT)
-        {
-            LOG("Connection to server succeeded.");
-        }
-        else
-        {
-            WARN("Connection to server failed.");
-            enet_peer_reset(server_peer);
-            return false;
-        }
-    }
-
-    p_inst->client_state.transient   = {};
-    p_inst->client_state.p_i->server = server_peer;
-
-    p_inst->client_state.on_connected_to_server.trigger({});
-
-    return true;
+    ENetEvent event;
+    const bool connected = enet_host_service(p_inst->client_state.p_i->host, &event, zp::net::client::CONNECT_TIMEOUT_MS) > 0 && event.type == ENET_EVENT_TYPE_CONNECT;
+    return finish_connect(p_inst, server_peer, connected);
 }
 
 // =========================================================================================================================================
@@ -504,7 +598,7 @@ void zp::net::client::disconnect_from_server(zp::net::Instance* p_inst)
     enet_peer_disconnect(p_inst->client_state.p_i->server, 0);
 
     ENetEvent evt;
-    if (enet_host_service(p_inst->client_state.p_i->host, &evt, 2000) && evt.type == ENET_EVENT_TYPE_DISCONNECT)
+    if (enet_host_service(p_inst->client_state.p_i->host, &evt, zp::net::client::DISCONNECT_TIMEOUT_MS) && evt.type == ENET_EVENT_TYPE_DISCONNECT)
     {
         WARN("clean disconnect");
     }
@@ -514,19 +608,90 @@ void zp::net::client::disconnect_from_server(zp::net::Instance* p_inst)
         enet_peer_reset(p_inst->client_state.p_i->server);
     }
 
-    p_inst->client_state.transient   = {};
-    p_inst->client_state.p_i->server = nullptr;
+    finish_disconnect(p_inst);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// connect_async: connect_to_server without blocking. Starts the handshake and sleeps until handle_incoming sees it end, or until
+// CONNECT_TIMEOUT_MS passes on the executor's timer wheel.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::task<bool> zp::net::client::connect_async(zp::net::Instance* p_inst)
+{
+    ENetPeer* server_peer = begin_connect(p_inst);
+    if (server_peer == nullptr)
+    {
+        co_return false;
+    }
+
+    zp::net::client::State::Internal* p_i = p_inst->client_state.p_i;
+    p_i->connecting                       = server_peer;
+    const zp::ens deadline_ns             = zp::clock::now_ns() + zp::ens{zp::net::client::CONNECT_TIMEOUT_MS} * 1'000'000;
+    const std::optional<bool> connected   = co_await zp::async_pop_until(&p_i->handshake, deadline_ns);
+    if (p_inst->client_state.p_i != p_i)
+    {
+        co_return false;
+    }
+    if (!connected && p_i->connecting == server_peer)
+    {
+        p_i->connecting = nullptr;
+        co_return finish_connect(p_inst, server_peer, false);
+    }
+    co_return p_i->server == server_peer;
+}
 
-    p_inst->client_state.on_disconnected_from_server.trigger({});
+// =========================================================================================================================================
+// =========================================================================================================================================
+// disconnect_async: disconnect_from_server without blocking. Sleeps until handle_incoming sees the server's ack, and force resets
+// the peer when DISCONNECT_TIMEOUT_MS passes on the executor's timer wheel first.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::task<void> zp::net::client::disconnect_async(zp::net::Instance* p_inst)
+{
+    zp::net::client::State::Internal* p_i = p_inst->client_state.p_i;
+    ENetPeer* server_peer                 = p_i->server;
+    if (server_peer == nullptr)
+    {
+        co_return;
+    }
+
+    enet_peer_disconnect(server_peer, 0);
+    p_i->disconnecting        = true;
+    const zp::ens deadline_ns = zp::clock::now_ns() + zp::ens{zp::net::client::DISCONNECT_TIMEOUT_MS} * 1'000'000;
+    co_await zp::async_pop_until(&p_i->handshake, deadline_ns);
+    if (p_inst->client_state.p_i == p_i && p_i->server == server_peer)
+    {
+        WARN("no disconnect ack, force reset");
+        enet_peer_reset(server_peer);
+        finish_disconnect(p_inst);
+    }
 }
 
 // =========================================================================================================================================
 // =========================================================================================================================================
-// handle_incoming: Pumps the ENet client host capturing inbound packets and server disconnects.
+// recv: Waits on the received queue, which handle_incoming feeds only while someone is waiting.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::task<std::optional<zp::net::client::NetEvent>> zp::net::client::recv(zp::net::Instance* p_inst)
+{
+    if (!is_connected_to_server(p_inst))
+    {
+        co_return std::nullopt;
+    }
+    co_return co_await zp::async_pop(&p_inst->client_state.p_i->received);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// handle_incoming: Pumps the ENet client host capturing inbound packets, the end of connect_async's handshake and server
+// disconnects. The only code servicing the host while the coroutines run, so it also completes them.
 // =========================================================================================================================================
 // =========================================================================================================================================
 void zp::net::client::handle_incoming(zp::net::Instance* p_inst)
 {
+    ZP_PROF_ZONE("net::client::handle_incoming");
+
     static ENetEvent event;
 
     p_inst->client_state.transient.incoming.clear();
@@ -562,19 +727,61 @@ void zp::net::client::handle_incoming(zp::net::Instance* p_inst)
                 net_evt.event_id                   = event_id;
                 net_evt.param_bytes                = std::move(param_bytes);
 
-                p_inst->client_state.transient.incoming.push_back(std::move(net_evt));
+                if (p_inst->client_state.p_i->received.waiters.empty())
+                {
+                    p_inst->client_state.transient.incoming.push_back(std::move(net_evt));
+                }
+                else
+                {
+                    zp::async_push(&p_inst->client_state.p_i->received, std::move(net_evt));
+                }
             }
 
             enet_packet_destroy(event.packet);
         }
+        else if (event.type == ENET_EVENT_TYPE_CONNECT)
+        {
+            // ============================================================================================
+            // ============================================================================================
+            // complete connect_async's handshake; a connect from any other peer is not ours to accept.
+            // ============================================================================================
+            // ============================================================================================
+            if (event.peer == p_inst->client_state.p_i->connecting)
+            {
+                p_inst->client_state.p_i->connecting = nullptr;
+                wake_handshake(p_inst, finish_connect(p_inst, event.peer, true));
+            }
+        }
         else if (event.type == ENET_EVENT_TYPE_DISCONNECT)
         {
-            WARN("server disconnected client");
-
-            p_inst->client_state.transient   = {};
-            p_inst->client_state.p_i->server = nullptr;
+            // ============================================================================================
+            // ============================================================================================
+            // a disconnect ends either the handshake in flight, which failed, or the connection to the server.
+            // ============================================================================================
+            // ============================================================================================
+            if (event.peer == p_inst->client_state.p_i->connecting)
+            {
+                p_inst->client_state.p_i->connecting = nullptr;
+                wake_handshake(p_inst, finish_connect(p_inst, event.peer, false));
+            }
+            else if (event.peer == p_inst->client_state.p_i->server)
+            {
+                const bool disconnecting = p_inst->client_state.p_i->disconnecting;
+                if (disconnecting)
+                {
+                    WARN("clean disconnect");
+                }
+                else
+                {
+                    WARN("server disconnected client");
+                }
 
-            p_inst->client_state.on_disconnected_from_server.trigger({});
+                finish_disconnect(p_inst);
+                if (disconnecting)
+                {
+                    wake_handshake(p_inst, true);
+                }
+            }
         }
     }
 }
@@ -586,6 +793,8 @@ void zp::net::client::handle_incoming(zp::net::Instance* p_inst)
 // =========================================================================================================================================
 void zp::net::client::handle_outgoing(zp::net::Instance* p_inst)
 {
+    ZP_PROF_ZONE("net::client::handle_outgoing");
+
     for (auto&& event : p_inst->client_state.transient.outgoing)
     {
         send_event(p_inst, std::move(event));
@@ -0,0 +1,461 @@
+#include "zp_cpp/pak.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// archives are read through mmap; there is no Windows mapping path.
+#if defined(_WIN32) || defined(_WIN64)
+#error "zp::pak requires POSIX mmap"
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // align_up: Rounds offset up to the next multiple of zp::pak::ALIGNMENT.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    std::uint64_t align_up(std::uint64_t offset)
+    {
+        return (offset + zp::pak::ALIGNMENT - 1) & ~(zp::pak::ALIGNMENT - 1);
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// path_hash: FNV-1a of the '/'-separated relative path. Never returns 0 so that 0 can mark empty toc slots.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::uint64_t zp::pak::path_hash(std::string_view rel_path) noexcept
+{
+    const std::uint64_t hash = zp::hash::hash_str(rel_path);
+    return hash == 0 ? 1 : hash;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// pack_dir: Packs every regular file below dir into a single archive at out_path, keyed by its path relative to dir. With
+// compress_entries, each file is stored as a zp::compress block whenever that is smaller than the raw bytes.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::Result zp::pak::pack_dir(const std::filesystem::path& dir, const std::filesystem::path& out_path, bool compress_entries)
+{
+    // =============================================================================================
+    // =============================================================================================
+    // Guard: the source must be an existing directory.
+    // =============================================================================================
+    // =============================================================================================
+    {
+        if (!std::filesystem::is_directory(dir))
+        {
+            return Result::ZC_FILE_NOT_FOUND;
+        }
+    }
+
+    // =============================================================================================
+    // =============================================================================================
+    // Collect relative paths in a stable order so identical inputs produce identical archives.
+    // =============================================================================================
+    // =============================================================================================
+    std::vector<std::filesystem::path> rel_paths;
+    {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dir))
+        {
+            if (!entry.is_regular_file())
+            {
+                continue;
+            }
+            rel_paths.push_back(entry.path().lexically_relative(dir));
+        }
+        std::sort(rel_paths.begin(), rel_paths.end());
+    }
+
+    // =============================================================================================
+    // =============================================================================================
+    // Size the open-addressed toc to a power of two that stays at most half full, with the path table right behind it.
+    // =============================================================================================
+    // =============================================================================================
+    std::vector<Entry> slots;
+    std::uint32_t slot_mask;
+    std::uint64_t paths_offset;
+    std::uint64_t paths_end;
+    std::uint64_t data_offset;
+    {
+        std::uint32_t slot_count = 1;
+        while (slot_count < rel_paths.size() * 2)
+        {
+            slot_count <<= 1;
+        }
+
+        std::uint64_t paths_size = 0;
+        for (const auto& rel_path : rel_paths)
+        {
+            paths_size += rel_path.generic_string().size();
+        }
+
+        slots.assign(slot_count, Entry{});
+        slot_mask    = slot_count - 1;
+        paths_offset = sizeof(Header) + slot_count * sizeof(Entry);
+        paths_end    = paths_offset + paths_size;
+        data_offset  = align_up(paths_end);
+    }
+
+    std::ofstream ofs(out_path, std::ios::binary | std::ios::trunc);
+    if (!ofs)
+    {
+        return Result::ZC_FILE_ACCESS_ERROR;
+    }
+
+    // =============================================================================================
+    // =============================================================================================
+    // Write every file at an aligned offset and its path into the path table, and fill in its toc slot with both plus size and
+    // checksum. Paths are unique, so a hash collision only moves the slot along the probe. Packing is offline, so entries use
+    // the slower high-ratio level; decompression speed is the same either way.
+    // =============================================================================================
+    // =============================================================================================
+    Result result             = Result::ZC_SUCCESS;
+    std::uint64_t cursor      = data_offset;
+    std::uint64_t path_cursor = paths_offset;
+    std::uint64_t end         = data_offset;
+    std::uint64_t written_end = paths_end;
+    {
+        std::vector<std::byte> file_bytes;
+        std::vector<std::byte> packed_bytes;
+        for (const auto& rel_path : rel_paths)
+        {
+            const std::string rel    = rel_path.generic_string();
+            const std::uint64_t hash = path_hash(rel);
+
+            std::uint32_t slot_idx   = static_cast<std::uint32_t>(hash) & slot_mask;
+            while (slots[slot_idx].path_hash != 0)
+            {
+                slot_idx = (slot_idx + 1) & slot_mask;
+            }
+
+            const std::uint64_t size = std::filesystem::file_size(dir / rel_path);
+            file_bytes.resize(size);
+
+            std::ifstream ifs(dir / rel_path, std::ios::binary);
+            ifs.read(reinterpret_cast<char*>(file_bytes.data()), static_cast<std::streamsize>(size));
+            if (!ifs.good())
+            {
+                result = Result::ZC_FILE_READ_ERROR;
+                break;
+            }
+
+            span<const std::byte> stored = {file_bytes.data(), size};
+            std::uint32_t flags          = ENTRY_NONE;
+            if (compress_entries && size > 0)
+            {
+                packed_bytes.resize(zp::compress::compress_bound(size));
+
+                span<std::byte> packed;
+                if (zp::compress::compress_block(stored, {packed_bytes.data(), packed_bytes.size()}, zp::compress::Level::HIGH, &packed) == Result::ZC_SUCCESS && packed.count < size)
+                {
+                    stored = {packed.p, packed.count};
+                    flags  = ENTRY_COMPRESSED;
+                }
+            }
+
+            ofs.seekp(static_cast<std::streamoff>(path_cursor));
+            ofs.write(rel.data(), static_cast<std::streamsize>(rel.size()));
+
+            if (stored.count > 0)
+            {
+                ofs.seekp(static_cast<std::streamoff>(cursor));
+                ofs.write(reinterpret_cast<const char*>(stored.p), static_cast<std::streamsize>(stored.count));
+                written_end = cursor + stored.count;
+            }
+
+            Entry& slot      = slots[slot_idx];
+            slot.path_hash   = hash;
+            slot.path_offset = path_cursor;
+            slot.offset      = cursor;
+            slot.stored_size = stored.count;
+            slot.raw_size    = size;
+            slot.flags       = flags;
+            slot.path_size   = static_cast<std::uint32_t>(rel.size());
+            slot.checksum    = zp::hash::hash_data(stored.p, stored.count);
+
+            path_cursor     += rel.size();
+            end              = cursor + stored.count;
+            cursor           = align_up(end);
+        }
+    }
+
+    // =============================================================================================
+    // =============================================================================================
+    // Write the header and toc in front of the data now that every slot is known.
+    // =============================================================================================
+    // =============================================================================================
+    {
+        if (result == Result::ZC_SUCCESS)
+        {
+            Header header      = {};
+            header.magic       = MAGIC;
+            header.version     = VERSION;
+            header.slot_count  = slot_mask + 1;
+            header.entry_count = static_cast<std::uint32_t>(rel_paths.size());
+            header.data_offset = data_offset;
+            header.total_size  = end;
+
+            ofs.seekp(0);
+            ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            ofs.write(reinterpret_cast<const char*>(slots.data()), static_cast<std::streamsize>(slots.size() * sizeof(Entry)));
+
+            // trailing empty entries (or an empty archive) sit past the last written byte; pad so every offset lies inside the file.
+            if (end > written_end)
+            {
+                ofs.seekp(static_cast<std::streamoff>(end - 1));
+                ofs.put('\0');
+            }
+        }
+
+        ofs.close();
+        if (result == Result::ZC_SUCCESS && !ofs.good())
+        {
+            result = Result::ZC_FILE_WRITE_ERROR;
+        }
+
+        if (result != Result::ZC_SUCCESS)
+        {
+            std::error_code ec;
+            std::filesystem::remove(out_path, ec);
+        }
+    }
+
+    return result;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// open: Maps the whole archive at config.path read-only and validates its header. Lookups afterwards make no syscalls.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::Result zp::pak::open(Archive* p_archive)
+{
+    // =============================================================================================
+    // =============================================================================================
+    // Map the file. The descriptor is not needed once the mapping exists.
+    // =============================================================================================
+    // =============================================================================================
+    std::size_t size;
+    void* p_map;
+    {
+        const int fd = ::open(p_archive->config.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return Result::ZC_FILE_NOT_FOUND;
+        }
+
+        struct stat st = {};
+        if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header))
+        {
+            ::close(fd);
+            return Result::ZC_INVALID_FORMAT;
+        }
+
+        size  = static_cast<std::size_t>(st.st_size);
+        p_map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (p_map == MAP_FAILED)
+        {
+            return Result::ZC_FILE_READ_ERROR;
+        }
+    }
+
+    // =============================================================================================
+    // =============================================================================================
+    // Validate the header and every toc slot once so that find can trust the table without bounds checks.
+    // =============================================================================================
+    // =============================================================================================
+    bool valid;
+    {
+        const Header* p_header = static_cast<const Header*>(p_map);
+        const Entry* p_slots   = reinterpret_cast<const Entry*>(p_header + 1);
+
+        valid                  = p_header->magic == MAGIC && p_header->version == VERSION;
+        valid                  = valid && p_header->slot_count != 0 && (p_header->slot_count & (p_header->slot_count - 1)) == 0;
+        valid                  = valid && static_cast<std::uint64_t>(p_header->entry_count) * 2 <= p_header->slot_count;
+        valid                  = valid && sizeof(Header) + static_cast<std::uint64_t>(p_header->slot_count) * sizeof(Entry) <= size;
+        valid                  = valid && p_header->total_size <= size;
+
+        // a table with more occupied slots than entries, or none empty, would send find probing forever on a miss.
+        std::uint32_t occupied = 0;
+        for (std::uint32_t i = 0; valid && i < p_header->slot_count; ++i)
+        {
+            const Entry& slot  = p_slots[i];
+            valid              = slot.path_hash == 0 || (slot.offset <= size && slot.stored_size <= size - slot.offset && slot.path_offset <= size && slot.path_size <= size - slot.path_offset);
+            occupied          += slot.path_hash != 0;
+        }
+        valid = valid && occupied == p_header->entry_count;
+    }
+
+    // =============================================================================================
+    // =============================================================================================
+    // Publish the mapping, or release it when the archive is malformed.
+    // =============================================================================================
+    // =============================================================================================
+    {
+        if (!valid)
+        {
+            munmap(p_map, size);
+            return Result::ZC_INVALID_FORMAT;
+        }
+
+        const Header* p_header     = static_cast<const Header*>(p_map);
+        p_archive->state.p_base    = static_cast<const std::byte*>(p_map);
+        p_archive->state.size      = size;
+        p_archive->state.p_slots   = reinterpret_cast<const Entry*>(p_header + 1);
+        p_archive->state.slot_mask = p_header->slot_count - 1;
+
+        madvise(p_map, sizeof(Header) + p_header->slot_count * sizeof(Entry), MADV_WILLNEED);
+    }
+
+    return Result::ZC_SUCCESS;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// close: Unmaps an archive previously mapped by open.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::pak::close(Archive* p_archive)
+{
+    if (p_archive->state.p_base == nullptr)
+    {
+        return;
+    }
+
+    munmap(const_cast<std::byte*>(p_archive->state.p_base), p_archive->state.size);
+    p_archive->state = {};
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// find_entry: Returns the toc entry for rel_path, or nullptr when the archive does not contain it.
+// =========================================================================================================================================
+// =========================================================================================================================================
+const zp::pak::Entry* zp::pak::find_entry(const Archive* p_archive, std::string_view rel_path) noexcept
+{
+    if (p_archive->state.p_slots == nullptr)
+    {
+        return nullptr;
+    }
+
+    const std::uint64_t hash = path_hash(rel_path);
+    std::uint32_t slot_idx   = static_cast<std::uint32_t>(hash) & p_archive->state.slot_mask;
+    while (p_archive->state.p_slots[slot_idx].path_hash != 0)
+    {
+        const Entry& slot = p_archive->state.p_slots[slot_idx];
+        if (slot.path_hash == hash && std::string_view(reinterpret_cast<const char*>(p_archive->state.p_base + slot.path_offset), slot.path_size) == rel_path)
+        {
+            return &slot;
+        }
+        slot_idx = (slot_idx + 1) & p_archive->state.slot_mask;
+    }
+    return nullptr;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// find: Returns a view of the stored bytes for rel_path directly inside the mapping.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::Result zp::pak::find(const Archive* p_archive, std::string_view rel_path, span<const std::byte>* p_out) noexcept
+{
+    const Entry* p_entry = find_entry(p_archive, rel_path);
+    if (p_entry == nullptr)
+    {
+        return Result::ZC_FILE_NOT_FOUND;
+    }
+
+    p_out->p     = p_archive->state.p_base + p_entry->offset;
+    p_out->count = p_entry->stored_size;
+    return Result::ZC_SUCCESS;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// read: Copies the raw contents of rel_path into buffer, decompressing compressed entries. Fails with ZC_OUT_OF_BOUNDS when
+// buffer is smaller than the entry's raw_size.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::Result zp::pak::read(const Archive* p_archive, std::string_view rel_path, span<std::byte> buffer, span<std::byte>* p_out)
+{
+    const Entry* p_entry = find_entry(p_archive, rel_path);
+    if (p_entry == nullptr)
+    {
+        return Result::ZC_FILE_NOT_FOUND;
+    }
+
+    if (buffer.count < p_entry->raw_size)
+    {
+        return Result::ZC_OUT_OF_BOUNDS;
+    }
+
+    const span<const std::byte> stored = {p_archive->state.p_base + p_entry->offset, p_entry->stored_size};
+
+    // =============================================================================================
+    // =============================================================================================
+    // Decode compressed entries straight into the caller's buffer; a size mismatch means the toc and data disagree.
+    // =============================================================================================
+    // =============================================================================================
+    {
+        if ((p_entry->flags & ENTRY_COMPRESSED) != 0)
+        {
+            const Result result = zp::compress::decompress_block(stored, {buffer.p, p_entry->raw_size}, p_out);
+            if (result != Result::ZC_SUCCESS || p_out->count != p_entry->raw_size)
+            {
+                return Result::ZC_INVALID_FORMAT;
+            }
+            return Result::ZC_SUCCESS;
+        }
+    }
+
+    if (stored.count > 0)
+    {
+        std::memcpy(buffer.p, stored.p, stored.count);
+    }
+    p_out->p     = buffer.p;
+    p_out->count = stored.count;
+    return Result::ZC_SUCCESS;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// verify: Recomputes the hash256 of every entry and compares it against the checksum stored in the toc.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::Result zp::pak::verify(const Archive* p_archive)
+{
+    if (p_archive->state.p_slots == nullptr)
+    {
+        return Result::ZC_FILE_NOT_FOUND;
+    }
+
+    for (std::uint32_t i = 0; i <= p_archive->state.slot_mask; ++i)
+    {
+        const Entry& slot = p_archive->state.p_slots[i];
+        if (slot.path_hash == 0)
+        {
+            continue;
+        }
+
+        const zp::hash::hash256 actual = zp::hash::hash_data(p_archive->state.p_base + slot.offset, slot.stored_size);
+        if (actual != slot.checksum)
+        {
+            return Result::ZC_CHECKSUM_MISMATCH;
+        }
+    }
+    return Result::ZC_SUCCESS;
+}
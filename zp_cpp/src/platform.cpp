@@ -1,7 +1,5 @@
 #include "zp_cpp/platform.hpp"
 
-#include <chrono>
-
 using namespace zp::platform;
 
 // =========================================================================================================================================
@@ -62,7 +60,7 @@ static void key_callback(GLFWwindow* window, int key, int scancode, int action,
                 || previous_keyboard_state.isSPressed != current_keyboard_state.isSPressed || previous_keyboard_state.isDPressed != current_keyboard_state.isDPressed)
             {
                 p_inst->input.keyboard = current_keyboard_state;
-                p_inst->input.on_keyboard_state_changed.trigger(zp::Void{});
+                zp::enqueue(&p_inst->input.queue, zp::Void{});
             }
         }
     }
@@ -82,39 +80,39 @@ static void key_callback(GLFWwindow* window, int key, int scancode, int action,
 
         if (key == GLFW_KEY_GRAVE_ACCENT)
         {
-            p_inst->input.on_key_down.trigger(input::KeyDownEvt{input::Keys::Backtick});
+            zp::enqueue(&p_inst->input.queue, input::KeyDownEvt{input::Keys::Backtick});
         }
         else if (key == GLFW_KEY_T)
         {
-            p_inst->input.on_key_down.trigger(input::KeyDownEvt{input::Keys::T});
+            zp::enqueue(&p_inst->input.queue, input::KeyDownEvt{input::Keys::T});
         }
         else if (key == GLFW_KEY_Z)
         {
-            p_inst->input.on_key_down.trigger(input::KeyDownEvt{input::Keys::Z});
+            zp::enqueue(&p_inst->input.queue, input::KeyDownEvt{input::Keys::Z});
         }
         else if (key == GLFW_KEY_X)
         {
-            p_inst->input.on_key_down.trigger(input::KeyDownEvt{input::Keys::X});
+            zp::enqueue(&p_inst->input.queue, input::KeyDownEvt{input::Keys::X});
         }
         else if (key == GLFW_KEY_SPACE)
         {
-            p_inst->input.on_key_down.trigger(input::KeyDownEvt{input::Keys::Space});
+            zp::enqueue(&p_inst->input.queue, input::KeyDownEvt{input::Keys::Space});
         }
         else if (key == GLFW_KEY_ENTER)
         {
-            p_inst->input.on_key_down.trigger(input::KeyDownEvt{input::Keys::Enter});
+            zp::enqueue(&p_inst->input.queue, input::KeyDownEvt{input::Keys::Enter});
         }
         else if (key == GLFW_KEY_BACKSPACE)
         {
-            p_inst->input.on_key_down.trigger(input::KeyDownEvt{input::Keys::Backspace});
+            zp::enqueue(&p_inst->input.queue, input::KeyDownEvt{input::Keys::Backspace});
         }
         else if (key == GLFW_KEY_ESCAPE)
         {
-            p_inst->input.on_key_down.trigger(input::KeyDownEvt{input::Keys::Escape});
+            zp::enqueue(&p_inst->input.queue, input::KeyDownEvt{input::Keys::Escape});
         }
         else if (key == GLFW_KEY_F)
         {
-            p_inst->input.on_key_down.trigger(input::KeyDownEvt{input::Keys::F});
+            zp::enqueue(&p_inst->input.queue, input::KeyDownEvt{input::Keys::F});
         }
 
         const bool did_state_change = previous_keyboard_state.isShiftPressed != current_keyboard_state.isShiftPressed || previous_keyboard_state.isWPressed != current_keyboard_state.isWPressed || previous_keyboard_state.isAPressed != current_keyboard_state.isAPressed
@@ -145,7 +143,7 @@ static void key_callback(GLFWwindow* window, int key, int scancode, int action,
                 axis = zp::math::normalize(axis);
             }
 
-            p_inst->input.on_wasd_axis_changed.trigger(input::WasdAxisChangedEvt{axis});
+            zp::enqueue(&p_inst->input.queue, input::WasdAxisChangedEvt{axis});
         }
 
         previous_keyboard_state = current_keyboard_state;
@@ -155,7 +153,8 @@ static void key_callback(GLFWwindow* window, int key, int scancode, int action,
 
 // =========================================================================================================================================
 // =========================================================================================================================================
-// cursor_position_callback: Updates mouse position state and emits move/drag events based on GLFW cursor input.
+// cursor_position_callback: Updates mouse position state and emits move/drag events based on GLFW cursor input. Every sample is
+// queued; the queue coalesces a frame's worth into one move and one drag per button state.
 // =========================================================================================================================================
 // =========================================================================================================================================
 static void cursor_position_callback(GLFWwindow* window, double xpos, double ypos)
@@ -164,22 +163,6 @@ static void cursor_position_callback(GLFWwindow* window, double xpos, double ypo
     auto& mouse_state    = p_inst->input.mouse;
     auto& keyboard_state = p_inst->input.keyboard;
 
-    // ====================================================================================================
-    // ====================================================================================================
-    // Rate-limit high frequency input to roughly 100 Hz to reduce event spam.
-    // ====================================================================================================
-    // ====================================================================================================
-    {
-        static auto last_time   = std::chrono::high_resolution_clock::now();
-        const auto current_time = std::chrono::high_resolution_clock::now();
-        const auto elapsed_ms   = std::chrono::duration_cast<std::chrono::milliseconds>(current_time - last_time).count();
-        if (elapsed_ms < 10)
-        {
-            return;
-        }
-        last_time = current_time;
-    }
-
     // ====================================================================================================
     // ====================================================================================================
     // Convert screen coordinates to normalised window space.
@@ -214,7 +197,7 @@ static void cursor_position_callback(GLFWwindow* window, double xpos, double ypo
         input::MouseMoveEvt move_evt{};
         move_evt.pos = new_pos;
         move_evt.d   = delta;
-        p_inst->input.on_mouse_moved.trigger(move_evt);
+        zp::enqueue(&p_inst->input.queue, move_evt);
 
         if (mouse_state.leftButtonPressed || mouse_state.middleButtonPressed || mouse_state.rightButtonPressed)
         {
@@ -225,7 +208,7 @@ static void cursor_position_callback(GLFWwindow* window, double xpos, double ypo
             drag_evt.middleButtonPressed  = mouse_state.middleButtonPressed;
             drag_evt.rightButtonPressed   = mouse_state.rightButtonPressed;
             drag_evt.isShiftButtonPressed = keyboard_state.isShiftPressed;
-            p_inst->input.on_mouse_dragged.trigger(drag_evt);
+            zp::enqueue(&p_inst->input.queue, drag_evt);
         }
     }
 }
@@ -253,13 +236,13 @@ static void mouse_button_callback(GLFWwindow* window, int button, int action, in
             if (action == GLFW_PRESS)
             {
                 mouse_state.leftButtonPressed = true;
-                p_inst->input.on_pointer_down.trigger(input::PointerDownEvt{mouse_state.mousePosition});
-                p_inst->input.on_pointer_clicked.trigger(input::PointerClickEvt{mouse_state.mousePosition});
+                zp::enqueue(&p_inst->input.queue, input::PointerDownEvt{mouse_state.mousePosition});
+                zp::enqueue(&p_inst->input.queue, input::PointerClickEvt{mouse_state.mousePosition});
             }
             else if (action == GLFW_RELEASE)
             {
                 mouse_state.leftButtonPressed = false;
-                p_inst->input.on_pointer_up.trigger(input::PointerUpEvt{mouse_state.mousePosition});
+                zp::enqueue(&p_inst->input.queue, input::PointerUpEvt{mouse_state.mousePosition});
             }
             return;
         }
@@ -276,7 +259,7 @@ static void mouse_button_callback(GLFWwindow* window, int button, int action, in
             if (action == GLFW_PRESS)
             {
                 mouse_state.rightButtonPressed = true;
-                p_inst->input.on_pointer_right_clicked.trigger(input::PointerRightClickEvt{mouse_state.mousePosition});
+                zp::enqueue(&p_inst->input.queue, input::PointerRightClickEvt{mouse_state.mousePosition});
             }
             else if (action == GLFW_RELEASE)
             {
@@ -317,7 +300,7 @@ static void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
     (void)xoffset;
 
     Instance* p_inst = static_cast<Instance*>(glfwGetWindowUserPointer(window));
-    p_inst->input.on_mouse_scrolled.trigger(input::MouseScrollEvt{static_cast<float>(yoffset)});
+    zp::enqueue(&p_inst->input.queue, input::MouseScrollEvt{static_cast<float>(yoffset)});
 }
 
 // =========================================================================================================================================
@@ -328,12 +311,53 @@ static void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 static void character_callback(GLFWwindow* window, unsigned int codepoint)
 {
     Instance* p_inst = static_cast<Instance*>(glfwGetWindowUserPointer(window));
-    p_inst->input.on_char_typed.trigger(input::CharTypedEvt{codepoint});
+    zp::enqueue(&p_inst->input.queue, input::CharTypedEvt{codepoint});
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// merge_mouse_move: Folds a later move into an earlier one: the later position and the summed delta.
+// =========================================================================================================================================
+// =========================================================================================================================================
+static bool merge_mouse_move(input::MouseMoveEvt* p_into, const input::MouseMoveEvt& next)
+{
+    p_into->pos  = next.pos;
+    p_into->d   += next.d;
+    return true;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// merge_mouse_drag: As merge_mouse_move, but only while the buttons and shift are unchanged, so a drag that switches buttons
+// mid-frame still arrives as two drags.
+// =========================================================================================================================================
+// =========================================================================================================================================
+static bool merge_mouse_drag(input::MouseDragEvt* p_into, const input::MouseDragEvt& next)
+{
+    if (p_into->leftButtonPressed != next.leftButtonPressed || p_into->middleButtonPressed != next.middleButtonPressed || p_into->rightButtonPressed != next.rightButtonPressed || p_into->isShiftButtonPressed != next.isShiftButtonPressed)
+    {
+        return false;
+    }
+    p_into->pos  = next.pos;
+    p_into->d   += next.d;
+    return true;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// merge_mouse_scroll: Sums scroll deltas.
+// =========================================================================================================================================
+// =========================================================================================================================================
+static bool merge_mouse_scroll(input::MouseScrollEvt* p_into, const input::MouseScrollEvt& next)
+{
+    p_into->d += next.d;
+    return true;
 }
 
 // =========================================================================================================================================
 // =========================================================================================================================================
-// init: Creates a GLFW window and installs callbacks for translating platform input into zp events.
+// init: Creates a GLFW window, installs callbacks for translating platform input into zp events and routes the input queue to the
+// on_* events.
 // =========================================================================================================================================
 // =========================================================================================================================================
 void zp::platform::init(Instance* p_inst, int window_w, int window_h)
@@ -363,6 +387,42 @@ void zp::platform::init(Instance* p_inst, int window_w, int window_h)
         glfwSetScrollCallback(p_inst->window.window, scroll_callback);
         glfwSetCharCallback(p_inst->window.window, character_callback);
     }
+
+    // ====================================================================================================
+    // ====================================================================================================
+    // Route each queued input type to its on_* event. Channels are created here, so every frame
+    // dispatches in this order.
+    // ====================================================================================================
+    // ====================================================================================================
+    {
+        input::State& input = p_inst->input;
+        input.queue_routes.push_back(zp::queue_forward(&input.queue, &input.on_keyboard_state_changed));
+        input.queue_routes.push_back(zp::queue_forward(&input.queue, &input.on_key_down));
+        input.queue_routes.push_back(zp::queue_forward(&input.queue, &input.on_wasd_axis_changed));
+        input.queue_routes.push_back(zp::queue_forward(&input.queue, &input.on_char_typed));
+        input.queue_routes.push_back(zp::queue_forward(&input.queue, &input.on_mouse_moved));
+        input.queue_routes.push_back(zp::queue_forward(&input.queue, &input.on_mouse_dragged));
+        input.queue_routes.push_back(zp::queue_forward(&input.queue, &input.on_pointer_down));
+        input.queue_routes.push_back(zp::queue_forward(&input.queue, &input.on_pointer_clicked));
+        input.queue_routes.push_back(zp::queue_forward(&input.queue, &input.on_pointer_right_clicked));
+        input.queue_routes.push_back(zp::queue_forward(&input.queue, &input.on_pointer_up));
+        input.queue_routes.push_back(zp::queue_forward(&input.queue, &input.on_mouse_scrolled));
+    }
+
+    // ====================================================================================================
+    // ====================================================================================================
+    // Coalesce the high frequency streams per frame: pointer motion and scrolling sum their deltas, and
+    // the WASD axis and keyboard state only matter as of the end of the frame. Discrete events keep all.
+    // ====================================================================================================
+    // ====================================================================================================
+    {
+        zp::event_queue* p_queue = &p_inst->input.queue;
+        ZC_ASSERT(zp::queue_coalesce<input::MouseMoveEvt>(p_queue, zp::Coalesce::ACCUMULATE, merge_mouse_move));
+        ZC_ASSERT(zp::queue_coalesce<input::MouseDragEvt>(p_queue, zp::Coalesce::ACCUMULATE, merge_mouse_drag));
+        ZC_ASSERT(zp::queue_coalesce<input::MouseScrollEvt>(p_queue, zp::Coalesce::ACCUMULATE, merge_mouse_scroll));
+        ZC_ASSERT(zp::queue_coalesce<input::WasdAxisChangedEvt>(p_queue, zp::Coalesce::KEEP_LATEST));
+        ZC_ASSERT(zp::queue_coalesce<zp::Void>(p_queue, zp::Coalesce::KEEP_LATEST));
+    }
 }
 
 // =========================================================================================================================================
@@ -377,13 +437,13 @@ bool zp::platform::should_close(Instance* p_inst)
 
 // =========================================================================================================================================
 // =========================================================================================================================================
-// poll_events: Pumps GLFW's event queue so callbacks are delivered.
+// poll_events: Pumps GLFW's event queue, then dispatches what the callbacks enqueued outside of GLFW.
 // =========================================================================================================================================
 // =========================================================================================================================================
 void zp::platform::poll_events(Instance* p_inst)
 {
-    (void)p_inst;
     glfwPollEvents();
+    zp::dispatch_all(&p_inst->input.queue);
 }
 
 // =========================================================================================================================================
@@ -393,6 +453,7 @@ void zp::platform::poll_events(Instance* p_inst)
 // =========================================================================================================================================
 void zp::platform::cleanup(Instance* p_inst)
 {
+    p_inst->input.queue_routes.clear();
     glfwDestroyWindow(p_inst->window.window);
     p_inst->window.window = nullptr;
     glfwTerminate();
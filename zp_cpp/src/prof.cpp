@@ -0,0 +1,335 @@
+#include "zp_cpp/prof.hpp"
+#include "zp_cpp/files.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+    // perfetto TracePacket field numbers used by the protobuf export.
+    constexpr std::uint32_t TRACE_PACKET                  = 1;
+    constexpr std::uint32_t PACKET_TIMESTAMP              = 8;
+    constexpr std::uint32_t PACKET_SEQUENCE_ID            = 10;
+    constexpr std::uint32_t PACKET_TRACK_EVENT            = 11;
+    constexpr std::uint32_t PACKET_SEQUENCE_FLAGS         = 13;
+    constexpr std::uint32_t PACKET_TRACK_DESCRIPTOR       = 60;
+    constexpr std::uint32_t TRACK_EVENT_TYPE              = 9;
+    constexpr std::uint32_t TRACK_EVENT_TRACK_UUID        = 11;
+    constexpr std::uint32_t TRACK_EVENT_NAME              = 23;
+    constexpr std::uint32_t TRACK_DESCRIPTOR_UUID         = 1;
+    constexpr std::uint32_t TRACK_DESCRIPTOR_THREAD       = 4;
+    constexpr std::uint32_t THREAD_DESCRIPTOR_PID         = 1;
+    constexpr std::uint32_t THREAD_DESCRIPTOR_TID         = 2;
+    constexpr std::uint32_t THREAD_DESCRIPTOR_NAME        = 5;
+    constexpr std::uint64_t TYPE_SLICE_BEGIN              = 1;
+    constexpr std::uint64_t TYPE_SLICE_END                = 2;
+    constexpr std::uint64_t SEQ_INCREMENTAL_STATE_CLEARED = 1;
+    constexpr std::uint32_t SEQUENCE_ID                   = 1;
+
+    // a thread's events plus its identity, copied under g_buffers_mutex since set_thread_name may rename it mid-dump.
+    struct Snapshot
+    {
+        std::uint32_t tid;
+        char name[sizeof(zp::prof::ThreadBuffer::name)];
+        std::vector<zp::prof::Event> events;
+    };
+
+    // one end of a zone, for emitting begin/end pairs in nesting order.
+    struct Edge
+    {
+        std::uint64_t ticks;
+        std::uint64_t duration;
+        const char* name;
+        bool begin;
+    };
+
+    std::mutex g_buffers_mutex;
+    std::vector<std::unique_ptr<zp::prof::ThreadBuffer>> g_buffers;
+    std::uint64_t g_anchor_ticks = 0;
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // append_varint: Appends a protobuf base-128 varint.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void append_varint(std::string* p_out, std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            p_out->push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        p_out->push_back(static_cast<char>(value));
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // append_tag: Appends a protobuf field key.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void append_tag(std::string* p_out, std::uint32_t field, std::uint32_t wire_type)
+    {
+        append_varint(p_out, (static_cast<std::uint64_t>(field) << 3) | wire_type);
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // append_bytes: Appends a length-delimited protobuf field (string, bytes or nested message).
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void append_bytes(std::string* p_out, std::uint32_t field, std::string_view bytes)
+    {
+        append_tag(p_out, field, 2);
+        append_varint(p_out, bytes.size());
+        p_out->append(bytes);
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // append_uint: Appends a varint protobuf field.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void append_uint(std::string* p_out, std::uint32_t field, std::uint64_t value)
+    {
+        append_tag(p_out, field, 0);
+        append_varint(p_out, value);
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // append_json_string: Appends a quoted JSON string. Zone names are literals, so only quotes, backslashes and control characters
+    // need care.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void append_json_string(std::string* p_out, std::string_view text)
+    {
+        p_out->push_back('"');
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                p_out->push_back('\\');
+                p_out->push_back(c);
+            }
+            else if (static_cast<unsigned char>(c) >= 0x20)
+            {
+                p_out->push_back(c);
+            }
+        }
+        p_out->push_back('"');
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// register_thread: Allocates the calling thread's ring. The first registration also sets the Chrome trace time origin.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::prof::ThreadBuffer* zp::prof::register_thread()
+{
+    std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+    buffer->head.store(0, std::memory_order_relaxed);
+    buffer->discard_before.store(0, std::memory_order_relaxed);
+    buffer->tid = static_cast<std::uint32_t>(syscall(SYS_gettid));
+    std::snprintf(buffer->name, sizeof(buffer->name), "thread %u", buffer->tid);
+
+    std::lock_guard<std::mutex> lock(g_buffers_mutex);
+    if (g_buffers.empty())
+    {
+        g_anchor_ticks = zp::clock::ticks();
+    }
+    g_buffers.push_back(std::move(buffer));
+    return g_buffers.back().get();
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// set_thread_name: Names the calling thread's track in dumps. Longer names are truncated.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::prof::set_thread_name(const char* name)
+{
+    ThreadBuffer* p_buffer = thread_buffer();
+    std::lock_guard<std::mutex> lock(g_buffers_mutex);
+    std::snprintf(p_buffer->name, sizeof(p_buffer->name), "%s", name);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// reset: Moves every ring's discard mark up to its current head.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::prof::reset()
+{
+    std::lock_guard<std::mutex> lock(g_buffers_mutex);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : g_buffers)
+    {
+        buffer->discard_before.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// dump: Snapshots every ring, converts ticks through zp::clock and writes Chrome trace JSON or Perfetto protobuf.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::Result zp::prof::dump(const std::filesystem::path& path, Format format)
+{
+    // =================================================================================================
+    // =================================================================================================
+    // Snapshot the rings. Events the owner overwrote while they were being copied are dropped by re-reading head afterwards. The
+    // slot at that head may be mid-write as well, so only the RING_EVENTS - 1 events before it are kept.
+    // =================================================================================================
+    // =================================================================================================
+    std::vector<Snapshot> snapshots;
+    std::uint64_t anchor_ticks = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_buffers_mutex);
+        anchor_ticks = g_anchor_ticks;
+
+        for (const std::unique_ptr<ThreadBuffer>& buffer : g_buffers)
+        {
+            const std::uint64_t head    = buffer->head.load(std::memory_order_acquire);
+            const std::uint64_t discard = buffer->discard_before.load(std::memory_order_relaxed);
+            const std::uint64_t first   = std::max(discard, head > RING_EVENTS ? head - RING_EVENTS : 0);
+
+            Snapshot snapshot           = {buffer->tid, {}, {}};
+            std::memcpy(snapshot.name, buffer->name, sizeof(snapshot.name));
+            snapshot.events.reserve(head - first);
+            for (std::uint64_t i = first; i < head; ++i)
+            {
+                const Slot& slot = buffer->slots[i & (RING_EVENTS - 1)];
+                snapshot.events.push_back({slot.name.load(std::memory_order_relaxed), slot.begin.load(std::memory_order_relaxed), slot.end.load(std::memory_order_relaxed)});
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const std::uint64_t head_after = buffer->head.load(std::memory_order_relaxed);
+            const std::uint64_t valid_from = head_after >= RING_EVENTS ? head_after + 1 - RING_EVENTS : 0;
+            if (valid_from > first)
+            {
+                snapshot.events.erase(snapshot.events.begin(), snapshot.events.begin() + static_cast<std::ptrdiff_t>(std::min(valid_from, head) - first));
+            }
+            snapshots.push_back(std::move(snapshot));
+        }
+    }
+
+    const auto to_ns = [&](std::uint64_t ticks) { return static_cast<double>(static_cast<std::int64_t>(ticks - anchor_ticks)) * zp::clock::calibration().ns_per_tick; };
+    const int pid    = static_cast<int>(getpid());
+
+    // =================================================================================================
+    // =================================================================================================
+    // Chrome trace JSON: one complete ("X") event per zone plus a thread_name record per thread. Times are microseconds since the
+    // first thread registered.
+    // =================================================================================================
+    // =================================================================================================
+    std::string out;
+    if (format == Format::CHROME_JSON)
+    {
+        out              = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool first_event = true;
+        char number[160];
+        for (const Snapshot& snapshot : snapshots)
+        {
+            std::snprintf(number, sizeof(number), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":", first_event ? "" : ",", pid, snapshot.tid);
+            out += number;
+            append_json_string(&out, snapshot.name);
+            out        += "}}";
+            first_event = false;
+
+            for (const Event& event : snapshot.events)
+            {
+                const double begin_us = to_ns(event.begin) / 1000.0;
+                const double dur_us   = std::max(0.0, to_ns(event.end) / 1000.0 - begin_us);
+                out                  += ",{\"name\":";
+                append_json_string(&out, event.name);
+                std::snprintf(number, sizeof(number), ",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", pid, snapshot.tid, begin_us, dur_us);
+                out += number;
+            }
+        }
+        out += "]}\n";
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Perfetto: a track descriptor per thread, then SLICE_BEGIN/SLICE_END packets in nesting order. At equal timestamps ends come
+    // before begins, outer zones begin first and inner zones end first.
+    // =================================================================================================
+    // =================================================================================================
+    else
+    {
+        std::string packet;
+        std::string message;
+        std::string nested;
+        std::vector<Edge> edges;
+        bool first_packet = true;
+
+        for (std::size_t t = 0; t < snapshots.size(); ++t)
+        {
+            const Snapshot& snapshot = snapshots[t];
+            const std::uint64_t uuid = t + 1;
+
+            nested.clear();
+            append_uint(&nested, THREAD_DESCRIPTOR_PID, static_cast<std::uint64_t>(pid));
+            append_uint(&nested, THREAD_DESCRIPTOR_TID, snapshot.tid);
+            append_bytes(&nested, THREAD_DESCRIPTOR_NAME, snapshot.name);
+            message.clear();
+            append_uint(&message, TRACK_DESCRIPTOR_UUID, uuid);
+            append_bytes(&message, TRACK_DESCRIPTOR_THREAD, nested);
+            packet.clear();
+            append_bytes(&packet, PACKET_TRACK_DESCRIPTOR, message);
+            append_bytes(&out, TRACE_PACKET, packet);
+
+            edges.clear();
+            for (const Event& event : snapshot.events)
+            {
+                const std::uint64_t end = std::max(event.end, event.begin);
+                edges.push_back({event.begin, end - event.begin, event.name, true});
+                edges.push_back({end, end - event.begin, event.name, false});
+            }
+            std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b)
+            {
+                if (a.ticks != b.ticks)
+                {
+                    return a.ticks < b.ticks;
+                }
+                if (a.begin != b.begin)
+                {
+                    return !a.begin;
+                }
+                return a.begin ? a.duration > b.duration : a.duration < b.duration;
+            });
+
+            for (const Edge& edge : edges)
+            {
+                message.clear();
+                append_uint(&message, TRACK_EVENT_TYPE, edge.begin ? TYPE_SLICE_BEGIN : TYPE_SLICE_END);
+                append_uint(&message, TRACK_EVENT_TRACK_UUID, uuid);
+                if (edge.begin)
+                {
+                    append_bytes(&message, TRACK_EVENT_NAME, edge.name);
+                }
+                packet.clear();
+                append_uint(&packet, PACKET_TIMESTAMP, zp::clock::ticks_to_ns(edge.ticks));
+                append_uint(&packet, PACKET_SEQUENCE_ID, SEQUENCE_ID);
+                if (first_packet)
+                {
+                    append_uint(&packet, PACKET_SEQUENCE_FLAGS, SEQ_INCREMENTAL_STATE_CLEARED);
+                    first_packet = false;
+                }
+                append_bytes(&packet, PACKET_TRACK_EVENT, message);
+                append_bytes(&out, TRACE_PACKET, packet);
+            }
+        }
+    }
+
+    return files::write_file(path, span<const std::byte>{reinterpret_cast<const std::byte*>(out.data()), out.size()});
+}
@@ -0,0 +1,275 @@
+#include "zp_cpp/stats.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // append_raw: Appends the bytes of a trivially copyable value.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    template <typename T> void append_raw(std::vector<std::byte>* p_out, const T& value)
+    {
+        const std::byte* p_bytes = reinterpret_cast<const std::byte*>(&value);
+        p_out->insert(p_out->end(), p_bytes, p_bytes + sizeof(value));
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // read_raw: Reads a trivially copyable value, failing when fewer than sizeof(T) bytes remain.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    template <typename T> bool read_raw(const std::byte** pp, const std::byte* p_end, T* p_value)
+    {
+        if (static_cast<std::size_t>(p_end - *pp) < sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(p_value, *pp, sizeof(T));
+        *pp += sizeof(T);
+        return true;
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // add_relaxed: Adds to a counter only the merging thread writes.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void add_relaxed(std::atomic<std::uint64_t>* p_counter, std::uint64_t value)
+    {
+        p_counter->store(p_counter->load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // merge_extremes: Widens p_state's min and max to cover another histogram's.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void merge_extremes(zp::stats::histogram::State* p_state, std::uint64_t min, std::uint64_t max)
+    {
+        if (min < p_state->min.load(std::memory_order_relaxed))
+        {
+            p_state->min.store(min, std::memory_order_relaxed);
+        }
+        if (max > p_state->max.load(std::memory_order_relaxed))
+        {
+            p_state->max.store(max, std::memory_order_relaxed);
+        }
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// reset: Clears every count.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::stats::reset(histogram* p_histogram) noexcept
+{
+    histogram::State* p_state = &p_histogram->state;
+    for (std::atomic<std::uint64_t>& count : p_state->counts)
+    {
+        count.store(0, std::memory_order_relaxed);
+    }
+    p_state->total.store(0, std::memory_order_relaxed);
+    p_state->sum.store(0, std::memory_order_relaxed);
+    p_state->min.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+    p_state->max.store(0, std::memory_order_relaxed);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// merge: Adds every count of p_from into p_into.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::stats::merge(histogram* p_into, const histogram* p_from) noexcept
+{
+    histogram::State* p_state    = &p_into->state;
+    const histogram::State& from = p_from->state;
+    std::uint64_t total          = 0;
+    for (std::uint32_t i = 0; i < HISTOGRAM_BUCKETS; ++i)
+    {
+        const std::uint64_t count = from.counts[i].load(std::memory_order_relaxed);
+        if (count != 0)
+        {
+            add_relaxed(&p_state->counts[i], count);
+            total += count;
+        }
+    }
+
+    // the bucket counts are authoritative: the recorder may have moved on since they were read, so total follows them.
+    add_relaxed(&p_state->total, total);
+    add_relaxed(&p_state->sum, from.sum.load(std::memory_order_relaxed));
+    merge_extremes(p_state, from.min.load(std::memory_order_relaxed), from.max.load(std::memory_order_relaxed));
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// value_at_percentile: Walks the buckets until the running count covers the requested rank.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::uint64_t zp::stats::value_at_percentile(const histogram* p_histogram, double percentile) noexcept
+{
+    const histogram::State& state = p_histogram->state;
+    const std::uint64_t total     = state.total.load(std::memory_order_relaxed);
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    const double clamped     = std::clamp(percentile, 0.0, 100.0);
+    const std::uint64_t rank = std::max<std::uint64_t>(static_cast<std::uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(total))), 1);
+    const std::uint64_t max  = state.max.load(std::memory_order_relaxed);
+    std::uint64_t seen       = 0;
+    for (std::uint32_t i = 0; i < HISTOGRAM_BUCKETS; ++i)
+    {
+        seen += state.counts[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            std::uint32_t shift        = 0;
+            const std::uint64_t lowest = bucket_lowest(i, &shift);
+            return std::min(lowest + (std::uint64_t(1) << shift) - 1, max);
+        }
+    }
+    return max;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// summarize: Count, extremes, mean and the usual tail percentiles.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::stats::Summary zp::stats::summarize(const histogram* p_histogram) noexcept
+{
+    const histogram::State& state = p_histogram->state;
+    Summary summary               = {};
+    summary.count                 = state.total.load(std::memory_order_relaxed);
+    if (summary.count == 0)
+    {
+        return summary;
+    }
+
+    summary.min  = state.min.load(std::memory_order_relaxed);
+    summary.max  = state.max.load(std::memory_order_relaxed);
+    summary.mean = static_cast<double>(state.sum.load(std::memory_order_relaxed)) / static_cast<double>(summary.count);
+    summary.p50  = value_at_percentile(p_histogram, 50.0);
+    summary.p90  = value_at_percentile(p_histogram, 90.0);
+    summary.p99  = value_at_percentile(p_histogram, 99.0);
+    summary.p999 = value_at_percentile(p_histogram, 99.9);
+    return summary;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// serialize: u32 magic, u32 version, u32 sub bits, u32 value bits, u64 total, u64 sum, u64 min, u64 max, u32 bucket count, then
+// (u32 index, u64 count) for each non-empty bucket. Native byte order.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::stats::serialize(const histogram* p_histogram, std::vector<std::byte>* p_out)
+{
+    const histogram::State& state = p_histogram->state;
+    std::uint32_t buckets         = 0;
+    std::uint64_t total           = 0;
+    for (const std::atomic<std::uint64_t>& count : state.counts)
+    {
+        const std::uint64_t value = count.load(std::memory_order_relaxed);
+        buckets                  += value != 0;
+        total                    += value;
+    }
+
+    append_raw(p_out, HISTOGRAM_MAGIC);
+    append_raw(p_out, HISTOGRAM_VERSION);
+    append_raw(p_out, HISTOGRAM_SUB_BITS);
+    append_raw(p_out, HISTOGRAM_VALUE_BITS);
+    append_raw(p_out, total);
+    append_raw(p_out, state.sum.load(std::memory_order_relaxed));
+    append_raw(p_out, state.min.load(std::memory_order_relaxed));
+    append_raw(p_out, state.max.load(std::memory_order_relaxed));
+    append_raw(p_out, buckets);
+    for (std::uint32_t i = 0; i < HISTOGRAM_BUCKETS && buckets != 0; ++i)
+    {
+        const std::uint64_t count = state.counts[i].load(std::memory_order_relaxed);
+        if (count != 0)
+        {
+            append_raw(p_out, i);
+            append_raw(p_out, count);
+            --buckets;
+        }
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// deserialize: Validates the whole encoding before adding anything to p_into.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::Result zp::stats::deserialize(span<const std::byte> data, histogram* p_into)
+{
+    const std::byte* p       = data.p;
+    const std::byte* p_end   = data.p + data.count;
+    std::uint32_t magic      = 0;
+    std::uint32_t version    = 0;
+    std::uint32_t sub_bits   = 0;
+    std::uint32_t value_bits = 0;
+    std::uint64_t total      = 0;
+    std::uint64_t sum        = 0;
+    std::uint64_t min        = 0;
+    std::uint64_t max        = 0;
+    std::uint32_t buckets    = 0;
+    if (!read_raw(&p, p_end, &magic) || !read_raw(&p, p_end, &version) || !read_raw(&p, p_end, &sub_bits) || !read_raw(&p, p_end, &value_bits) || !read_raw(&p, p_end, &total) || !read_raw(&p, p_end, &sum) || !read_raw(&p, p_end, &min) || !read_raw(&p, p_end, &max) || !read_raw(&p, p_end, &buckets))
+    {
+        return Result::ZC_INVALID_FORMAT;
+    }
+    if (magic != HISTOGRAM_MAGIC || version != HISTOGRAM_VERSION || sub_bits != HISTOGRAM_SUB_BITS || value_bits != HISTOGRAM_VALUE_BITS || buckets > HISTOGRAM_BUCKETS)
+    {
+        return Result::ZC_INVALID_FORMAT;
+    }
+    if (static_cast<std::size_t>(p_end - p) != static_cast<std::size_t>(buckets) * (sizeof(std::uint32_t) + sizeof(std::uint64_t)))
+    {
+        return Result::ZC_INVALID_FORMAT;
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Every index must be in range and the counts must add up to total.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        const std::byte* p_check = p;
+        std::uint64_t counted    = 0;
+        for (std::uint32_t b = 0; b < buckets; ++b)
+        {
+            std::uint32_t index = 0;
+            std::uint64_t count = 0;
+            read_raw(&p_check, p_end, &index);
+            read_raw(&p_check, p_end, &count);
+            if (index >= HISTOGRAM_BUCKETS)
+            {
+                return Result::ZC_INVALID_FORMAT;
+            }
+            counted += count;
+        }
+        if (counted != total)
+        {
+            return Result::ZC_INVALID_FORMAT;
+        }
+    }
+
+    histogram::State* p_state = &p_into->state;
+    for (std::uint32_t b = 0; b < buckets; ++b)
+    {
+        std::uint32_t index = 0;
+        std::uint64_t count = 0;
+        read_raw(&p, p_end, &index);
+        read_raw(&p, p_end, &count);
+        add_relaxed(&p_state->counts[index], count);
+    }
+    add_relaxed(&p_state->total, total);
+    add_relaxed(&p_state->sum, sum);
+    if (total != 0)
+    {
+        merge_extremes(p_state, min, max);
+    }
+    return Result::ZC_SUCCESS;
+}
@@ -0,0 +1,316 @@
+#include "zp_cpp/task_graph.hpp"
+#include "zp_cpp/jobs.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    constexpr std::uint32_t NO_TASK = ~0u;
+
+    // weight of the newest run in a task's smoothed cost, so one slow frame nudges priorities instead of flipping them.
+    constexpr double COST_SMOOTHING = 0.25;
+}
+
+struct zp::task_graph::State::Internal
+{
+    struct Task
+    {
+        const char* name;
+        small_function<void()> work;
+        std::vector<TaskResource> reads;
+        std::vector<TaskResource> writes;
+        std::vector<std::uint32_t> successors; // most urgent first.
+        std::uint32_t predecessors = 0;
+        ens last_ns                = 0;   // run time in the last run.
+        ens path_ns                = 0;   // last_ns plus the longest chain of successors' last_ns behind it.
+        double cost_ns             = 1.0; // smoothed run time.
+        double priority_ns         = 0.0; // cost_ns plus the longest chain of successors' cost_ns behind it.
+    };
+
+    std::vector<const char*> resources;
+    std::vector<Task> tasks;
+    std::vector<std::uint32_t> roots; // tasks without predecessors, most urgent first.
+    std::unique_ptr<std::atomic<std::uint32_t>[]> pending;
+    jobs::counter done;
+};
+
+namespace
+{
+    // =============================================================================================================================
+    // =============================================================================================================================
+    // sort_by_priority: Orders task indices most urgent first. In place, so re-prioritising every run allocates nothing.
+    // =============================================================================================================================
+    // =============================================================================================================================
+    void sort_by_priority(const zp::task_graph::State::Internal* p_i, std::vector<std::uint32_t>* p_indices)
+    {
+        std::sort(p_indices->begin(), p_indices->end(), [p_i](std::uint32_t a, std::uint32_t b) { return p_i->tasks[a].priority_ns > p_i->tasks[b].priority_ns; });
+    }
+
+    // =============================================================================================================================
+    // =============================================================================================================================
+    // update_priorities: Folds the last run's times into each task's cost and recomputes the critical paths, walking tasks in
+    // reverse declaration order so every successor is done before its predecessors.
+    // =============================================================================================================================
+    // =============================================================================================================================
+    zp::ens update_priorities(zp::task_graph::State::Internal* p_i, bool first_run)
+    {
+        zp::ens critical_path_ns = 0;
+        for (std::size_t i = p_i->tasks.size(); i-- > 0;)
+        {
+            zp::task_graph::State::Internal::Task& task = p_i->tasks[i];
+            task.cost_ns                                = first_run ? static_cast<double>(task.last_ns) : task.cost_ns + COST_SMOOTHING * (static_cast<double>(task.last_ns) - task.cost_ns);
+
+            double longest_priority                     = 0.0;
+            zp::ens longest_path                        = 0;
+            for (const std::uint32_t successor : task.successors)
+            {
+                longest_priority = std::max(longest_priority, p_i->tasks[successor].priority_ns);
+                longest_path     = std::max(longest_path, p_i->tasks[successor].path_ns);
+            }
+            task.priority_ns = task.cost_ns + longest_priority;
+            task.path_ns     = task.last_ns + longest_path;
+            critical_path_ns = std::max(critical_path_ns, task.path_ns);
+        }
+
+        for (zp::task_graph::State::Internal::Task& task : p_i->tasks)
+        {
+            sort_by_priority(p_i, &task.successors);
+        }
+        sort_by_priority(p_i, &p_i->roots);
+        return critical_path_ns;
+    }
+
+    // =============================================================================================================================
+    // =============================================================================================================================
+    // run_task: Runs a task, then releases its successors. The most urgent one that became ready runs next on this thread;
+    // the others are queued in priority order, so thieves, which take the oldest job first, start with the next most urgent.
+    // =============================================================================================================================
+    // =============================================================================================================================
+    void run_task(zp::task_graph::State::Internal* p_i, std::uint32_t index)
+    {
+        while (index != NO_TASK)
+        {
+            zp::task_graph::State::Internal::Task& task = p_i->tasks[index];
+            const zp::ens start                         = zp::clock::fast_ns();
+            task.work();
+            task.last_ns = zp::clock::fast_ns() - start;
+
+            index        = NO_TASK;
+            for (const std::uint32_t successor : task.successors)
+            {
+                if (p_i->pending[successor].fetch_sub(1, std::memory_order_acq_rel) != 1)
+                {
+                    continue;
+                }
+                if (index == NO_TASK)
+                {
+                    index = successor;
+                }
+                else
+                {
+                    zp::jobs::run([p_i, successor]() { run_task(p_i, successor); }, &p_i->done);
+                }
+            }
+        }
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// graph_init: Allocates an empty graph.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::graph_init(task_graph* p_graph)
+{
+    p_graph->state.p_i = new task_graph::State::Internal();
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// graph_exit: Releases the graph and its tasks.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::graph_exit(task_graph* p_graph)
+{
+    delete p_graph->state.p_i;
+    p_graph->state.p_i = nullptr;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// graph_resource: A new resource handle.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::TaskResource zp::graph_resource(task_graph* p_graph, const char* name)
+{
+    p_graph->state.p_i->resources.push_back(name);
+    return static_cast<TaskResource>(p_graph->state.p_i->resources.size() - 1);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// graph_add: Declares a task and returns its index.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::uint32_t zp::graph_add(task_graph* p_graph, const char* name, small_function<void()> work, std::initializer_list<TaskResource> reads, std::initializer_list<TaskResource> writes)
+{
+    task_graph::State::Internal::Task task;
+    task.name   = name;
+    task.work   = std::move(work);
+    task.reads  = reads;
+    task.writes = writes;
+    p_graph->state.p_i->tasks.push_back(std::move(task));
+    return static_cast<std::uint32_t>(p_graph->state.p_i->tasks.size() - 1);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// graph_compile: Walks the tasks in declaration order tracking each resource's last writer and the readers since, and links
+// every task after the ones it conflicts with. Priorities start as chain lengths until the first run has timings.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::graph_compile(task_graph* p_graph)
+{
+    task_graph::State::Internal* p_i = p_graph->state.p_i;
+
+    // ====================================================================================================
+    // ====================================================================================================
+    // Derive the edges: read-after-write, write-after-write and write-after-read.
+    // ====================================================================================================
+    // ====================================================================================================
+    {
+        std::vector<std::uint32_t> last_writer(p_i->resources.size(), NO_TASK);
+        std::vector<std::vector<std::uint32_t>> readers(p_i->resources.size());
+        std::vector<std::uint32_t> before;
+        for (std::uint32_t i = 0; i < p_i->tasks.size(); ++i)
+        {
+            task_graph::State::Internal::Task& task = p_i->tasks[i];
+            before.clear();
+            for (const TaskResource read : task.reads)
+            {
+                if (last_writer[read] != NO_TASK)
+                {
+                    before.push_back(last_writer[read]);
+                }
+            }
+            for (const TaskResource write : task.writes)
+            {
+                if (last_writer[write] != NO_TASK)
+                {
+                    before.push_back(last_writer[write]);
+                }
+                before.insert(before.end(), readers[write].begin(), readers[write].end());
+            }
+
+            std::sort(before.begin(), before.end());
+            before.erase(std::unique(before.begin(), before.end()), before.end());
+            for (const std::uint32_t predecessor : before)
+            {
+                p_i->tasks[predecessor].successors.push_back(i);
+            }
+            task.predecessors = static_cast<std::uint32_t>(before.size());
+            if (before.empty())
+            {
+                p_i->roots.push_back(i);
+            }
+
+            for (const TaskResource read : task.reads)
+            {
+                readers[read].push_back(i);
+            }
+            for (const TaskResource write : task.writes)
+            {
+                last_writer[write] = i;
+                readers[write].clear();
+            }
+        }
+    }
+
+    // ====================================================================================================
+    // ====================================================================================================
+    // Size the per-run counters and rank tasks by chain length.
+    // ====================================================================================================
+    // ====================================================================================================
+    {
+        p_i->pending.reset(new std::atomic<std::uint32_t>[p_i->tasks.size()]());
+        for (task_graph::State::Internal::Task& task : p_i->tasks)
+        {
+            task.last_ns = 1;
+        }
+        update_priorities(p_i, true);
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// graph_run: Resets the dependency counts, starts the roots and helps run tasks until all are done, then reprioritises from
+// this run's timings.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::graph_run(task_graph* p_graph)
+{
+    task_graph::State::Internal* p_i = p_graph->state.p_i;
+    if (p_i->tasks.empty())
+    {
+        return;
+    }
+
+    if (jobs::worker_count() == 1)
+    {
+        for (task_graph::State::Internal::Task& task : p_i->tasks)
+        {
+            const ens start = clock::fast_ns();
+            task.work();
+            task.last_ns    = clock::fast_ns() - start;
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < p_i->tasks.size(); ++i)
+        {
+            p_i->pending[i].store(p_i->tasks[i].predecessors, std::memory_order_relaxed);
+        }
+        for (std::size_t r = 1; r < p_i->roots.size(); ++r)
+        {
+            jobs::run([p_i, root = p_i->roots[r]]() { run_task(p_i, root); }, &p_i->done);
+        }
+        run_task(p_i, p_i->roots[0]);
+        jobs::wait(&p_i->done);
+    }
+
+    p_graph->state.critical_path_ns = update_priorities(p_i, p_graph->state.runs == 0);
+    ++p_graph->state.runs;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// graph_depends_on: Searches forward from before for task.
+// =========================================================================================================================================
+// =========================================================================================================================================
+bool zp::graph_depends_on(const task_graph* p_graph, std::uint32_t task, std::uint32_t before)
+{
+    const task_graph::State::Internal* p_i = p_graph->state.p_i;
+    std::vector<bool> visited(p_i->tasks.size(), false);
+    std::vector<std::uint32_t> stack       = {before};
+    while (!stack.empty())
+    {
+        const std::uint32_t index = stack.back();
+        stack.pop_back();
+        for (const std::uint32_t successor : p_i->tasks[index].successors)
+        {
+            if (successor == task)
+            {
+                return true;
+            }
+            if (!visited[successor])
+            {
+                visited[successor] = true;
+                stack.push_back(successor);
+            }
+        }
+    }
+    return false;
+}
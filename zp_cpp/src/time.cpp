@@ -1,16 +1,77 @@
 #include "zp_cpp/time.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // virtual clock behind use_virtual_clock. reads are virtual_base_ns + (fast_ns() - real_base_ns) * rate, and every change
+    // rebases both ends at the current reading so the clock never goes backwards.
+    struct VirtualClock
+    {
+        std::mutex mutex;
+        zp::ens virtual_base_ns = 0;
+        zp::ens real_base_ns    = 0;
+        double rate             = 0.0;
+    };
+
+    VirtualClock g_virtual;
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // virtual_now_locked: Current virtual time. Caller holds g_virtual.mutex.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    zp::ens virtual_now_locked()
+    {
+        if (g_virtual.rate == 0.0)
+        {
+            return g_virtual.virtual_base_ns;
+        }
+        return g_virtual.virtual_base_ns + static_cast<zp::ens>(static_cast<double>(zp::clock::fast_ns() - g_virtual.real_base_ns) * g_virtual.rate);
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // rebase_locked: Restarts the virtual clock's real-time scaling from virtual_ns. Caller holds g_virtual.mutex.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    void rebase_locked(zp::ens virtual_ns)
+    {
+        g_virtual.virtual_base_ns = virtual_ns;
+        g_virtual.real_base_ns    = zp::clock::fast_ns();
+    }
+
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    // virtual_source: The clock::SourceFn installed by use_virtual_clock.
+    // =========================================================================================================================================
+    // =========================================================================================================================================
+    zp::ens virtual_source() noexcept
+    {
+        std::lock_guard<std::mutex> lock(g_virtual.mutex);
+        return virtual_now_locked();
+    }
+}
 
 // =========================================================================================================================================
 // =========================================================================================================================================
-// now: Returns the current system time in nanoseconds since epoch.
+// now: Returns clock::now_ns from the active clock source.
 // =========================================================================================================================================
 // =========================================================================================================================================
 zp::ens zp::now()
 {
-    using namespace std::chrono;
-    return (ens)duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+    return clock::now_ns();
 }
 
 // =========================================================================================================================================
@@ -24,3 +85,177 @@ float zp::calc_interp(ens started, ens now, ens dur)
     ens in_cycle = elapsed % dur;
     return float(in_cycle) / float(dur);
 }
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// calibrate: Pairs a tick reading with steady_ns at both ends of a CALIBRATION_NS spin. Each pair keeps the tightest of a few
+// tick-bracketed clock reads, so a preemption between the two reads cannot skew the rate.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::clock::Calibration zp::clock::calibrate()
+{
+    // =================================================================================================
+    // =================================================================================================
+    // Only an invariant TSC ticks at a constant rate through frequency changes and sleep states.
+    // =================================================================================================
+    // =================================================================================================
+    bool is_invariant = false;
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        int regs[4] = {};
+        __cpuid(regs, static_cast<int>(0x80000000));
+        if (static_cast<unsigned int>(regs[0]) >= 0x80000007)
+        {
+            __cpuid(regs, static_cast<int>(0x80000007));
+            is_invariant = (regs[3] & (1 << 8)) != 0;
+        }
+#elif defined(__x86_64__) || defined(__i386__)
+        unsigned int eax = 0;
+        unsigned int ebx = 0;
+        unsigned int ecx = 0;
+        unsigned int edx = 0;
+        is_invariant     = __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) && (edx & (1u << 8)) != 0;
+#endif
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Bracket steady_ns with tick reads at both ends of the spin.
+    // =================================================================================================
+    // =================================================================================================
+    std::uint64_t start_tick = 0;
+    ens start_ns             = 0;
+    std::uint64_t end_tick   = 0;
+    ens end_ns               = 0;
+    {
+        const auto sample = [](std::uint64_t* p_tick, ens* p_ns)
+        {
+            std::uint64_t best = std::numeric_limits<std::uint64_t>::max();
+            for (int i = 0; i < 8; ++i)
+            {
+                const std::uint64_t before = ticks_ordered();
+                const ens ns               = steady_ns();
+                const std::uint64_t after  = ticks_ordered();
+                if (after - before < best)
+                {
+                    best    = after - before;
+                    *p_tick = before + (after - before) / 2;
+                    *p_ns   = ns;
+                }
+            }
+        };
+
+        sample(&start_tick, &start_ns);
+        while (steady_ns() - start_ns < CALIBRATION_NS)
+        {
+        }
+        sample(&end_tick, &end_ns);
+    }
+
+    const double ns_per_tick = static_cast<double>(end_ns - start_ns) / static_cast<double>(std::max<std::uint64_t>(end_tick - start_tick, 1));
+    return Calibration{end_tick, end_ns, ns_per_tick, is_invariant};
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// set_source: Installs a clock source for now_ns, or restores fast_ns with nullptr.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::clock::set_source(SourceFn p_source)
+{
+    g_source.store(p_source, std::memory_order_release);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// sleep_until: Waits until now_ns reaches deadline_ns, in whatever way the active source allows.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::clock::sleep_until(ens deadline_ns, ens spin_ns)
+{
+    const SourceFn p_source = g_source.load(std::memory_order_acquire);
+
+    // =================================================================================================
+    // =================================================================================================
+    // Real clock: sleep most of the wait, then spin the rest against fast_ns.
+    // =================================================================================================
+    // =================================================================================================
+    if (p_source == nullptr)
+    {
+        const ens now = fast_ns();
+        if (deadline_ns > now && deadline_ns - now > spin_ns)
+        {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(deadline_ns - now - spin_ns));
+        }
+        while (fast_ns() < deadline_ns)
+        {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+            _mm_pause();
+#else
+            std::this_thread::yield();
+#endif
+        }
+        return;
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Virtual clock: a manual one jumps to the deadline; a scaled one sleeps the gap divided by its rate.
+    // =================================================================================================
+    // =================================================================================================
+    if (p_source == &virtual_source)
+    {
+        ens real_wait_ns = 0;
+        {
+            std::lock_guard<std::mutex> lock(g_virtual.mutex);
+            const ens now = virtual_now_locked();
+            if (now >= deadline_ns)
+            {
+                return;
+            }
+            if (g_virtual.rate == 0.0)
+            {
+                rebase_locked(deadline_ns);
+                return;
+            }
+            real_wait_ns = static_cast<ens>(static_cast<double>(deadline_ns - now) / g_virtual.rate);
+        }
+        std::this_thread::sleep_for(std::chrono::nanoseconds(real_wait_ns));
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Any source: poll until it reaches the deadline.
+    // =================================================================================================
+    // =================================================================================================
+    while (now_ns() < deadline_ns)
+    {
+        std::this_thread::yield();
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// use_virtual_clock: Resets the virtual clock to start_ns at the given rate and installs it as the source.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::clock::use_virtual_clock(ens start_ns, double rate)
+{
+    {
+        std::lock_guard<std::mutex> lock(g_virtual.mutex);
+        g_virtual.rate = std::max(rate, 0.0);
+        rebase_locked(start_ns);
+    }
+    set_source(&virtual_source);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// advance_virtual_clock: Moves the virtual clock forward by delta_ns, keeping its rate.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::clock::advance_virtual_clock(ens delta_ns)
+{
+    std::lock_guard<std::mutex> lock(g_virtual.mutex);
+    rebase_locked(virtual_now_locked() + delta_ns);
+}
@@ -0,0 +1,304 @@
+#include "zp_cpp/timer_wheel.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <vector>
+
+struct zp::timer_wheel::State::Internal
+{
+    struct Node
+    {
+        std::function<void()> callback;
+        std::uint64_t expiry; // absolute tick.
+        std::uint32_t prev;
+        std::uint32_t next;
+        std::uint32_t generation;
+        std::uint32_t* p_list; // head of the slot holding the node; nullptr while the node is free.
+    };
+
+    std::vector<Node> nodes;
+    std::uint32_t free_head;
+    std::uint32_t slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    std::size_t bottom_count; // timers in level 0. while it is zero, advance jumps straight to the next cascade.
+    std::size_t pending;
+    ens origin_ns;
+    ens now_ns;
+    std::uint64_t current; // last tick processed.
+};
+
+namespace
+{
+    using Internal                    = zp::timer_wheel::State::Internal;
+
+    constexpr std::uint32_t NIL       = std::numeric_limits<std::uint32_t>::max();
+    constexpr std::uint64_t SLOT_MASK = zp::TIMER_WHEEL_SLOTS - 1;
+    constexpr std::uint64_t SPAN      = std::uint64_t(1) << (zp::TIMER_WHEEL_LEVELS * zp::TIMER_WHEEL_SLOT_BITS);
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // link: Files a node under the level whose slot width fits its distance from the current tick. Nodes beyond the wheel's span
+    // park in the top-level slot that cascades last and are re-filed from there.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void link(Internal* p_i, std::uint32_t index)
+    {
+        Internal::Node* p_node    = &p_i->nodes[index];
+        const std::uint64_t delta = p_node->expiry - p_i->current;
+
+        std::uint32_t* p_list     = nullptr;
+        if (delta >= SPAN)
+        {
+            constexpr std::uint32_t TOP = zp::TIMER_WHEEL_LEVELS - 1;
+            p_list                      = &p_i->slots[TOP][((p_i->current >> (TOP * zp::TIMER_WHEEL_SLOT_BITS)) + SLOT_MASK) & SLOT_MASK];
+        }
+        else
+        {
+            const std::uint32_t level = delta == 0 ? 0 : static_cast<std::uint32_t>(std::bit_width(delta) - 1) / zp::TIMER_WHEEL_SLOT_BITS;
+            p_list                    = &p_i->slots[level][(p_node->expiry >> (level * zp::TIMER_WHEEL_SLOT_BITS)) & SLOT_MASK];
+            p_i->bottom_count        += level == 0;
+        }
+
+        p_node->prev   = NIL;
+        p_node->next   = *p_list;
+        p_node->p_list = p_list;
+        if (*p_list != NIL)
+        {
+            p_i->nodes[*p_list].prev = index;
+        }
+        *p_list = index;
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // unlink: Takes a node out of whichever slot holds it.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void unlink(Internal* p_i, std::uint32_t index)
+    {
+        Internal::Node* p_node = &p_i->nodes[index];
+        if (p_node->prev != NIL)
+        {
+            p_i->nodes[p_node->prev].next = p_node->next;
+        }
+        else
+        {
+            *p_node->p_list = p_node->next;
+        }
+        if (p_node->next != NIL)
+        {
+            p_i->nodes[p_node->next].prev = p_node->prev;
+        }
+
+        if (p_node->p_list >= p_i->slots[0] && p_node->p_list < p_i->slots[0] + zp::TIMER_WHEEL_SLOTS)
+        {
+            --p_i->bottom_count;
+        }
+        p_node->p_list = nullptr;
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // release: Returns an unlinked node to the free list. Bumping the generation invalidates every TimerId handed out for it.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void release(Internal* p_i, std::uint32_t index)
+    {
+        Internal::Node* p_node = &p_i->nodes[index];
+        p_node->callback       = nullptr;
+        p_node->generation     = p_node->generation == NIL ? 1 : p_node->generation + 1;
+        p_node->next           = p_i->free_head;
+        p_i->free_head         = index;
+        --p_i->pending;
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// wheel_init: Allocates the wheel's slots with tick 0 at now_ns.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::wheel_init(timer_wheel* p_wheel, ens now_ns)
+{
+    Internal* p_i     = new Internal();
+    p_i->free_head    = NIL;
+    p_i->bottom_count = 0;
+    p_i->pending      = 0;
+    p_i->origin_ns    = now_ns;
+    p_i->now_ns       = now_ns;
+    p_i->current      = 0;
+    for (std::uint32_t (&level)[TIMER_WHEEL_SLOTS] : p_i->slots)
+    {
+        std::fill(std::begin(level), std::end(level), NIL);
+    }
+
+    p_wheel->config.tick_ns = std::max<ens>(p_wheel->config.tick_ns, 1);
+    p_wheel->state.p_i      = p_i;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// wheel_exit: Drops every pending timer without running it and releases the wheel.
+// =========================================================================================================================================
+// =========================================================================================================================================
+void zp::wheel_exit(timer_wheel* p_wheel)
+{
+    delete p_wheel->state.p_i;
+    p_wheel->state.p_i = nullptr;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// wheel_schedule_at: Rounds the deadline up to a tick strictly after the current one and files a node for it.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::TimerId zp::wheel_schedule_at(timer_wheel* p_wheel, ens deadline_ns, std::function<void()> callback)
+{
+    Internal* p_i       = p_wheel->state.p_i;
+    const ens tick_ns   = p_wheel->config.tick_ns;
+    const ens since     = deadline_ns > p_i->origin_ns ? deadline_ns - p_i->origin_ns : 0;
+    std::uint32_t index = NIL;
+    if (p_i->free_head != NIL)
+    {
+        index          = p_i->free_head;
+        p_i->free_head = p_i->nodes[index].next;
+    }
+    else
+    {
+        index = static_cast<std::uint32_t>(p_i->nodes.size());
+        p_i->nodes.push_back({nullptr, 0, NIL, NIL, 1, nullptr});
+    }
+
+    Internal::Node* p_node = &p_i->nodes[index];
+    p_node->callback       = std::move(callback);
+    p_node->expiry         = std::max<std::uint64_t>(since / tick_ns + (since % tick_ns != 0), p_i->current + 1);
+    link(p_i, index);
+    ++p_i->pending;
+
+    return (static_cast<TimerId>(p_node->generation) << 32) | index;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// wheel_schedule_after: wheel_schedule_at relative to the time of the last advance.
+// =========================================================================================================================================
+// =========================================================================================================================================
+zp::TimerId zp::wheel_schedule_after(timer_wheel* p_wheel, ens delay_ns, std::function<void()> callback)
+{
+    return wheel_schedule_at(p_wheel, p_wheel->state.p_i->now_ns + delay_ns, std::move(callback));
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// wheel_cancel: Validates the id's generation against its node before unlinking it.
+// =========================================================================================================================================
+// =========================================================================================================================================
+bool zp::wheel_cancel(timer_wheel* p_wheel, TimerId id)
+{
+    Internal* p_i             = p_wheel->state.p_i;
+    const std::uint32_t index = static_cast<std::uint32_t>(id);
+    const std::uint32_t gen   = static_cast<std::uint32_t>(id >> 32);
+    if (index >= p_i->nodes.size() || p_i->nodes[index].generation != gen || p_i->nodes[index].p_list == nullptr)
+    {
+        return false;
+    }
+
+    unlink(p_i, index);
+    release(p_i, index);
+    return true;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// wheel_advance: Steps tick by tick, cascading higher levels down at their boundaries and firing the bottom slot of each tick.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::size_t zp::wheel_advance(timer_wheel* p_wheel, ens now_ns)
+{
+    Internal* p_i = p_wheel->state.p_i;
+    if (now_ns <= p_i->now_ns)
+    {
+        return 0;
+    }
+    p_i->now_ns                = now_ns;
+
+    const std::uint64_t target = (now_ns - p_i->origin_ns) / p_wheel->config.tick_ns;
+    std::size_t fired          = 0;
+    while (p_i->current < target)
+    {
+        // =================================================================================================
+        // =================================================================================================
+        // With nothing in the bottom level the ticks up to the next cascade have nothing to fire.
+        // =================================================================================================
+        // =================================================================================================
+        {
+            if (p_i->bottom_count == 0)
+            {
+                const std::uint64_t boundary = (p_i->current | SLOT_MASK) + 1;
+                p_i->current                 = std::min(target, boundary);
+                if (p_i->current != boundary)
+                {
+                    break;
+                }
+            }
+            else
+            {
+                ++p_i->current;
+            }
+        }
+
+        // =================================================================================================
+        // =================================================================================================
+        // Cascade from the top down so a timer can fall through several levels in one tick.
+        // =================================================================================================
+        // =================================================================================================
+        {
+            for (std::uint32_t level = TIMER_WHEEL_LEVELS - 1; level > 0; --level)
+            {
+                const std::uint32_t shift = level * TIMER_WHEEL_SLOT_BITS;
+                if ((p_i->current & ((std::uint64_t(1) << shift) - 1)) != 0)
+                {
+                    continue;
+                }
+
+                std::uint32_t* p_list = &p_i->slots[level][(p_i->current >> shift) & SLOT_MASK];
+                while (*p_list != NIL)
+                {
+                    const std::uint32_t index = *p_list;
+                    unlink(p_i, index);
+                    link(p_i, index);
+                }
+            }
+        }
+
+        // =================================================================================================
+        // =================================================================================================
+        // Fire the tick's bottom slot. The node is freed before its callback runs, so the callback may reuse it.
+        // =================================================================================================
+        // =================================================================================================
+        {
+            std::uint32_t* p_list = &p_i->slots[0][p_i->current & SLOT_MASK];
+            while (*p_list != NIL)
+            {
+                const std::uint32_t index      = *p_list;
+                std::function<void()> callback = std::move(p_i->nodes[index].callback);
+                unlink(p_i, index);
+                release(p_i, index);
+                callback();
+                ++fired;
+            }
+        }
+    }
+
+    return fired;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// wheel_pending: Number of scheduled timers that have not fired or been cancelled.
+// =========================================================================================================================================
+// =========================================================================================================================================
+std::size_t zp::wheel_pending(const timer_wheel* p_wheel)
+{
+    return p_wheel->state.p_i->pending;
+}
@@ -1,5 +1,8 @@
+#define ZP_LOG_MODULE zp::log::MODULE_UI
+
 #include "zp_cpp/ui.hpp"
 #include "zp_cpp/dbg.hpp"
+#include "zp_cpp/prof.hpp"
 
 #include <algorithm>
 #include <functional>
@@ -93,6 +96,8 @@ void zp::ui::init(Instance* p_inst)
 // =========================================================================================================================================
 void zp::ui::update(Instance* p_inst)
 {
+    ZP_PROF_ZONE("ui::update");
+
     auto& t = p_inst->p_i->transient;
     t       = {};
 
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// replaces the global allocation functions so a test can assert a path never allocates. replacements cannot be inline, so include
+// this from exactly one translation unit of a test executable. aligned and nothrow forms keep their library definitions, which
+// pair with each other or forward to the counted ones.
+namespace zp::test
+{
+    inline std::atomic<std::size_t> allocations = 0;
+
+    inline void* counted_alloc(std::size_t size)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        void* p = std::malloc(size == 0 ? 1 : size);
+        if (p == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// operator new / new[]: Count the allocation, then take it from malloc. Kept out of line like the deletes below.
+// =========================================================================================================================================
+// =========================================================================================================================================
+[[gnu::noinline]] void* operator new(std::size_t size)
+{
+    return zp::test::counted_alloc(size);
+}
+
+[[gnu::noinline]] void* operator new[](std::size_t size)
+{
+    return zp::test::counted_alloc(size);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// operator delete / delete[]: Return the block to free. Every form is replaced so no library delete sees a malloc'd pointer. None of
+// the replacements is inlined: GCC would then see malloc or free behind a new or delete expression and warn
+// (-Wmismatched-new-delete).
+// =========================================================================================================================================
+// =========================================================================================================================================
+[[gnu::noinline]] void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "zp_cpp/core.hpp"
+#include "zp_cpp/compress.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// DecompressThroughput: Measures single-thread block decompression of 1 MiB text-like and structured binary inputs at both levels
+// against the 2 GB/s per core budget. Run on an optimized build without sanitizers.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(CompressBench, DecompressThroughput)
+{
+    std::mt19937 rng(1234);
+
+    std::vector<std::byte> text;
+    {
+        const char* words[] = {"the", "entity", "transform", "position", "velocity", "render", "pass", "\"id\":", "{", "}", "\n", "frame", "0.125", "true", "null"};
+        while (text.size() < 1 << 20)
+        {
+            const char* p_word = words[rng() % std::size(words)];
+            const std::byte* p = reinterpret_cast<const std::byte*>(p_word);
+            text.insert(text.end(), p, p + std::strlen(p_word));
+            text.push_back(std::byte{' '});
+        }
+    }
+
+    std::vector<std::byte> binary(1 << 20);
+    for (std::size_t i = 0; i + 16 <= binary.size(); i += 16)
+    {
+        const std::uint32_t record[4] = {static_cast<std::uint32_t>(i / 16), 0x3f800000u, static_cast<std::uint32_t>(i / 1024), static_cast<std::uint32_t>(rng() % 4)};
+        std::memcpy(binary.data() + i, record, sizeof(record));
+    }
+
+    for (const std::vector<std::byte>* p_src : {&text, &binary})
+    {
+        for (zp::compress::Level level : {zp::compress::Level::FAST, zp::compress::Level::HIGH})
+        {
+            std::vector<std::byte> compressed(zp::compress::compress_bound(p_src->size()));
+            std::vector<std::byte> decompressed(p_src->size());
+            zp::span<std::byte> packed;
+            zp::span<std::byte> unpacked;
+            ASSERT_EQ(zp::compress::compress_block({p_src->data(), p_src->size()}, {compressed.data(), compressed.size()}, level, &packed), zp::Result::ZC_SUCCESS);
+
+            constexpr int RUNS = 100;
+            const auto start   = std::chrono::steady_clock::now();
+            for (int run = 0; run < RUNS; ++run)
+            {
+                ASSERT_EQ(zp::compress::decompress_block({packed.p, packed.count}, {decompressed.data(), decompressed.size()}, &unpacked), zp::Result::ZC_SUCCESS);
+            }
+            const double seconds   = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / RUNS;
+            const double gb_per_s  = static_cast<double>(p_src->size()) / seconds / 1e9;
+            ASSERT_EQ(decompressed, *p_src);
+
+            const char* name       = p_src == &text ? "text" : "binary";
+            std::printf("%-6s %-4s ratio %.3f  decompress %.2f GB/s\n", name, level == zp::compress::Level::FAST ? "fast" : "high", static_cast<double>(packed.count) / static_cast<double>(p_src->size()), gb_per_s);
+            EXPECT_GT(gb_per_s, 2.0) << name;
+        }
+    }
+}
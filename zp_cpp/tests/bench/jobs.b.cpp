@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include "zp_cpp/jobs.hpp"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ParallelForCost: Measures parallel_for with the automatic grain against the same loop run serially. The split and the stealing
+// must pay for themselves: the parallel pass may not come out more than 10% slower than the serial one, even with a single worker.
+// Run on an optimized build without sanitizers.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(JobsBench, ParallelForCost)
+{
+    constexpr std::uint64_t COUNT = 10'000'000;
+
+    std::vector<float> values(COUNT, 1.0f);
+    float* const p_values         = values.data();
+    const auto scale              = [p_values](std::uint64_t first, std::uint64_t last)
+    {
+        for (std::uint64_t i = first; i < last; ++i)
+        {
+            p_values[i] = p_values[i] * 1.0001f + 0.5f;
+        }
+    };
+
+    const auto serial_start = std::chrono::steady_clock::now();
+    scale(0, COUNT);
+    const auto serial_end   = std::chrono::steady_clock::now();
+
+    zp::jobs::init({});
+    const auto parallel_start   = std::chrono::steady_clock::now();
+    zp::jobs::parallel_for(0, COUNT, scale);
+    const auto parallel_end     = std::chrono::steady_clock::now();
+    const std::uint32_t workers = zp::jobs::worker_count();
+    zp::jobs::shutdown();
+
+    const double serial_ms   = std::chrono::duration<double, std::milli>(serial_end - serial_start).count();
+    const double parallel_ms = std::chrono::duration<double, std::milli>(parallel_end - parallel_start).count();
+    std::printf("parallel_for over %llu floats: serial %.2f ms, %u workers %.2f ms\n", static_cast<unsigned long long>(COUNT), serial_ms, workers, parallel_ms);
+    EXPECT_FLOAT_EQ(values[0], (1.0f * 1.0001f + 0.5f) * 1.0001f + 0.5f);
+    EXPECT_LT(parallel_ms, serial_ms * 1.1);
+}
@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#define ZP_PROF_ENABLED 1
+#include "zp_cpp/prof.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ZoneOverhead: Measures an empty zone against the 20 ns per zone budget, next to the two clock reads every zone makes. Run on an
+// optimized build without sanitizers.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(ProfBench, ZoneOverhead)
+{
+    constexpr int ITERATIONS = 10'000'000;
+
+    auto start               = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i)
+    {
+        ZP_PROF_ZONE("bench::empty");
+    }
+    const double zone_ns        = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ITERATIONS;
+
+    volatile std::uint64_t sink = 0;
+    start                       = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i)
+    {
+        sink = zp::clock::ticks();
+        sink = zp::clock::ticks();
+    }
+    const double clock_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ITERATIONS;
+
+    std::printf("zone overhead: %.1f ns, of which two clock reads: %.1f ns\n", zone_ns, clock_ns);
+    EXPECT_LT(zone_ns, 20.0);
+}
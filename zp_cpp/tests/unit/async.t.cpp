@@ -0,0 +1,337 @@
+#include <gtest/gtest.h>
+#include "zp_cpp/async.hpp"
+#include "zp_cpp/async_files.hpp"
+#include "zp_cpp/jobs.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    zp::task<int> add(int a, int b)
+    {
+        co_return a + b;
+    }
+
+    zp::task<int> sum_three(int* p_started)
+    {
+        ++*p_started;
+        const int ab = co_await add(1, 2);
+        co_return co_await add(ab, 3);
+    }
+
+    zp::task<void> store(zp::task<int> value, int* p_out)
+    {
+        *p_out = co_await std::move(value);
+    }
+
+    // logs id after the sleep and id + 10 one poll later.
+    zp::task<void> sleeper(zp::ens delay_ns, int id, std::vector<int>* p_log)
+    {
+        co_await zp::async_sleep(delay_ns);
+        p_log->push_back(id);
+        co_await zp::async_yield();
+        p_log->push_back(id + 10);
+    }
+
+    zp::task<void> read_into(std::filesystem::path path, zp::files::FileContents* p_out)
+    {
+        *p_out = co_await zp::files::async_read(std::move(path));
+    }
+
+    zp::task<void> offload_thread(std::thread::id* p_out)
+    {
+        *p_out = co_await zp::async_offload([]() { return std::this_thread::get_id(); });
+    }
+
+    zp::task<void> pop_into(zp::async_queue<int>* p_queue, std::vector<std::optional<int>>* p_log)
+    {
+        p_log->push_back(co_await zp::async_pop(p_queue));
+    }
+
+    zp::task<void> pop_until_into(zp::async_queue<int>* p_queue, zp::ens deadline_ns, std::vector<std::optional<int>>* p_log)
+    {
+        p_log->push_back(co_await zp::async_pop_until(p_queue, deadline_ns));
+    }
+
+    struct Guard
+    {
+        bool* p_destroyed;
+
+        ~Guard()
+        {
+            *p_destroyed = true;
+        }
+    };
+
+    zp::task<void> sleep_forever(bool* p_destroyed)
+    {
+        Guard guard = {p_destroyed};
+        co_await zp::async_sleep(3'600'000'000'000);
+    }
+
+    zp::task<void> await_forever(bool* p_parent_destroyed, bool* p_child_destroyed)
+    {
+        Guard guard = {p_parent_destroyed};
+        co_await sleep_forever(p_child_destroyed);
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ChainsTasks: Validates a task runs nothing until awaited, and that tasks awaiting tasks which never suspend finish inside
+// exec_spawn without going through the executor.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(AsyncTest, ChainsTasks)
+{
+    zp::executor exec;
+    zp::exec_init(&exec);
+
+    int started          = 0;
+    int out              = 0;
+    zp::task<int> summed = sum_three(&started);
+    EXPECT_EQ(started, 0);
+
+    zp::exec_spawn(&exec, store(std::move(summed), &out));
+    EXPECT_EQ(started, 1);
+    EXPECT_EQ(out, 6);
+    EXPECT_EQ(exec.state.spawned, 0u);
+    EXPECT_EQ(zp::exec_poll(&exec), 0u);
+    EXPECT_EQ(exec.state.resumed, 0u);
+    zp::exec_exit(&exec);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// SleepsOnClock: Validates sleeping tasks resume from the first poll past their deadline on a virtual clock, in deadline order,
+// and that a yield waits for the following poll.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(AsyncTest, SleepsOnClock)
+{
+    zp::clock::use_virtual_clock(0, 0.0);
+    zp::executor exec;
+    zp::exec_init(&exec);
+
+    std::vector<int> log;
+    zp::exec_spawn(&exec, sleeper(5'000'000, 1, &log));
+    zp::exec_spawn(&exec, sleeper(2'000'000, 2, &log));
+    EXPECT_EQ(exec.state.spawned, 2u);
+    EXPECT_EQ(zp::exec_poll(&exec), 0u);
+
+    zp::clock::advance_virtual_clock(3'000'000);
+    EXPECT_EQ(zp::exec_poll(&exec), 1u);
+    EXPECT_EQ(log, (std::vector<int>{2}));
+    EXPECT_EQ(zp::exec_poll(&exec), 1u);
+    EXPECT_EQ(log, (std::vector<int>{2, 12}));
+    EXPECT_EQ(exec.state.spawned, 1u);
+
+    zp::clock::advance_virtual_clock(3'000'000);
+    zp::exec_poll(&exec);
+    zp::exec_poll(&exec);
+    EXPECT_EQ(log, (std::vector<int>{2, 12, 1, 11}));
+    EXPECT_EQ(exec.state.spawned, 0u);
+    EXPECT_EQ(exec.state.resumed, 4u);
+
+    zp::exec_exit(&exec);
+    zp::clock::set_source(nullptr);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// OffloadsFileReads: Validates async_read runs on a jobs worker rather than the polling thread, returns the file's bytes, and
+// reports a missing file, both with and without a running pool.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(AsyncTest, OffloadsFileReads)
+{
+    const std::filesystem::path path    = std::filesystem::temp_directory_path() / "zp_async_read.bin";
+    const std::filesystem::path missing = std::filesystem::temp_directory_path() / "zp_async_missing.bin";
+    std::filesystem::remove(missing);
+    {
+        std::ofstream ofs(path, std::ios::binary);
+        ofs << "coroutine bytes";
+    }
+
+    const auto run = [&](std::thread::id* p_ran_on, zp::files::FileContents* p_found, zp::files::FileContents* p_missing)
+    {
+        zp::executor exec;
+        zp::exec_init(&exec);
+        zp::exec_spawn(&exec, offload_thread(p_ran_on));
+        zp::exec_spawn(&exec, read_into(path, p_found));
+        zp::exec_spawn(&exec, read_into(missing, p_missing));
+
+        const std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (exec.state.spawned > 0 && std::chrono::steady_clock::now() < until)
+        {
+            zp::exec_poll(&exec);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        EXPECT_EQ(exec.state.spawned, 0u);
+        zp::exec_exit(&exec);
+    };
+
+    const auto as_text = [](const std::vector<std::byte>& bytes) { return std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size()); };
+
+    zp::jobs::init({.worker_count = 2});
+    std::thread::id ran_on;
+    zp::files::FileContents found  = {};
+    zp::files::FileContents absent = {};
+    run(&ran_on, &found, &absent);
+    zp::jobs::shutdown();
+
+    EXPECT_NE(ran_on, std::thread::id{});
+    EXPECT_NE(ran_on, std::this_thread::get_id());
+    EXPECT_EQ(found.result, zp::Result::ZC_SUCCESS);
+    EXPECT_EQ(as_text(found.bytes), "coroutine bytes");
+    EXPECT_EQ(absent.result, zp::Result::ZC_FILE_NOT_FOUND);
+    EXPECT_TRUE(absent.bytes.empty());
+
+    // without a pool the work runs inline, and the task still resumes from the next poll.
+    zp::files::FileContents inline_found = {};
+    run(&ran_on, &inline_found, &absent);
+    EXPECT_EQ(ran_on, std::this_thread::get_id());
+    EXPECT_EQ(as_text(inline_found.bytes), "coroutine bytes");
+
+    std::filesystem::remove(path);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// QueueHandsValuesToWaiters: Validates pushed values go to the oldest waiter on the next poll, are kept when nobody waits, and
+// that cancelling wakes the remaining waiters with nullopt.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(AsyncTest, QueueHandsValuesToWaiters)
+{
+    zp::executor exec;
+    zp::exec_init(&exec);
+    zp::async_queue<int> queue;
+    std::vector<std::optional<int>> log;
+
+    zp::exec_spawn(&exec, pop_into(&queue, &log));
+    zp::exec_spawn(&exec, pop_into(&queue, &log));
+    zp::exec_spawn(&exec, pop_into(&queue, &log));
+    EXPECT_EQ(queue.waiters.size(), 3u);
+
+    zp::async_push(&queue, 7);
+    EXPECT_TRUE(log.empty());
+    zp::exec_poll(&exec);
+    EXPECT_EQ(log, (std::vector<std::optional<int>>{7}));
+
+    zp::async_cancel(&queue);
+    zp::exec_poll(&exec);
+    EXPECT_EQ(log, (std::vector<std::optional<int>>{7, std::nullopt, std::nullopt}));
+
+    // a value pushed while nobody waits is taken without suspending.
+    zp::async_push(&queue, 9);
+    zp::exec_spawn(&exec, pop_into(&queue, &log));
+    EXPECT_EQ(log.back(), 9);
+    EXPECT_EQ(exec.state.spawned, 0u);
+    zp::exec_exit(&exec);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// TimedPopsGiveUp: Validates a timed pop resumes with nullopt from the first poll past its deadline and leaves the queue, so a
+// later value is kept rather than lost, and that a pop woken first never resumes again from its deadline.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(AsyncTest, TimedPopsGiveUp)
+{
+    zp::clock::use_virtual_clock(0, 0.0);
+    zp::executor exec;
+    zp::exec_init(&exec);
+    zp::async_queue<int> queue;
+    std::vector<std::optional<int>> log;
+
+    zp::exec_spawn(&exec, pop_until_into(&queue, 5'000'000, &log));
+    zp::exec_spawn(&exec, pop_until_into(&queue, 5'000'000, &log));
+    zp::async_push(&queue, 3);
+    zp::exec_poll(&exec);
+    EXPECT_EQ(log, (std::vector<std::optional<int>>{3}));
+    EXPECT_EQ(queue.waiters.size(), 1u);
+
+    zp::clock::advance_virtual_clock(6'000'000);
+    EXPECT_EQ(zp::exec_poll(&exec), 1u);
+    EXPECT_EQ(log, (std::vector<std::optional<int>>{3, std::nullopt}));
+    EXPECT_TRUE(queue.waiters.empty());
+    EXPECT_EQ(exec.state.spawned, 0u);
+
+    zp::async_push(&queue, 4);
+    EXPECT_EQ(queue.values.size(), 1u);
+    EXPECT_EQ(zp::exec_poll(&exec), 0u);
+
+    // a deadline already passed gives up without suspending once the kept value is taken.
+    zp::exec_spawn(&exec, pop_until_into(&queue, 1'000'000, &log));
+    zp::exec_spawn(&exec, pop_until_into(&queue, 1'000'000, &log));
+    EXPECT_EQ(log, (std::vector<std::optional<int>>{3, std::nullopt, 4, std::nullopt}));
+    EXPECT_EQ(exec.state.spawned, 0u);
+
+    zp::exec_exit(&exec);
+    zp::clock::set_source(nullptr);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ExitDestroysUnfinishedTasks: Validates exec_exit frees a spawned task still suspended, along with the task it awaits.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(AsyncTest, ExitDestroysUnfinishedTasks)
+{
+    zp::executor exec;
+    zp::exec_init(&exec);
+
+    bool parent_destroyed = false;
+    bool child_destroyed  = false;
+    zp::exec_spawn(&exec, await_forever(&parent_destroyed, &child_destroyed));
+    zp::exec_poll(&exec);
+    EXPECT_EQ(exec.state.spawned, 1u);
+    EXPECT_FALSE(parent_destroyed);
+    EXPECT_FALSE(child_destroyed);
+
+    zp::exec_exit(&exec);
+    EXPECT_TRUE(parent_destroyed);
+    EXPECT_TRUE(child_destroyed);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ExitLeavesQueuesUsable: Validates exec_exit takes a task still waiting on a queue off it, so the queue can be cancelled and
+// pushed to afterwards, and that a woken waiter destroyed unresumed leaves the queue alone.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(AsyncTest, ExitLeavesQueuesUsable)
+{
+    zp::async_queue<int> queue;
+    std::vector<std::optional<int>> log;
+
+    zp::executor exec;
+    zp::exec_init(&exec);
+    zp::exec_spawn(&exec, pop_into(&queue, &log));
+    zp::exec_spawn(&exec, pop_into(&queue, &log));
+    zp::exec_poll(&exec);
+    EXPECT_EQ(queue.waiters.size(), 2u);
+
+    zp::exec_exit(&exec);
+    EXPECT_TRUE(queue.waiters.empty());
+    zp::async_cancel(&queue);
+    zp::async_push(&queue, 4);
+    EXPECT_EQ(queue.values.size(), 1u);
+    EXPECT_TRUE(log.empty());
+
+    // cancelled but never resumed: the frame goes with the executor while the queue is already gone.
+    {
+        zp::async_queue<int> short_lived;
+        zp::exec_init(&exec);
+        zp::exec_spawn(&exec, pop_into(&short_lived, &log));
+        zp::async_cancel(&short_lived);
+    }
+    zp::exec_exit(&exec);
+    EXPECT_TRUE(log.empty());
+}
@@ -0,0 +1,302 @@
+#include <gtest/gtest.h>
+#include "zp_cpp/core.hpp"
+#include "zp_cpp/compress.hpp"
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct CorpusItem
+    {
+        const char* name;
+        std::vector<std::byte> data;
+    };
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // make_corpus: Builds a deterministic corpus covering text-like, structured binary, run-heavy and random inputs.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    std::vector<CorpusItem> make_corpus()
+    {
+        std::vector<CorpusItem> corpus;
+        std::mt19937 rng(1234);
+
+        // =========================================================================================
+        // =========================================================================================
+        // Text: words drawn from a small vocabulary, the typical log / config / json case.
+        // =========================================================================================
+        // =========================================================================================
+        {
+            const char* words[] = {"the", "entity", "transform", "position", "velocity", "render", "pass", "\"id\":", "{", "}", "\n", "frame", "0.125", "true", "null"};
+            std::string text;
+            while (text.size() < 1 << 20)
+            {
+                text += words[rng() % std::size(words)];
+                text += ' ';
+            }
+            const std::byte* p = reinterpret_cast<const std::byte*>(text.data());
+            corpus.push_back({"text", std::vector<std::byte>(p, p + text.size())});
+        }
+
+        // =========================================================================================
+        // =========================================================================================
+        // Structured binary: arrays of small records with slowly changing fields, like snapshots and vertex data.
+        // =========================================================================================
+        // =========================================================================================
+        {
+            std::vector<std::byte> data(1 << 20);
+            for (std::size_t i = 0; i + 16 <= data.size(); i += 16)
+            {
+                const std::uint32_t record[4] = {static_cast<std::uint32_t>(i / 16), 0x3f800000u, static_cast<std::uint32_t>(i / 1024), static_cast<std::uint32_t>(rng() % 4)};
+                std::memcpy(data.data() + i, record, sizeof(record));
+            }
+            corpus.push_back({"binary", std::move(data)});
+        }
+
+        // =========================================================================================
+        // =========================================================================================
+        // Runs: long stretches of repeated bytes, exercising overlapping short-offset matches.
+        // =========================================================================================
+        // =========================================================================================
+        {
+            std::vector<std::byte> data;
+            while (data.size() < 1 << 20)
+            {
+                data.insert(data.end(), 1 + rng() % 300, static_cast<std::byte>(rng() % 4));
+            }
+            corpus.push_back({"runs", std::move(data)});
+        }
+
+        // =========================================================================================
+        // =========================================================================================
+        // Random: incompressible input must not expand past compress_bound.
+        // =========================================================================================
+        // =========================================================================================
+        {
+            std::vector<std::byte> data(1 << 20);
+            for (std::byte& b : data)
+            {
+                b = static_cast<std::byte>(rng());
+            }
+            corpus.push_back({"random", std::move(data)});
+        }
+
+        return corpus;
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // round_trip_block: Compresses and decompresses a block, returning the compressed size.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    std::size_t round_trip_block(const std::vector<std::byte>& src, zp::compress::Level level)
+    {
+        std::vector<std::byte> compressed(zp::compress::compress_bound(src.size()));
+        zp::span<std::byte> packed;
+        EXPECT_EQ(zp::compress::compress_block({src.data(), src.size()}, {compressed.data(), compressed.size()}, level, &packed), zp::Result::ZC_SUCCESS);
+
+        std::vector<std::byte> decompressed(src.size());
+        zp::span<std::byte> unpacked;
+        EXPECT_EQ(zp::compress::decompress_block({packed.p, packed.count}, {decompressed.data(), decompressed.size()}, &unpacked), zp::Result::ZC_SUCCESS);
+        EXPECT_EQ(unpacked.count, src.size());
+        EXPECT_EQ(decompressed, src);
+        return packed.count;
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// BlockRoundTripSmallInputs: Validates empty, tiny and boundary-sized inputs survive a block round trip at both levels.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(CompressTest, BlockRoundTripSmallInputs)
+{
+    for (std::size_t size : {0u, 1u, 5u, 12u, 13u, 16u, 64u, 255u, 256u, 1000u})
+    {
+        std::vector<std::byte> src(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            src[i] = static_cast<std::byte>((i * 7) % 5);
+        }
+        round_trip_block(src, zp::compress::Level::FAST);
+        round_trip_block(src, zp::compress::Level::HIGH);
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// BlockDecodeRejectsCorruptInput: Validates truncated blocks, bad offsets and undersized outputs fail instead of overrunning.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(CompressTest, BlockDecodeRejectsCorruptInput)
+{
+    const std::string text = "abcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabc the end";
+    const zp::span<const std::byte> src{reinterpret_cast<const std::byte*>(text.data()), text.size()};
+
+    std::vector<std::byte> compressed(zp::compress::compress_bound(src.count));
+    zp::span<std::byte> packed;
+    ASSERT_EQ(zp::compress::compress_block(src, {compressed.data(), compressed.size()}, zp::compress::Level::FAST, &packed), zp::Result::ZC_SUCCESS);
+    ASSERT_LT(packed.count, src.count);
+
+    std::vector<std::byte> out(src.count);
+    zp::span<std::byte> unpacked;
+    EXPECT_EQ(zp::compress::decompress_block({packed.p, packed.count - 1}, {out.data(), out.size()}, &unpacked), zp::Result::ZC_INVALID_FORMAT);
+    EXPECT_EQ(zp::compress::decompress_block({packed.p, packed.count}, {out.data(), out.size() - 1}, &unpacked), zp::Result::ZC_INVALID_FORMAT);
+
+    // a match at the very start has nothing behind it to copy from.
+    const std::byte bad_offset[] = {std::byte{0x04}, std::byte{'a'}, std::byte{'b'}, std::byte{'c'}, std::byte{'d'}, std::byte{0x10}, std::byte{0x00}};
+    EXPECT_EQ(zp::compress::decompress_block({bad_offset, sizeof(bad_offset)}, {out.data(), out.size()}, &unpacked), zp::Result::ZC_INVALID_FORMAT);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ChecksumMatchesXxh32: Validates the streaming checksum against published xxh32 vectors and across arbitrary chunk splits.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(CompressTest, ChecksumMatchesXxh32)
+{
+    zp::compress::Checksum checksum;
+
+    zp::compress::checksum_reset(&checksum);
+    EXPECT_EQ(zp::compress::checksum_digest(&checksum), 0x02cc5d05u);
+
+    zp::compress::checksum_reset(&checksum);
+    zp::compress::checksum_update(&checksum, {reinterpret_cast<const std::byte*>("abc"), 3});
+    EXPECT_EQ(zp::compress::checksum_digest(&checksum), 0x32d153ffu);
+
+    std::vector<std::byte> data(1000);
+    for (std::size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<std::byte>(i * 31);
+    }
+
+    zp::compress::checksum_reset(&checksum);
+    zp::compress::checksum_update(&checksum, {data.data(), data.size()});
+    const std::uint32_t whole = zp::compress::checksum_digest(&checksum);
+
+    zp::compress::checksum_reset(&checksum);
+    for (std::size_t offset = 0, step = 1; offset < data.size(); offset += step, step = step % 37 + 3)
+    {
+        zp::compress::checksum_update(&checksum, {data.data() + offset, std::min(step, data.size() - offset)});
+    }
+    EXPECT_EQ(zp::compress::checksum_digest(&checksum), whole);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// FrameStreamingRoundTrip: Validates byte-at-a-time and chunked streaming produce the same content as the one-shot helpers.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(CompressTest, FrameStreamingRoundTrip)
+{
+    std::vector<std::byte> src(200000);
+    for (std::size_t i = 0; i < src.size(); ++i)
+    {
+        src[i] = static_cast<std::byte>((i / 7) ^ (i % 13));
+    }
+
+    zp::compress::encoder enc = {};
+    enc.config.block_size     = 4096;
+    std::vector<std::byte> frame;
+    for (std::size_t offset = 0; offset < src.size(); offset += 1000)
+    {
+        zp::compress::encoder_write(&enc, {src.data() + offset, std::min<std::size_t>(1000, src.size() - offset)}, &frame);
+    }
+    zp::compress::encoder_finish(&enc, &frame);
+    EXPECT_LT(frame.size(), src.size());
+
+    zp::compress::decoder dec = {};
+    std::vector<std::byte> decoded;
+    for (std::size_t offset = 0; offset < frame.size(); offset += 777)
+    {
+        ASSERT_EQ(zp::compress::decoder_feed(&dec, {frame.data() + offset, std::min<std::size_t>(777, frame.size() - offset)}, &decoded), zp::Result::ZC_SUCCESS);
+    }
+    EXPECT_EQ(dec.state.stage, zp::compress::decoder::Stage::DONE);
+    EXPECT_EQ(decoded, src);
+
+    std::vector<std::byte> one_shot;
+    zp::compress::compress_frame({src.data(), src.size()}, zp::compress::Level::HIGH, &one_shot);
+    decoded.clear();
+    ASSERT_EQ(zp::compress::decompress_frame({one_shot.data(), one_shot.size()}, &decoded), zp::Result::ZC_SUCCESS);
+    EXPECT_EQ(decoded, src);
+
+    std::vector<std::byte> empty_frame;
+    zp::compress::compress_frame({nullptr, 0}, zp::compress::Level::FAST, &empty_frame);
+    decoded.clear();
+    ASSERT_EQ(zp::compress::decompress_frame({empty_frame.data(), empty_frame.size()}, &decoded), zp::Result::ZC_SUCCESS);
+    EXPECT_TRUE(decoded.empty());
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// FrameDetectsCorruption: Validates a flipped content byte fails the checksum and a truncated frame is reported as invalid.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(CompressTest, FrameDetectsCorruption)
+{
+    std::vector<std::byte> src(10000);
+    for (std::size_t i = 0; i < src.size(); ++i)
+    {
+        src[i] = static_cast<std::byte>(i * 131 + (i >> 5));
+    }
+
+    std::vector<std::byte> frame;
+    zp::compress::compress_frame({src.data(), src.size()}, zp::compress::Level::FAST, &frame);
+
+    std::vector<std::byte> decoded;
+    EXPECT_EQ(zp::compress::decompress_frame({frame.data(), frame.size() - 2}, &decoded), zp::Result::ZC_INVALID_FORMAT);
+
+    // the random-looking input is stored uncompressed, so flipping a payload byte leaves the block decodable.
+    frame[20] ^= std::byte{0x01};
+    decoded.clear();
+    EXPECT_EQ(zp::compress::decompress_frame({frame.data(), frame.size()}, &decoded), zp::Result::ZC_CHECKSUM_MISMATCH);
+
+    frame[0] = std::byte{0};
+    decoded.clear();
+    EXPECT_EQ(zp::compress::decompress_frame({frame.data(), frame.size()}, &decoded), zp::Result::ZC_INVALID_FORMAT);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// CorpusRoundTrip: Round-trips the corpus at both levels, checking every block stays within compress_bound and every compressible
+// input at least halves. Throughput lives in tests/bench/compress.b.cpp.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(CompressTest, CorpusRoundTrip)
+{
+    const std::vector<CorpusItem> corpus = make_corpus();
+
+    for (const CorpusItem& item : corpus)
+    {
+        for (zp::compress::Level level : {zp::compress::Level::FAST, zp::compress::Level::HIGH})
+        {
+            const std::size_t packed_size = round_trip_block(item.data, level);
+            EXPECT_LE(packed_size, zp::compress::compress_bound(item.data.size()));
+            if (std::strcmp(item.name, "random") != 0)
+            {
+                EXPECT_LT(packed_size * 2, item.data.size()) << item.name;
+            }
+        }
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// HighLevelCompressesBetter: Validates the hash-chain mode never loses to the greedy mode on the compressible corpus.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(CompressTest, HighLevelCompressesBetter)
+{
+    const std::vector<CorpusItem> corpus = make_corpus();
+    for (const CorpusItem& item : corpus)
+    {
+        if (std::strcmp(item.name, "random") == 0)
+        {
+            continue;
+        }
+        EXPECT_LE(round_trip_block(item.data, zp::compress::Level::HIGH), round_trip_block(item.data, zp::compress::Level::FAST)) << item.name;
+    }
+}
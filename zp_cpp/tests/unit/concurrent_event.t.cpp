@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "zp_cpp/concurrent_event.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// SubscribeWhileTriggering: Stress: triggering threads and subscribing threads race for a while; a listener subscribed for the
+// whole run sees every trigger exactly once, and churned listeners never run after their token is reset. Run under the ZP_TSAN
+// build to check the publication and reclamation for races.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(ConcurrentEventTest, SubscribeWhileTriggering)
+{
+    constexpr int TRIGGER_THREADS   = 4;
+    constexpr int TRIGGERS          = 200'000;
+    constexpr int SUBSCRIBE_THREADS = 2;
+
+    zp::concurrent_event<int> evt;
+    std::atomic<std::uint64_t> permanent_sum = 0;
+    const zp::subscription permanent         = evt.subscribe([&](const int& value) { permanent_sum.fetch_add(value, std::memory_order_relaxed); });
+
+    std::atomic<bool> stop                   = false;
+    std::atomic<int> late_calls              = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < SUBSCRIBE_THREADS; ++t)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                while (!stop.load())
+                {
+                    // a listener whose flag is cleared before its token resets must never see it cleared.
+                    auto p_live        = std::make_shared<std::atomic<bool>>(true);
+                    zp::subscription s = evt.subscribe(
+                        [p_live, &late_calls](const int&)
+                        {
+                            if (!p_live->load())
+                            {
+                                late_calls.fetch_add(1);
+                            }
+                        });
+                    std::this_thread::yield();
+                    s.reset();
+                    p_live->store(false);
+                }
+            });
+    }
+
+    std::vector<std::thread> triggers;
+    for (int t = 0; t < TRIGGER_THREADS; ++t)
+    {
+        triggers.emplace_back(
+            [&]()
+            {
+                for (int i = 0; i < TRIGGERS; ++i)
+                {
+                    evt.trigger(1);
+                }
+            });
+    }
+    for (std::thread& thread : triggers)
+    {
+        thread.join();
+    }
+    stop = true;
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(permanent_sum.load(), static_cast<std::uint64_t>(TRIGGER_THREADS) * TRIGGERS);
+    EXPECT_EQ(late_calls.load(), 0);
+    EXPECT_EQ(evt.listener_count(), 1u);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// MarshalsToTargetThread: Validates a listener subscribed with a dispatch_queue runs on the thread that drains it, not the one
+// that triggered.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(ConcurrentEventTest, MarshalsToTargetThread)
+{
+    zp::dispatch_queue game_thread;
+    zp::dispatch_init(&game_thread);
+
+    zp::concurrent_event<int> evt;
+    std::vector<int> received;
+    std::thread::id ran_on;
+    const zp::subscription subscribed = evt.subscribe(
+        [&](const int& value)
+        {
+            received.push_back(value);
+            ran_on = std::this_thread::get_id();
+        },
+        &game_thread);
+
+    std::thread network_thread(
+        [&]()
+        {
+            for (int i = 0; i < 100; ++i)
+            {
+                evt.trigger(i);
+            }
+        });
+    network_thread.join();
+    EXPECT_TRUE(received.empty());
+
+    EXPECT_EQ(zp::dispatch_drain(&game_thread), 100u);
+    ASSERT_EQ(received.size(), 100u);
+    EXPECT_EQ(received[99], 99);
+    EXPECT_EQ(ran_on, std::this_thread::get_id());
+    EXPECT_EQ(zp::dispatch_drain(&game_thread), 0u);
+
+    zp::dispatch_exit(&game_thread);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ChangesFromListener: Validates a listener can subscribe and unsubscribe on the event calling it without deadlocking, with the
+// change applying from the next trigger.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(ConcurrentEventTest, ChangesFromListener)
+{
+    zp::concurrent_event<int> evt;
+    int first_calls  = 0;
+    int second_calls = 0;
+    zp::subscription second;
+
+    const zp::subscription first = evt.subscribe(
+        [&](const int&)
+        {
+            ++first_calls;
+            if (first_calls == 1)
+            {
+                second = evt.subscribe([&](const int&) { ++second_calls; });
+            }
+            else
+            {
+                second.reset();
+            }
+        });
+
+    evt.trigger(0);
+    EXPECT_EQ(second_calls, 0);
+    evt.trigger(0);
+    EXPECT_EQ(second_calls, 1);
+    evt.trigger(0);
+    EXPECT_EQ(second_calls, 1);
+    EXPECT_EQ(evt.listener_count(), 1u);
+}
@@ -46,3 +46,34 @@ TEST(CoreUnitTest, CalcInterp)
     EXPECT_FLOAT_EQ(zp::calc_interp(started, started + dur, dur), 0.0f);
     EXPECT_FLOAT_EQ(zp::calc_interp(started, started + dur + 250, dur), 0.25f);
 }
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ClockMonotonicAndCalibrated: Validates fast_ns never goes backwards, tracks steady_ns and converts tick deltas to real durations.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(CoreUnitTest, ClockMonotonicAndCalibrated)
+{
+    constexpr int READS = 1'000'000;
+
+    EXPECT_GT(zp::clock::calibration().ns_per_tick, 0.0);
+
+    zp::ens previous = zp::clock::fast_ns();
+    for (int i = 0; i < READS; ++i)
+    {
+        const zp::ens ns = zp::clock::fast_ns();
+        ASSERT_GE(ns, previous);
+        previous = ns;
+    }
+
+    const zp::ens steady = zp::clock::steady_ns();
+    const zp::ens fast   = zp::clock::fast_ns();
+    EXPECT_LT(fast > steady ? fast - steady : steady - fast, 1'000'000u);
+
+    const std::uint64_t tick_start = zp::clock::ticks();
+    const zp::ens steady_start     = zp::clock::steady_ns();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const zp::ens measured = zp::clock::ticks_to_duration_ns(zp::clock::ticks_ordered() - tick_start);
+    const zp::ens expected = zp::clock::steady_ns() - steady_start;
+    EXPECT_NEAR(static_cast<double>(measured), static_cast<double>(expected), expected * 0.05);
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "zp_cpp/dbg.hpp"
+#include "../cmn.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ConsoleLinesInOrder: Validates queued console lines reach stdout complete and in order.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(DbgTest, ConsoleLinesInOrder)
+{
+    const std::filesystem::path out_file = zp::test::make_temp_path("zp_cpp_dbg", ".log");
+
+    std::fflush(stdout);
+    const int saved_stdout = dup(STDOUT_FILENO);
+    const int file_fd      = open(out_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    dup2(file_fd, STDOUT_FILENO);
+    close(file_fd);
+
+    for (int i = 0; i < 200; ++i)
+    {
+        LOG("line " << i);
+    }
+    WARN("last");
+    zp::dbg::console_flush();
+
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    std::ifstream in(out_file);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);)
+    {
+        lines.push_back(line);
+    }
+
+    ASSERT_EQ(lines.size(), 201u);
+    for (int i = 0; i < 200; ++i)
+    {
+        EXPECT_NE(lines[i].find("[dbg.t.cpp:"), std::string::npos) << lines[i];
+        EXPECT_NE(lines[i].find(" line " + std::to_string(i) + "\033[0m"), std::string::npos) << lines[i];
+    }
+    EXPECT_NE(lines[200].find(" last"), std::string::npos);
+
+    std::filesystem::remove(out_file);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// DropsOldestWhenStalled: Validates producers keep going while stdout is a stalled pipe, dropping the oldest lines and reporting it.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(DbgTest, DropsOldestWhenStalled)
+{
+    int pipe_fds[2];
+    ASSERT_EQ(pipe(pipe_fds), 0);
+
+    std::fflush(stdout);
+    const int saved_stdout = dup(STDOUT_FILENO);
+    dup2(pipe_fds[1], STDOUT_FILENO);
+    close(pipe_fds[1]);
+
+    // nobody reads the pipe yet, so the writer blocks once the pipe buffer fills and the queue overflows.
+    const std::uint64_t dropped_before = zp::dbg::console_dropped();
+    for (int i = 0; i < 20000; ++i)
+    {
+        LOG("stalled line " << i);
+    }
+    const std::uint64_t dropped = zp::dbg::console_dropped() - dropped_before;
+
+    std::string output;
+    std::thread reader([&]()
+    {
+        char buffer[4096];
+        ssize_t n = 0;
+        while ((n = read(pipe_fds[0], buffer, sizeof(buffer))) > 0)
+        {
+            output.append(buffer, static_cast<std::size_t>(n));
+        }
+    });
+
+    zp::dbg::console_flush();
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+    reader.join();
+    close(pipe_fds[0]);
+
+    EXPECT_GT(dropped, 0u);
+    EXPECT_NE(output.find("console lines dropped"), std::string::npos);
+    EXPECT_NE(output.find(" stalled line 19999\033[0m"), std::string::npos);
+}
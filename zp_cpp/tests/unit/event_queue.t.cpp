@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+#include "zp_cpp/event_queue.hpp"
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct MoveEvt
+    {
+        float dx;
+        float dy;
+    };
+
+    struct KeyEvt
+    {
+        int key;
+    };
+
+    struct CharEvt
+    {
+        char c;
+    };
+
+    constexpr int KEY_BACKSPACE = 8;
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// DefersUntilDispatch: Validates enqueued events reach no handler until dispatch_all, then arrive once, batches first and single
+// events in arrival order across types.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(EventQueueTest, DefersUntilDispatch)
+{
+    zp::event_queue queue;
+    std::string trace;
+
+    const zp::subscription batch  = zp::queue_subscribe_batch<MoveEvt>(&queue, [&](zp::span<const MoveEvt> moves) { trace += "B" + std::to_string(moves.count); });
+    const zp::subscription single = zp::queue_subscribe<MoveEvt>(&queue, [&](const MoveEvt& move) { trace += "M" + std::to_string(static_cast<int>(move.dx)); });
+    const zp::subscription keys   = zp::queue_subscribe<KeyEvt>(&queue, [&](const KeyEvt& key) { trace += "K" + std::to_string(key.key); });
+
+    zp::enqueue(&queue, MoveEvt{1.0f, 0.0f});
+    zp::enqueue(&queue, KeyEvt{7});
+    zp::enqueue(&queue, MoveEvt{2.0f, 0.0f});
+    EXPECT_EQ(trace, "");
+    EXPECT_EQ(zp::queue_pending(&queue), 3u);
+
+    zp::dispatch_all(&queue);
+    EXPECT_EQ(trace, "B2M1K7M2");
+    EXPECT_EQ(zp::queue_pending(&queue), 0u);
+
+    // an empty frame delivers nothing, not even an empty batch.
+    zp::dispatch_all(&queue);
+    EXPECT_EQ(trace, "B2M1K7M2");
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// BatchSeesContiguousArray: Validates a batch handler gets the frame's events as one contiguous array it can sum in one pass,
+// and that events enqueued by handlers wait for the next dispatch.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(EventQueueTest, BatchSeesContiguousArray)
+{
+    zp::event_queue queue;
+    float total_dx       = 0.0f;
+    std::size_t batches  = 0;
+
+    const auto sum_moves = [&](zp::span<const MoveEvt> moves)
+    {
+        ++batches;
+        for (const MoveEvt& move : moves)
+        {
+            total_dx += move.dx;
+        }
+    };
+    const zp::subscription batch = zp::queue_subscribe_batch<MoveEvt>(&queue, sum_moves);
+    const zp::subscription echo  = zp::queue_subscribe<KeyEvt>(&queue, [&](const KeyEvt&) { zp::enqueue(&queue, MoveEvt{100.0f, 0.0f}); });
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        zp::enqueue(&queue, MoveEvt{1.0f, 0.0f});
+    }
+    zp::enqueue(&queue, KeyEvt{1});
+
+    zp::dispatch_all(&queue);
+    EXPECT_EQ(batches, 1u);
+    EXPECT_FLOAT_EQ(total_dx, 1000.0f);
+    EXPECT_EQ(zp::queue_pending(&queue), 1u);
+
+    zp::dispatch_all(&queue);
+    EXPECT_EQ(batches, 2u);
+    EXPECT_FLOAT_EQ(total_dx, 1100.0f);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ForwardsToEvents: Validates queue_forward delivers queued events to an existing Event<T> and stops once its token is reset.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(EventQueueTest, ForwardsToEvents)
+{
+    zp::event_queue queue;
+    zp::Event<KeyEvt> on_key;
+    std::vector<int> keys;
+
+    const zp::subscription listener = on_key.subscribe([&](const KeyEvt& key) { keys.push_back(key.key); });
+    zp::subscription route          = zp::queue_forward(&queue, &on_key);
+
+    zp::enqueue(&queue, KeyEvt{1});
+    zp::enqueue(&queue, KeyEvt{2});
+    zp::dispatch_all(&queue);
+    EXPECT_EQ(keys, (std::vector<int>{1, 2}));
+
+    route.reset();
+    zp::enqueue(&queue, KeyEvt{3});
+    zp::dispatch_all(&queue);
+    EXPECT_EQ(keys, (std::vector<int>{1, 2}));
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// CoalescesPerFrame: Validates a drag of many samples arrives as one event carrying the summed delta, that a merge can decline
+// to keep differing events apart, and that keep-latest delivers only the newest event.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(EventQueueTest, CoalescesPerFrame)
+{
+    zp::event_queue queue;
+    std::vector<MoveEvt> moves;
+    std::vector<int> keys;
+
+    const auto merge_move = [](MoveEvt* p_into, const MoveEvt& next)
+    {
+        // a move that changes direction on x starts a new event.
+        if ((p_into->dx < 0.0f) != (next.dx < 0.0f))
+        {
+            return false;
+        }
+        p_into->dx += next.dx;
+        p_into->dy += next.dy;
+        return true;
+    };
+    ASSERT_EQ(zp::queue_coalesce<MoveEvt>(&queue, zp::Coalesce::ACCUMULATE, +merge_move), zp::Result::ZC_SUCCESS);
+    ASSERT_EQ(zp::queue_coalesce<KeyEvt>(&queue, zp::Coalesce::KEEP_LATEST), zp::Result::ZC_SUCCESS);
+    const zp::subscription on_move = zp::queue_subscribe<MoveEvt>(&queue, [&](const MoveEvt& move) { moves.push_back(move); });
+    const zp::subscription on_key  = zp::queue_subscribe<KeyEvt>(&queue, [&](const KeyEvt& key) { keys.push_back(key.key); });
+
+    for (int i = 0; i < 50; ++i)
+    {
+        zp::enqueue(&queue, MoveEvt{0.25f, -0.5f});
+        zp::enqueue(&queue, KeyEvt{i});
+    }
+    EXPECT_EQ(zp::queue_pending(&queue), 2u);
+    zp::dispatch_all(&queue);
+    ASSERT_EQ(moves.size(), 1u);
+    EXPECT_FLOAT_EQ(moves[0].dx, 12.5f);
+    EXPECT_FLOAT_EQ(moves[0].dy, -25.0f);
+    EXPECT_EQ(keys, (std::vector<int>{49}));
+
+    zp::enqueue(&queue, MoveEvt{1.0f, 0.0f});
+    zp::enqueue(&queue, MoveEvt{-1.0f, 0.0f});
+    zp::enqueue(&queue, MoveEvt{-1.0f, 0.0f});
+    zp::dispatch_all(&queue);
+    ASSERT_EQ(moves.size(), 3u);
+    EXPECT_FLOAT_EQ(moves[1].dx, 1.0f);
+    EXPECT_FLOAT_EQ(moves[2].dx, -2.0f);
+
+    ASSERT_EQ(zp::queue_coalesce<KeyEvt>(&queue, zp::Coalesce::KEEP_ALL), zp::Result::ZC_SUCCESS);
+    zp::enqueue(&queue, KeyEvt{1});
+    zp::enqueue(&queue, KeyEvt{2});
+    zp::dispatch_all(&queue);
+    EXPECT_EQ(keys, (std::vector<int>{49, 1, 2}));
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// AccumulateNeedsMerge: Validates ACCUMULATE without a merge function is refused and leaves the type's previous policy in place,
+// so enqueue never reaches a null merge.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(EventQueueTest, AccumulateNeedsMerge)
+{
+    zp::event_queue queue;
+    std::vector<int> keys;
+    const zp::subscription on_key = zp::queue_subscribe<KeyEvt>(&queue, [&](const KeyEvt& key) { keys.push_back(key.key); });
+
+    EXPECT_EQ(zp::queue_coalesce<KeyEvt>(&queue, zp::Coalesce::ACCUMULATE), zp::Result::ZC_INVALID_ARGUMENT);
+    zp::enqueue(&queue, KeyEvt{1});
+    zp::enqueue(&queue, KeyEvt{2});
+    zp::dispatch_all(&queue);
+    EXPECT_EQ(keys, (std::vector<int>{1, 2}));
+
+    ASSERT_EQ(zp::queue_coalesce<KeyEvt>(&queue, zp::Coalesce::KEEP_LATEST), zp::Result::ZC_SUCCESS);
+    EXPECT_EQ(zp::queue_coalesce<KeyEvt>(&queue, zp::Coalesce::ACCUMULATE), zp::Result::ZC_INVALID_ARGUMENT);
+    zp::enqueue(&queue, KeyEvt{3});
+    zp::enqueue(&queue, KeyEvt{4});
+    zp::dispatch_all(&queue);
+    EXPECT_EQ(keys, (std::vector<int>{1, 2, 4}));
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// KeepsDiscreteInputInOrder: Validates typed characters and key presses interleave as they arrived, so a backspace removes the
+// character before it, and that a coalesced move stream lands at the position of its newest sample.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(EventQueueTest, KeepsDiscreteInputInOrder)
+{
+    zp::event_queue queue;
+    std::string text;
+    std::string trace;
+
+    const auto merge_move = [](MoveEvt* p_into, const MoveEvt& next)
+    {
+        p_into->dx += next.dx;
+        p_into->dy += next.dy;
+        return true;
+    };
+    const auto type_char = [&](const CharEvt& evt)
+    {
+        text  += evt.c;
+        trace += evt.c;
+    };
+    const auto press_key = [&](const KeyEvt& evt)
+    {
+        if (evt.key == KEY_BACKSPACE && !text.empty())
+        {
+            text.pop_back();
+        }
+        trace += "<" + std::to_string(evt.key) + ">";
+    };
+    ASSERT_EQ(zp::queue_coalesce<MoveEvt>(&queue, zp::Coalesce::ACCUMULATE, +merge_move), zp::Result::ZC_SUCCESS);
+    const zp::subscription on_char = zp::queue_subscribe<CharEvt>(&queue, type_char);
+    const zp::subscription on_key  = zp::queue_subscribe<KeyEvt>(&queue, press_key);
+    const zp::subscription on_move = zp::queue_subscribe<MoveEvt>(&queue, [&](const MoveEvt& evt) { trace += "M" + std::to_string(static_cast<int>(evt.dx)); });
+
+    zp::enqueue(&queue, CharEvt{'a'});
+    zp::enqueue(&queue, MoveEvt{1.0f, 0.0f});
+    zp::enqueue(&queue, KeyEvt{KEY_BACKSPACE});
+    zp::enqueue(&queue, CharEvt{'b'});
+    zp::enqueue(&queue, MoveEvt{2.0f, 0.0f});
+    zp::enqueue(&queue, CharEvt{'c'});
+    EXPECT_EQ(zp::queue_pending(&queue), 5u);
+
+    zp::dispatch_all(&queue);
+    EXPECT_EQ(text, "bc");
+    EXPECT_EQ(trace, "a<8>bM3c");
+
+    // the order holds across frames whose types were first seen in a different order.
+    zp::enqueue(&queue, KeyEvt{KEY_BACKSPACE});
+    zp::enqueue(&queue, CharEvt{'d'});
+    zp::dispatch_all(&queue);
+    EXPECT_EQ(text, "bd");
+}
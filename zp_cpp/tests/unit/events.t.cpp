@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 #include "zp_cpp/events.hpp"
+#include "../alloc_counter.hpp"
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
 
 // ====================================================================================================================
 // ====================================================================================================================
@@ -9,9 +14,9 @@
 TEST(EventsTest, SubscribeAndTrigger)
 {
     zp::Event<int> evt;
-    int received = 0;
+    int received                      = 0;
 
-    evt.subscribe([&](int value) { received = value; });
+    const zp::subscription subscribed = evt.subscribe([&](int value) { received = value; });
 
     evt.trigger(42);
     EXPECT_EQ(received, 42);
@@ -19,20 +24,47 @@ TEST(EventsTest, SubscribeAndTrigger)
 
 // ====================================================================================================================
 // ====================================================================================================================
-// Unsubscribe: Validates removing a subscription stops callbacks from firing.
+// Unsubscribe: Validates resetting or destroying a subscription stops only its own callback, and stale tokens do nothing.
 // ====================================================================================================================
 // ====================================================================================================================
 TEST(EventsTest, Unsubscribe)
 {
     zp::Event<int> evt;
-    int received    = 0;
+    int a                  = 0;
+    int b                  = 0;
 
-    auto subscriber = [&](int value) { received = value; };
-    evt.subscribe(subscriber);
-    evt.unsubscribe(subscriber);
+    // the same lambda type subscribed twice: only the reset one stops.
+    const auto subscriber  = [](int* p_received) { return [p_received](int value) { *p_received = value; }; };
+    zp::subscription sub_a = evt.subscribe(subscriber(&a));
+    zp::subscription sub_b = evt.subscribe(subscriber(&b));
+    sub_a.reset();
+    EXPECT_FALSE(sub_a);
 
     evt.trigger(7);
-    EXPECT_EQ(received, 0);
+    EXPECT_EQ(a, 0);
+    EXPECT_EQ(b, 7);
+
+    // moving the token keeps the subscription; the moved-from token no longer owns it.
+    zp::subscription moved = std::move(sub_b);
+    sub_b.reset();
+    evt.trigger(8);
+    EXPECT_EQ(b, 8);
+
+    {
+        const zp::subscription scoped = evt.subscribe(subscriber(&a));
+        EXPECT_EQ(evt.listener_count(), 2u);
+    }
+    evt.trigger(9);
+    EXPECT_EQ(a, 0);
+    EXPECT_EQ(evt.listener_count(), 1u);
+
+    // a token outliving its event is harmless.
+    zp::subscription orphan;
+    {
+        zp::Event<int> temporary;
+        orphan = temporary.subscribe([](int) {});
+    }
+    orphan.reset();
 }
 
 // ====================================================================================================================
@@ -43,10 +75,143 @@ TEST(EventsTest, Unsubscribe)
 TEST(EventsTest, VoidEventTrigger)
 {
     zp::VoidEvent evt;
-    bool called = false;
+    bool called                       = false;
 
-    evt.subscribe([&](zp::Void) { called = true; });
+    const zp::subscription subscribed = evt.subscribe([&](zp::Void) { called = true; });
 
     evt.trigger({});
     EXPECT_TRUE(called);
 }
+
+// ====================================================================================================================
+// ====================================================================================================================
+// TriggerDoesNotAllocate: Validates trigger makes no heap allocations however many listeners are subscribed.
+// ====================================================================================================================
+// ====================================================================================================================
+TEST(EventsTest, TriggerDoesNotAllocate)
+{
+    zp::Event<int> evt;
+    int sum = 0;
+    std::vector<zp::subscription> subscriptions;
+    for (int i = 0; i < 64; ++i)
+    {
+        subscriptions.push_back(evt.subscribe([&sum, i](int value) { sum += value + i; }));
+    }
+
+    const std::size_t before = zp::test::allocations.load();
+    for (int i = 0; i < 1000; ++i)
+    {
+        evt.trigger(1);
+    }
+    EXPECT_EQ(zp::test::allocations.load(), before);
+    EXPECT_EQ(sum, 1000 * (64 + 63 * 64 / 2));
+}
+
+// ====================================================================================================================
+// ====================================================================================================================
+// ChangesDuringTrigger: Validates listeners may subscribe and unsubscribe mid-trigger, taking effect from the next trigger.
+// ====================================================================================================================
+// ====================================================================================================================
+TEST(EventsTest, ChangesDuringTrigger)
+{
+    zp::Event<int> evt;
+    int first_calls  = 0;
+    int second_calls = 0;
+    zp::subscription second;
+
+    // the first listener adds the second on its first call and removes both on its third, including itself.
+    zp::subscription first;
+    first = evt.subscribe(
+        [&](int)
+        {
+            ++first_calls;
+            if (first_calls == 1)
+            {
+                second = evt.subscribe([&](int) { ++second_calls; });
+            }
+            else if (first_calls == 3)
+            {
+                second.reset();
+                first.reset();
+            }
+        });
+
+    evt.trigger(0);
+    EXPECT_EQ(second_calls, 0);
+    evt.trigger(0);
+    EXPECT_EQ(second_calls, 1);
+    evt.trigger(0);
+    EXPECT_EQ(second_calls, 1);
+    evt.trigger(0);
+    EXPECT_EQ(first_calls, 3);
+    EXPECT_EQ(evt.listener_count(), 0u);
+}
+
+// ====================================================================================================================
+// ====================================================================================================================
+// SmallFunctionStorage: Validates small callables are stored inline and large ones survive copies and moves on the heap.
+// ====================================================================================================================
+// ====================================================================================================================
+TEST(EventsTest, SmallFunctionStorage)
+{
+    const auto owner   = std::make_shared<int>(5);
+
+    std::size_t before = zp::test::allocations.load();
+    zp::small_function<int(int)> small([owner](int value) { return *owner + value; });
+    zp::small_function<int(int)> small_copy = small;
+    zp::small_function<int(int)> small_move = std::move(small_copy);
+    EXPECT_EQ(zp::test::allocations.load(), before);
+    EXPECT_FALSE(small_copy);
+    EXPECT_EQ(small_move(1), 6);
+    EXPECT_EQ(owner.use_count(), 3);
+
+    std::array<std::string, 4> names = {"a", "b", "c", "d"};
+    before                           = zp::test::allocations.load();
+    zp::small_function<std::string(int)> large([names](int i) { return names[i]; });
+    EXPECT_EQ(zp::test::allocations.load(), before + 1);
+    zp::small_function<std::string(int)> large_copy = large;
+    large                                           = std::move(large_copy);
+    EXPECT_EQ(large(2), "c");
+
+    small_move = {};
+    EXPECT_EQ(owner.use_count(), 2);
+}
+
+// ====================================================================================================================
+// ====================================================================================================================
+// SubscribeUnsubscribeCycles: Validates 10k subscribe/unsubscribe cycles against a populated event keep every listener
+// live exactly once, and that after one warm-up cycle they reuse the freed slot without allocating.
+// ====================================================================================================================
+// ====================================================================================================================
+TEST(EventsTest, SubscribeUnsubscribeCycles)
+{
+    constexpr int LISTENERS = 1000;
+    constexpr int CYCLES    = 10'000;
+
+    zp::Event<int> evt;
+    int sum = 0;
+    std::vector<zp::subscription> subscriptions;
+    for (int i = 0; i < LISTENERS; ++i)
+    {
+        subscriptions.push_back(evt.subscribe([&sum](int value) { sum += value; }));
+    }
+
+    // the first release sizes the free list.
+    subscriptions[0].reset();
+    subscriptions[0] = evt.subscribe([&sum](int value) { sum += value; });
+
+    // unsubscribe from the middle of the array each cycle, which a list walk would pay O(n) for. appending a slot instead of
+    // reusing the freed one would grow the slot deque and allocate within a few cycles.
+    const std::size_t before = zp::test::allocations.load();
+    for (int i = 0; i < CYCLES; ++i)
+    {
+        const std::size_t index = static_cast<std::size_t>(i * 7919) % LISTENERS;
+        subscriptions[index].reset();
+        subscriptions[index] = evt.subscribe([&sum](int value) { sum += value; });
+    }
+    EXPECT_EQ(zp::test::allocations.load(), before);
+
+    EXPECT_EQ(evt.listener_count(), static_cast<std::size_t>(LISTENERS));
+    evt.trigger(1);
+    EXPECT_EQ(sum, LISTENERS);
+}
@@ -5,9 +5,13 @@
 #include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <future>
+#include <memory>
+#include <string>
 #include <system_error>
 #include <thread>
 #include <vector>
+#include <unistd.h>
 #include "../cmn.hpp"
 
 // =========================================================================================================================================
@@ -196,3 +200,301 @@ TEST(FilesTest, HasChangedDetectsFileUpdates)
     std::error_code ec;
     std::filesystem::remove(file_path, ec);
 }
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// AsyncWriterWritesFiles: Validates write_file_async() replaces file contents atomically and resolves futures with ZC_SUCCESS.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(FilesTest, AsyncWriterWritesFiles)
+{
+    const std::filesystem::path dir = zp::test::make_temp_path("zp_cpp_async_writer");
+    std::filesystem::create_directories(dir);
+
+    zp::files::async_writer writer;
+    zp::files::start_writer(&writer);
+
+    std::vector<std::future<zp::Result>> futures;
+    for (int i = 0; i < 8; ++i)
+    {
+        const std::string text = "payload " + std::to_string(i);
+        auto data              = std::make_shared<const std::vector<std::byte>>(reinterpret_cast<const std::byte*>(text.data()), reinterpret_cast<const std::byte*>(text.data()) + text.size());
+
+        std::future<zp::Result> future;
+        ASSERT_EQ(zp::files::write_file_async(&writer, dir / ("file_" + std::to_string(i) + ".txt"), data, &future), zp::Result::ZC_SUCCESS);
+        futures.push_back(std::move(future));
+    }
+
+    for (auto& future : futures)
+    {
+        EXPECT_EQ(future.get(), zp::Result::ZC_SUCCESS);
+    }
+
+    for (int i = 0; i < 8; ++i)
+    {
+        std::ifstream ifs(dir / ("file_" + std::to_string(i) + ".txt"), std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        EXPECT_EQ(content, "payload " + std::to_string(i));
+    }
+
+    const zp::files::async_writer::Metrics metrics = zp::files::get_metrics(&writer);
+    EXPECT_EQ(metrics.queue_depth, 0u);
+    EXPECT_EQ(metrics.bytes_in_flight, 0u);
+    EXPECT_EQ(metrics.writes_completed, 8u);
+    EXPECT_EQ(metrics.writes_failed, 0u);
+    EXPECT_GE(metrics.total_latency_ns, metrics.max_latency_ns);
+    EXPECT_LE(metrics.p50_latency_ns, metrics.p99_latency_ns);
+    EXPECT_LE(metrics.p99_latency_ns, metrics.max_latency_ns);
+
+    zp::files::stop_writer(&writer);
+
+    // only the final files remain; no temp files are left behind.
+    size_t file_count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir))
+    {
+        (void)entry;
+        ++file_count;
+    }
+    EXPECT_EQ(file_count, 8u);
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// AsyncWriterReportsFailures: Validates write_file_async() resolves with ZC_FILE_ACCESS_ERROR for unwritable paths.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(FilesTest, AsyncWriterReportsFailures)
+{
+    const std::filesystem::path invalid_path = zp::test::make_temp_path("zp_cpp_async_invalid_dir") / "file.txt";
+
+    zp::files::async_writer writer;
+    zp::files::start_writer(&writer);
+
+    auto data = std::make_shared<const std::vector<std::byte>>(4, std::byte{1});
+    std::future<zp::Result> future;
+    ASSERT_EQ(zp::files::write_file_async(&writer, invalid_path, data, &future), zp::Result::ZC_SUCCESS);
+    EXPECT_EQ(future.get(), zp::Result::ZC_FILE_ACCESS_ERROR);
+
+    EXPECT_EQ(zp::files::get_metrics(&writer).writes_failed, 1u);
+
+    zp::files::stop_writer(&writer);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// AsyncWriterRejectsWhenFull: Validates write_file_async() returns ZC_QUEUE_FULL instead of blocking once max_queued is reached.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(FilesTest, AsyncWriterRejectsWhenFull)
+{
+    const std::filesystem::path dir = zp::test::make_temp_path("zp_cpp_async_full");
+    std::filesystem::create_directories(dir);
+
+    zp::files::async_writer writer;
+    writer.config.max_queued = 0;
+    zp::files::start_writer(&writer);
+
+    auto data = std::make_shared<const std::vector<std::byte>>(4, std::byte{1});
+    std::future<zp::Result> future;
+    EXPECT_EQ(zp::files::write_file_async(&writer, dir / "file.bin", data, &future), zp::Result::ZC_QUEUE_FULL);
+
+    zp::files::stop_writer(&writer);
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// PollDirSnapshotWarmStart: Validates a watcher restored from a snapshot reports only changes made after the snapshot was saved.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(FilesTest, PollDirSnapshotWarmStart)
+{
+    const std::filesystem::path watch_dir     = zp::test::make_temp_path("zp_cpp_dir_snapshot");
+    const std::filesystem::path snapshot_path = zp::test::make_temp_path("zp_cpp_dir_snapshot", ".snap");
+    std::filesystem::create_directories(watch_dir / "sub_a");
+    std::filesystem::create_directories(watch_dir / "sub_b" / "deep");
+
+    auto write_text = [](const std::filesystem::path& path, const char* text)
+    {
+        std::ofstream ofs(path, std::ios::binary);
+        ofs << text;
+    };
+    write_text(watch_dir / "top.txt", "top");
+    write_text(watch_dir / "sub_a" / "kept.txt", "kept");
+    write_text(watch_dir / "sub_a" / "changed.txt", "before");
+    write_text(watch_dir / "sub_b" / "deep" / "removed.txt", "removed");
+
+    std::vector<std::filesystem::path> created;
+    std::vector<std::filesystem::path> modified;
+    std::vector<std::filesystem::path> destroyed;
+
+    // =================================================================================================
+    // =================================================================================================
+    // First process: cold poll reports everything, then the state is persisted.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        zp::files::dir_watcher watcher;
+        watcher.config.dir               = watch_dir;
+        watcher.config.on_file_created   = [&](const std::filesystem::path& path) { created.push_back(path); };
+        watcher.config.on_file_modified  = [&](const std::filesystem::path& path) { modified.push_back(path); };
+        watcher.config.on_file_destroyed = [&](const std::filesystem::path& path) { destroyed.push_back(path); };
+
+        zp::files::poll_dir(&watcher);
+        EXPECT_EQ(created.size(), 4u);
+        ASSERT_EQ(zp::files::save_snapshot(&watcher, snapshot_path), zp::Result::ZC_SUCCESS);
+    }
+
+    created.clear();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    write_text(watch_dir / "sub_a" / "changed.txt", "after!");
+    write_text(watch_dir / "sub_b" / "added.txt", "added");
+    std::filesystem::remove(watch_dir / "sub_b" / "deep" / "removed.txt");
+
+    // =================================================================================================
+    // =================================================================================================
+    // Second process: restore the snapshot so the first poll only reports real changes.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        zp::files::dir_watcher watcher;
+        watcher.config.dir               = watch_dir;
+        watcher.config.on_file_created   = [&](const std::filesystem::path& path) { created.push_back(path); };
+        watcher.config.on_file_modified  = [&](const std::filesystem::path& path) { modified.push_back(path); };
+        watcher.config.on_file_destroyed = [&](const std::filesystem::path& path) { destroyed.push_back(path); };
+
+        ASSERT_EQ(zp::files::load_snapshot(&watcher, snapshot_path), zp::Result::ZC_SUCCESS);
+        EXPECT_EQ(watcher.state.known.size(), 4u);
+
+        zp::files::poll_dir(&watcher);
+        ASSERT_EQ(created.size(), 1u);
+        EXPECT_EQ(created.front(), watch_dir / "sub_b" / "added.txt");
+        ASSERT_EQ(modified.size(), 1u);
+        EXPECT_EQ(modified.front(), watch_dir / "sub_a" / "changed.txt");
+        ASSERT_EQ(destroyed.size(), 1u);
+        EXPECT_EQ(destroyed.front(), watch_dir / "sub_b" / "deep" / "removed.txt");
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(watch_dir, ec);
+    std::filesystem::remove(snapshot_path, ec);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// PollDirHashContentsIgnoresTouch: Validates hash_contents suppresses modified events when only the timestamp changes.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(FilesTest, PollDirHashContentsIgnoresTouch)
+{
+    const std::filesystem::path watch_dir = zp::test::make_temp_path("zp_cpp_dir_hash");
+    std::filesystem::create_directories(watch_dir);
+
+    const std::filesystem::path file_path = watch_dir / "same.txt";
+    {
+        std::ofstream ofs(file_path, std::ios::binary);
+        ofs << "same";
+    }
+
+    size_t modified_count = 0;
+
+    zp::files::dir_watcher watcher;
+    watcher.config.dir               = watch_dir;
+    watcher.config.hash_contents     = true;
+    watcher.config.on_file_created   = [](const std::filesystem::path&) {};
+    watcher.config.on_file_modified  = [&](const std::filesystem::path&) { ++modified_count; };
+    watcher.config.on_file_destroyed = [](const std::filesystem::path&) {};
+
+    zp::files::poll_dir(&watcher);
+
+    std::filesystem::last_write_time(file_path, std::filesystem::last_write_time(file_path) + std::chrono::seconds(1));
+    zp::files::poll_dir(&watcher);
+    EXPECT_EQ(modified_count, 0u);
+
+    {
+        std::ofstream ofs(file_path, std::ios::binary);
+        ofs << "diff";
+    }
+    std::filesystem::last_write_time(file_path, std::filesystem::last_write_time(file_path) + std::chrono::seconds(2));
+    zp::files::poll_dir(&watcher);
+    EXPECT_EQ(modified_count, 1u);
+
+    std::error_code ec;
+    std::filesystem::remove_all(watch_dir, ec);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// LoadSnapshotRejectsGarbage: Validates load_snapshot() reports missing and malformed snapshot files.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(FilesTest, LoadSnapshotRejectsGarbage)
+{
+    const std::filesystem::path snapshot_path = zp::test::make_temp_path("zp_cpp_bad_snapshot", ".snap");
+
+    zp::files::dir_watcher watcher;
+    EXPECT_EQ(zp::files::load_snapshot(&watcher, snapshot_path), zp::Result::ZC_FILE_NOT_FOUND);
+
+    {
+        std::ofstream ofs(snapshot_path, std::ios::binary);
+        ofs << "definitely not a snapshot";
+    }
+    EXPECT_EQ(zp::files::load_snapshot(&watcher, snapshot_path), zp::Result::ZC_INVALID_FORMAT);
+
+    std::error_code ec;
+    std::filesystem::remove(snapshot_path, ec);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// PollDirSkipsFailingSubdirs: Validates a subdirectory deleted or unreadable between polls only affects its own files, never
+// the rest of its root. The unreadable half needs a user that permissions apply to, so it is skipped when running as root.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(FilesTest, PollDirSkipsFailingSubdirs)
+{
+    const std::filesystem::path watch_dir = zp::test::make_temp_path("zp_cpp_dir_watcher_failing");
+    const std::filesystem::path kept      = watch_dir / "root" / "kept.txt";
+    const std::filesystem::path gone      = watch_dir / "root" / "gone" / "file.txt";
+    const std::filesystem::path locked    = watch_dir / "root" / "locked" / "file.txt";
+    for (const std::filesystem::path& path : {kept, gone, locked})
+    {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream ofs(path, std::ios::binary);
+        ofs << "x";
+    }
+
+    zp::files::dir_watcher watcher;
+    watcher.config.dir = watch_dir;
+    std::vector<std::filesystem::path> created;
+    std::vector<std::filesystem::path> destroyed;
+    watcher.config.on_file_created   = [&](const std::filesystem::path& path) { created.push_back(path); };
+    watcher.config.on_file_modified  = [](const std::filesystem::path&) {};
+    watcher.config.on_file_destroyed = [&](const std::filesystem::path& path) { destroyed.push_back(path); };
+
+    zp::files::poll_dir(&watcher);
+    EXPECT_EQ(created.size(), 3u);
+
+    std::error_code ec;
+    std::filesystem::remove_all(gone.parent_path(), ec);
+    zp::files::poll_dir(&watcher);
+    EXPECT_EQ(destroyed, std::vector<std::filesystem::path>{gone});
+    EXPECT_EQ(created.size(), 3u);
+
+    if (::geteuid() != 0)
+    {
+        std::filesystem::permissions(locked.parent_path(), std::filesystem::perms::none);
+        zp::files::poll_dir(&watcher);
+        zp::files::poll_dir(&watcher);
+        std::filesystem::permissions(locked.parent_path(), std::filesystem::perms::owner_all);
+        EXPECT_EQ(destroyed, std::vector<std::filesystem::path>{gone});
+        EXPECT_EQ(created.size(), 3u);
+    }
+
+    std::filesystem::remove_all(watch_dir, ec);
+}
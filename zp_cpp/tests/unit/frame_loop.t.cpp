@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+#include "zp_cpp/frame_loop.hpp"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// StagesRunInFixedOrder: Validates every frame runs its stages in order and, on a manual virtual clock, that simulation runs
+// exactly the whole steps that fit in the time that has passed.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(FrameLoopTest, StagesRunInFixedOrder)
+{
+    zp::clock::use_virtual_clock(0, 0.0);
+    zp::frame_loop loop;
+    loop.config.sim_step_ns = 2'000'000;
+
+    std::string trace;
+    zp::ens simulated      = 0;
+    float max_alpha        = 0.0f;
+    loop.stages.poll_input = [&]() { trace += 'P'; };
+    loop.stages.receive    = [&]() { trace += 'R'; };
+    loop.stages.simulate   = [&](zp::ens step_ns)
+    {
+        trace     += 'S';
+        simulated += step_ns;
+    };
+    loop.stages.send       = [&]() { trace += 'N'; };
+    loop.stages.update_ui  = [&]() { trace += 'U'; };
+    loop.stages.render     = [&](float alpha)
+    {
+        trace     += 'D';
+        max_alpha  = std::max(max_alpha, alpha);
+        zp::clock::advance_virtual_clock(700'000);
+    };
+
+    zp::loop_init(&loop);
+    int frames = 0;
+    zp::loop_run(&loop, [&]() { return frames++ < 60; });
+
+    for (std::size_t pos = 0, frame = 0; pos < trace.size(); ++frame)
+    {
+        ASSERT_EQ(trace.compare(pos, 2, "PR"), 0) << "frame " << frame << ": " << trace;
+        pos += 2;
+        while (trace[pos] == 'S')
+        {
+            ++pos;
+        }
+        ASSERT_EQ(trace.compare(pos, 3, "NUD"), 0) << "frame " << frame << ": " << trace;
+        pos += 3;
+    }
+
+    // the last frame starts 59 renders in, and simulation has run every whole step of that.
+    const zp::stats::Summary summary = zp::stats::summarize(zp::loop_frame_times(&loop));
+    EXPECT_EQ(loop.state.frames, 60u);
+    EXPECT_EQ(loop.state.sim_steps, 59u * 700'000 / 2'000'000);
+    EXPECT_EQ(loop.state.dropped_steps, 0u);
+    EXPECT_EQ(simulated, loop.state.sim_steps * loop.config.sim_step_ns);
+    EXPECT_LT(max_alpha, 1.0f);
+    EXPECT_EQ(summary.count, 59u);
+    EXPECT_EQ(summary.min, 700'000u);
+    EXPECT_EQ(summary.max, 700'000u);
+    zp::loop_exit(&loop);
+    zp::clock::set_source(nullptr);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// CatchUpIsClamped: Validates a long stall runs at most max_steps_per_frame steps and drops the rest.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(FrameLoopTest, CatchUpIsClamped)
+{
+    zp::clock::use_virtual_clock(0, 0.0);
+    zp::frame_loop loop;
+    loop.config.sim_step_ns         = 1'000'000;
+    loop.config.max_steps_per_frame = 3;
+
+    std::uint64_t last_steps        = 0;
+    bool stall                      = true;
+    loop.stages.simulate            = [&](zp::ens) { ++last_steps; };
+    loop.stages.render              = [&](float)
+    {
+        if (stall)
+        {
+            zp::clock::advance_virtual_clock(30'000'000);
+            stall = false;
+        }
+    };
+
+    zp::loop_init(&loop);
+    zp::loop_frame(&loop);
+    last_steps = 0;
+    zp::loop_frame(&loop);
+
+    EXPECT_EQ(last_steps, 3u);
+    EXPECT_EQ(loop.state.dropped_steps, 27u);
+    EXPECT_EQ(loop.state.alpha, 0.0f);
+    zp::loop_exit(&loop);
+    zp::clock::set_source(nullptr);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// PacesToTargetFrameTime: Validates on a manual virtual clock that pacing holds every frame interval at exactly its target, and
+// that a frame which runs over is followed by a full-length frame rather than a short one rushing to catch up.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(FrameLoopTest, PacesToTargetFrameTime)
+{
+    zp::clock::use_virtual_clock(0, 0.0);
+    zp::frame_loop loop;
+    loop.config.target_frame_ns = 4'000'000;
+
+    std::vector<zp::ens> starts;
+    int frames             = 0;
+    loop.stages.poll_input = [&]() { starts.push_back(zp::now()); };
+    loop.stages.render     = [&](float) { zp::clock::advance_virtual_clock(frames == 50 ? 6'000'000 : 500'000); };
+
+    zp::loop_init(&loop);
+    zp::loop_run(&loop, [&]() { return frames++ < 100; });
+
+    // frame 49 (the 50th call) overran to 6 ms; frame 50 starts when it ended and frame 51 a full target later.
+    ASSERT_EQ(starts.size(), 100u);
+    for (std::size_t i = 1; i < starts.size(); ++i)
+    {
+        EXPECT_EQ(starts[i] - starts[i - 1], i == 50 ? 6'000'000u : 4'000'000u) << "frame " << i;
+    }
+
+    const zp::stats::Summary summary = zp::stats::summarize(zp::loop_work_times(&loop));
+    EXPECT_EQ(summary.min, 500'000u);
+    EXPECT_EQ(summary.max, 6'000'000u);
+    zp::loop_exit(&loop);
+    zp::clock::set_source(nullptr);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// PacesOnRealClock: Smoke test of sleep/spin pacing against real time. The virtual clock tests pin down the exact behaviour; this
+// only checks the median loosely, since a loaded machine can preempt any frame and the next one then runs short.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(FrameLoopTest, PacesOnRealClock)
+{
+    zp::frame_loop loop;
+    loop.config.target_frame_ns = 4'000'000;
+    loop.stages.render          = [](float) { std::this_thread::sleep_for(std::chrono::microseconds(500)); };
+
+    zp::loop_init(&loop);
+    int frames = 0;
+    zp::loop_run(&loop, [&]() { return frames++ < 50; });
+
+    const zp::stats::Summary summary = zp::stats::summarize(zp::loop_frame_times(&loop));
+    EXPECT_EQ(summary.count, 49u);
+    EXPECT_GT(summary.p50, 3'000'000u);
+    EXPECT_LT(summary.p50, 6'000'000u);
+
+    const zp::stats::Summary work = zp::stats::summarize(zp::loop_work_times(&loop));
+    EXPECT_EQ(work.count, 50u);
+    EXPECT_GE(work.min, 500'000u);
+    zp::loop_exit(&loop);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// VirtualClock: Validates a manual virtual clock runs a paced loop through an hour of frames without waiting, deterministically,
+// and that a scaled virtual clock runs at its rate.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(FrameLoopTest, VirtualClock)
+{
+    constexpr std::uint64_t FRAMES = 60 * 60 * 60;
+
+    const auto run                 = [](std::uint64_t* p_steps) -> zp::ens
+    {
+        zp::clock::use_virtual_clock(0, 0.0);
+
+        zp::frame_loop loop;
+        loop.config.sim_step_ns     = 10'000'000;
+        loop.config.target_frame_ns = 16'666'667;
+        loop.stages.render          = [](float) { zp::clock::advance_virtual_clock(3'000'000); };
+        zp::loop_init(&loop);
+        for (std::uint64_t i = 0; i < FRAMES; ++i)
+        {
+            zp::loop_frame(&loop);
+        }
+        *p_steps = loop.state.sim_steps;
+        zp::loop_exit(&loop);
+        return zp::now();
+    };
+
+    std::uint64_t steps_a = 0;
+    std::uint64_t steps_b = 0;
+    const auto real_start = std::chrono::steady_clock::now();
+    const zp::ens ended_a = run(&steps_a);
+    const double real_ms  = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - real_start).count();
+    const zp::ens ended_b = run(&steps_b);
+
+    EXPECT_EQ(ended_a, FRAMES * 16'666'667);
+    EXPECT_EQ(ended_a, ended_b);
+    EXPECT_EQ(steps_a, steps_b);
+    EXPECT_EQ(steps_a, (FRAMES - 1) * 16'666'667 / 10'000'000);
+    EXPECT_LT(real_ms, 5000.0);
+
+    // at 50x, 500 virtual ms pass in about 10 real ms.
+    zp::clock::use_virtual_clock(1'000'000'000, 50.0);
+    const auto scaled_start = std::chrono::steady_clock::now();
+    zp::clock::sleep_until(1'500'000'000);
+    const double scaled_ms  = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - scaled_start).count();
+    EXPECT_GE(zp::now(), 1'500'000'000u);
+    EXPECT_GE(scaled_ms, 9.0);
+    EXPECT_LT(scaled_ms, 100.0);
+
+    zp::clock::set_source(nullptr);
+    const zp::ens real = zp::clock::fast_ns();
+    EXPECT_GE(zp::now(), real);
+}
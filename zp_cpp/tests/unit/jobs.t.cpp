@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include "zp_cpp/jobs.hpp"
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // counts fib(n) leaves the slow way, one job per call, waiting for both halves inside the job.
+    std::uint64_t fib_jobs(std::uint32_t n)
+    {
+        if (n < 2)
+        {
+            return n;
+        }
+
+        std::uint64_t a = 0;
+        std::uint64_t b = 0;
+        zp::jobs::counter done;
+        zp::jobs::run([&a, n]() { a = fib_jobs(n - 1); }, &done);
+        zp::jobs::run([&b, n]() { b = fib_jobs(n - 2); }, &done);
+        zp::jobs::wait(&done);
+        return a + b;
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// RunsInlineWithoutPool: Validates every entry point works before init by running the work on the calling thread.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(JobsTest, RunsInlineWithoutPool)
+{
+    EXPECT_EQ(zp::jobs::worker_count(), 1u);
+    EXPECT_EQ(zp::jobs::worker_index(), -1);
+
+    zp::jobs::counter done;
+    int ran = 0;
+    zp::jobs::run([&]() { ++ran; }, &done);
+    EXPECT_EQ(ran, 1);
+    EXPECT_EQ(done.pending.load(), 0u);
+    zp::jobs::wait(&done);
+
+    std::uint64_t calls = 0;
+    std::uint64_t total = 0;
+    zp::jobs::parallel_for(
+        10,
+        20,
+        [&](std::uint64_t first, std::uint64_t last)
+        {
+            ++calls;
+            total += last - first;
+        });
+    EXPECT_EQ(calls, 1u);
+    EXPECT_EQ(total, 10u);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ParallelForCoversRangeOnce: Validates parallel_for hands out every index exactly once for automatic and explicit grains,
+// from worker 0 and from a thread outside the pool.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(JobsTest, ParallelForCoversRangeOnce)
+{
+    constexpr std::uint64_t COUNT = 100'000;
+
+    zp::jobs::init({.worker_count = 4});
+    EXPECT_EQ(zp::jobs::worker_count(), 4u);
+    EXPECT_EQ(zp::jobs::worker_index(), 0);
+
+    const auto cover = [](std::uint64_t grain)
+    {
+        std::unique_ptr<std::atomic<std::uint32_t>[]> hits(new std::atomic<std::uint32_t>[COUNT]());
+        zp::jobs::parallel_for(
+            0,
+            COUNT,
+            [&](std::uint64_t first, std::uint64_t last)
+            {
+                for (std::uint64_t i = first; i < last; ++i)
+                {
+                    hits[i].fetch_add(1, std::memory_order_relaxed);
+                }
+            },
+            grain);
+
+        std::uint64_t wrong = 0;
+        for (std::uint64_t i = 0; i < COUNT; ++i)
+        {
+            wrong += hits[i].load() != 1;
+        }
+        return wrong;
+    };
+
+    for (const std::uint64_t grain : {std::uint64_t{0}, std::uint64_t{1}, std::uint64_t{7}, std::uint64_t{4096}, COUNT * 2})
+    {
+        EXPECT_EQ(cover(grain), 0u) << "grain " << grain;
+    }
+
+    std::uint64_t outside_wrong = 1;
+    std::thread outside([&]() { outside_wrong = cover(0); });
+    outside.join();
+    EXPECT_EQ(outside_wrong, 0u);
+
+    zp::jobs::shutdown();
+    EXPECT_EQ(zp::jobs::worker_count(), 1u);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// NestedWaits: Validates jobs that spawn jobs and wait on them inside the pool finish without deadlocking, including with
+// pinned workers and while another thread submits through the injection queue.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(JobsTest, NestedWaits)
+{
+    zp::jobs::init({.worker_count = 3, .pin_workers = true});
+
+    std::atomic<int> injected = 0;
+    zp::jobs::counter outside_done;
+    std::thread outside(
+        [&]()
+        {
+            for (int i = 0; i < 1000; ++i)
+            {
+                zp::jobs::run([&]() { injected.fetch_add(1); }, &outside_done);
+            }
+            zp::jobs::wait(&outside_done);
+        });
+
+    EXPECT_EQ(fib_jobs(18), 2584u);
+    outside.join();
+    EXPECT_EQ(injected.load(), 1000);
+
+    zp::jobs::shutdown();
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ShutdownDrains: Validates shutdown runs jobs still queued, so a fire-and-forget job is never lost.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(JobsTest, ShutdownDrains)
+{
+    zp::jobs::init({.worker_count = 2});
+    std::atomic<int> ran = 0;
+    for (int i = 0; i < 10'000; ++i)
+    {
+        zp::jobs::run([&]() { ran.fetch_add(1, std::memory_order_relaxed); });
+    }
+    zp::jobs::shutdown();
+    EXPECT_EQ(ran.load(), 10'000);
+}
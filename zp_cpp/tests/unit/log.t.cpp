@@ -1,9 +1,18 @@
 #include <gtest/gtest.h>
 #include "zp_cpp/log.hpp"
+#include "zp_cpp/compress.hpp"
 #include "../cmn.hpp"
 #include <fstream>
 #include <filesystem>
+#include <algorithm>
 #include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 // =========================================================================================================================================
 // =========================================================================================================================================
@@ -111,4 +120,484 @@ TEST(LoggerTest, TimestampFormatting)
     }
 
     std::filesystem::remove(test_log_file);
-}
\ No newline at end of file
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// AsyncManyThreadsKeepsLines: Validates 16 producers through small wrapping rings lose no lines, never interleave partial lines and
+// keep each thread's lines in order.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(LoggerTest, AsyncManyThreadsKeepsLines)
+{
+    const std::filesystem::path test_log_file = zp::test::make_temp_path("zp_cpp_log_async", ".log");
+    constexpr int THREADS                     = 16;
+    constexpr int LINES                       = 2000;
+
+    // =================================================================================================
+    // =================================================================================================
+    // Log from every thread at once into 4K rings so producers wrap and wait on the writer.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        zp::log::Logger logger          = {};
+        logger.config.async             = true;
+        logger.config.ring_bytes        = 4096;
+        logger.config.flush_interval_ms = 1;
+        zp::log::init(&logger, test_log_file);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t)
+        {
+            threads.emplace_back([&logger, t]() {
+                for (int i = 0; i < LINES; ++i)
+                {
+                    zp::log::log(&logger, zp::log::Logger::INFO, "thread " + std::to_string(t) + " line " + std::to_string(i));
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        zp::log::cleanup(&logger);
+    }
+
+    // =================================================================================================
+    // =================================================================================================
+    // Every line must be whole, and each thread's sequence numbers must appear exactly once in order.
+    // =================================================================================================
+    // =================================================================================================
+    {
+        std::ifstream log_file(test_log_file);
+        std::vector<int> next(THREADS, 0);
+        std::string line;
+        int total = 0;
+        while (std::getline(log_file, line))
+        {
+            int t = -1;
+            int i = -1;
+            ASSERT_EQ(std::sscanf(line.c_str() + line.find("thread "), "thread %d line %d", &t, &i), 2) << line;
+            ASSERT_GE(t, 0);
+            ASSERT_LT(t, THREADS);
+            EXPECT_EQ(i, next[t]);
+            next[t] = i + 1;
+            ++total;
+        }
+        EXPECT_EQ(total, THREADS * LINES);
+    }
+
+    std::filesystem::remove(test_log_file);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// AsyncDrainsOnFatalSignal: Validates lines still sitting in the rings reach the file when the process aborts before the writer runs.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(LoggerTest, AsyncDrainsOnFatalSignal)
+{
+    const std::filesystem::path test_log_file = zp::test::make_temp_path("zp_cpp_log_crash", ".log");
+
+    const pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0)
+    {
+        zp::log::Logger logger          = {};
+        logger.config.async             = true;
+        logger.config.flush_interval_ms = 60000;
+        zp::log::init(&logger, test_log_file);
+        ZP_LOG_ERROR(&logger, "last words before abort");
+        abort();
+    }
+
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFSIGNALED(status));
+    EXPECT_EQ(WTERMSIG(status), SIGABRT);
+
+    std::ifstream log_file(test_log_file);
+    std::string content((std::istreambuf_iterator<char>(log_file)), std::istreambuf_iterator<char>());
+    EXPECT_NE(content.find("last words before abort"), std::string::npos);
+
+    std::filesystem::remove(test_log_file);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// AsyncDrainsDuringThreadChurn: Validates the fatal-signal drain survives rings changing hands, with short-lived producer threads
+// registering, exiting and handing their rings on while the process aborts, and still writes out a line left in a ring.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(LoggerTest, AsyncDrainsDuringThreadChurn)
+{
+    const std::filesystem::path test_log_file = zp::test::make_temp_path("zp_cpp_log_churn", ".log");
+
+    const pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0)
+    {
+        zp::log::Logger logger          = {};
+        logger.config.async             = true;
+        logger.config.flush_interval_ms = 1;
+        zp::log::init(&logger, test_log_file);
+
+        std::thread churn([&logger]() {
+            for (int i = 0;; ++i)
+            {
+                std::thread([&logger, i]() { zp::log::log(&logger, zp::log::Logger::INFO, "churn " + std::to_string(i)); }).join();
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        ZP_LOG_ERROR(&logger, "last words during churn");
+        abort();
+    }
+
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFSIGNALED(status));
+    EXPECT_EQ(WTERMSIG(status), SIGABRT);
+
+    std::ifstream log_file(test_log_file);
+    std::string content((std::istreambuf_iterator<char>(log_file)), std::istreambuf_iterator<char>());
+    EXPECT_NE(content.find("last words during churn"), std::string::npos);
+    EXPECT_NE(content.find("churn 0"), std::string::npos);
+
+    std::filesystem::remove(test_log_file);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// BinaryRecordsDecode: Validates binary records from typed sites and plain messages decode to the expected text and JSON, in both
+// sync and async mode.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(LoggerTest, BinaryRecordsDecode)
+{
+    for (const bool async : {false, true})
+    {
+        const std::filesystem::path test_log_file = zp::test::make_temp_path("zp_cpp_log_binary", ".bin");
+
+        // =========================================================================================
+        // =========================================================================================
+        // Write typed records, a plain message and a second section appended to the same file.
+        // =========================================================================================
+        // =========================================================================================
+        {
+            for (int section = 0; section < 2; ++section)
+            {
+                zp::log::Logger logger = {};
+                logger.config.async    = async;
+                logger.config.binary   = true;
+                zp::log::init(&logger, test_log_file);
+
+                const std::string name = "player";
+                ZP_LOGB_INFO(&logger, "section {} entity {} at {} hp {}", section, name, 1.5, -42);
+                ZP_LOGB_WARN(&logger, "flag={} tag={} {{literal}}", true, 'x');
+                ZP_LOG_ERROR(&logger, "plain message");
+                ZP_LOGB_INFO(&logger, "no arguments");
+
+                zp::log::cleanup(&logger);
+            }
+        }
+
+        // =========================================================================================
+        // =========================================================================================
+        // Decode as text and JSON.
+        // =========================================================================================
+        // =========================================================================================
+        {
+            std::ostringstream text;
+            ASSERT_EQ(zp::log::decode_binary(test_log_file, text, false), zp::Result::ZC_SUCCESS);
+            const std::string decoded = text.str();
+
+            EXPECT_NE(decoded.find("[INFO ] [log.t.cpp:"), std::string::npos) << decoded;
+            EXPECT_NE(decoded.find("section 0 entity player at 1.5 hp -42"), std::string::npos) << decoded;
+            EXPECT_NE(decoded.find("section 1 entity player at 1.5 hp -42"), std::string::npos) << decoded;
+            EXPECT_NE(decoded.find("[WARN ] "), std::string::npos) << decoded;
+            EXPECT_NE(decoded.find("flag=true tag=x {literal}"), std::string::npos) << decoded;
+            EXPECT_NE(decoded.find("plain message"), std::string::npos) << decoded;
+            EXPECT_NE(decoded.find("no arguments"), std::string::npos) << decoded;
+
+            std::regex timestamp_pattern(R"(^\[\d{4}-\d{2}-\d{2} \d{2}:\d{2}:\d{2}\.\d{6}\] )");
+            EXPECT_TRUE(std::regex_search(decoded, timestamp_pattern)) << decoded;
+            EXPECT_EQ(std::count(decoded.begin(), decoded.end(), '\n'), 8);
+
+            std::ostringstream json;
+            ASSERT_EQ(zp::log::decode_binary(test_log_file, json, true), zp::Result::ZC_SUCCESS);
+            EXPECT_NE(json.str().find("\"level\":\"WARN\",\"file\":\"log.t.cpp\""), std::string::npos) << json.str();
+            EXPECT_NE(json.str().find("\"msg\":\"flag=true tag=x {literal}\""), std::string::npos) << json.str();
+        }
+
+        std::filesystem::remove(test_log_file);
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// BinaryMacrosOnTextLogger: Validates binary call sites format immediately when the logger writes text.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(LoggerTest, BinaryMacrosOnTextLogger)
+{
+    const std::filesystem::path test_log_file = zp::test::make_temp_path("zp_cpp_log_text", ".log");
+
+    zp::log::Logger logger = {};
+    zp::log::init(&logger, test_log_file);
+    ZP_LOGB_INFO(&logger, "frame {} took {} ms", 7u, 16.5);
+    zp::log::cleanup(&logger);
+
+    std::ifstream log_file(test_log_file);
+    std::string content((std::istreambuf_iterator<char>(log_file)), std::istreambuf_iterator<char>());
+    EXPECT_NE(content.find("[INFO ] [log.t.cpp:"), std::string::npos) << content;
+    EXPECT_NE(content.find("] frame 7 took 16.5 ms"), std::string::npos) << content;
+
+    std::ostringstream decoded;
+    EXPECT_EQ(zp::log::decode_binary(test_log_file, decoded, false), zp::Result::ZC_INVALID_FORMAT);
+
+    std::filesystem::remove(test_log_file);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ModuleLevelsAndFormat: Validates std::format call sites and that a module's runtime level silences sites below it.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(LoggerTest, ModuleLevelsAndFormat)
+{
+    const std::filesystem::path test_log_file = zp::test::make_temp_path("zp_cpp_log_module", ".log");
+
+    zp::log::Logger logger = {};
+    zp::log::init(&logger, test_log_file);
+
+    int evaluated = 0;
+    ZP_LOG_INFO(&logger, "peer {} sent {} bytes", 3, 512);
+    zp::log::set_module_level(zp::log::MODULE_DEFAULT, zp::log::Logger::WARN);
+    ZP_LOG_INFO(&logger, "suppressed {}", ++evaluated);
+    ZP_LOG_WARN(&logger, "kept {:.1f}", 2.25);
+    zp::log::set_module_level(zp::log::MODULE_DEFAULT, zp::log::Logger::INFO);
+    ZP_LOG_INFO(&logger, "restored");
+    zp::log::cleanup(&logger);
+
+    EXPECT_EQ(evaluated, 0);
+
+    std::ifstream log_file(test_log_file);
+    std::string content((std::istreambuf_iterator<char>(log_file)), std::istreambuf_iterator<char>());
+    EXPECT_NE(content.find("[log.t.cpp:"), std::string::npos) << content;
+    EXPECT_NE(content.find("] peer 3 sent 512 bytes"), std::string::npos) << content;
+    EXPECT_EQ(content.find("suppressed"), std::string::npos) << content;
+    EXPECT_NE(content.find("] kept 2.2"), std::string::npos) << content;
+    EXPECT_NE(content.find("] restored"), std::string::npos) << content;
+
+    std::filesystem::remove(test_log_file);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ThrottledSites: Validates rate-limited and sampled sites bound their output and report what they dropped.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(LoggerTest, ThrottledSites)
+{
+    const std::filesystem::path test_log_file = zp::test::make_temp_path("zp_cpp_log_throttle", ".log");
+
+    zp::log::Logger logger = {};
+    zp::log::init(&logger, test_log_file);
+
+    const auto rate_site = [&](int i) { ZP_LOG_RATE_LIMITED(&logger, zp::log::Logger::WARN, 5, 5, "rate {}", i); };
+    for (int i = 0; i < 1000; ++i)
+    {
+        rate_site(i);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    rate_site(1000);
+    for (int i = 0; i < 100; ++i)
+    {
+        ZP_LOG_SAMPLED(&logger, zp::log::Logger::INFO, 10, "sample {}", i);
+    }
+    zp::log::cleanup(&logger);
+
+    std::ifstream log_file(test_log_file);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(log_file, line);)
+    {
+        lines.push_back(line);
+    }
+    const auto count_of = [&](const std::string& needle)
+    {
+        return std::count_if(lines.begin(), lines.end(), [&](const std::string& line) { return line.find(needle) != std::string::npos; });
+    };
+
+    // the burst passes, the refill after the sleep lets one more line and the summary of the flood through. the sampled site reports
+    // 9 ahead of its second line, and cleanup reports the 81 it dropped after that.
+    EXPECT_GE(count_of("] rate "), 6);
+    EXPECT_LE(count_of("] rate "), 8);
+    EXPECT_EQ(count_of("] rate 1000"), 1);
+    EXPECT_EQ(count_of("messages suppressed"), 3);
+    EXPECT_EQ(count_of("] sample "), 10);
+    EXPECT_EQ(count_of("] 9 messages suppressed"), 1);
+    EXPECT_EQ(count_of("] 81 messages suppressed"), 1);
+
+    std::filesystem::remove(test_log_file);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ReportsSuppressedAfterFloodStops: Validates the summary thread reports a throttled site that never logs again, without waiting
+// for cleanup.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(LoggerTest, ReportsSuppressedAfterFloodStops)
+{
+    const std::filesystem::path test_log_file = zp::test::make_temp_path("zp_cpp_log_flood", ".log");
+
+    zp::log::Logger logger = {};
+    zp::log::init(&logger, test_log_file);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        ZP_LOG_RATE_LIMITED(&logger, zp::log::Logger::WARN, 5, 5, "flood {}", i);
+    }
+
+    const auto read_all = [&]()
+    {
+        std::ifstream log_file(test_log_file);
+        return std::string((std::istreambuf_iterator<char>(log_file)), std::istreambuf_iterator<char>());
+    };
+
+    // the site is never called again, so only the summary thread can report the flood.
+    const std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    std::string content                               = read_all();
+    while (content.find("messages suppressed") == std::string::npos && std::chrono::steady_clock::now() < until)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        content = read_all();
+    }
+    zp::log::cleanup(&logger);
+
+    // every call is either a line or part of the one summary, which cleanup had nothing left to add to.
+    std::istringstream lines(read_all());
+    int flood_lines    = 0;
+    int summaries      = 0;
+    long long reported = 0;
+    for (std::string line; std::getline(lines, line);)
+    {
+        const std::size_t summary = line.find(" messages suppressed");
+        if (summary != std::string::npos)
+        {
+            const std::size_t start = line.rfind(' ', summary - 1) + 1;
+            reported               += std::stoll(line.substr(start, summary - start));
+            ++summaries;
+        }
+        else if (line.find("] flood ") != std::string::npos)
+        {
+            ++flood_lines;
+        }
+    }
+    EXPECT_EQ(summaries, 1) << content;
+    EXPECT_GE(flood_lines, 5);
+    EXPECT_EQ(flood_lines + reported, 1000);
+
+    std::filesystem::remove(test_log_file);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// RotatesBySizeAndCompresses: Validates size-based rotation keeps every line exactly once across the active file and the
+// compressed segments.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(LoggerTest, RotatesBySizeAndCompresses)
+{
+    const std::filesystem::path dir = zp::test::make_temp_path("zp_cpp_log_rotate");
+    std::filesystem::create_directories(dir);
+
+    zp::log::Logger logger          = {};
+    logger.config.rotate_bytes      = 8 * 1024;
+    logger.config.compress_segments = true;
+    zp::log::init(&logger, dir / "app.log");
+    for (int batch = 0; batch < 10; ++batch)
+    {
+        for (int i = 0; i < 200; ++i)
+        {
+            ZP_LOG_INFO(&logger, "line {}", batch * 200 + i);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    zp::log::cleanup(&logger);
+
+    std::string content;
+    std::size_t segments = 0;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(dir))
+    {
+        std::ifstream in(entry.path(), std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (entry.path().extension() == ".zplz")
+        {
+            std::vector<std::byte> decompressed;
+            ASSERT_EQ(zp::compress::decompress_frame(zp::span<const std::byte>{reinterpret_cast<const std::byte*>(bytes.data()), bytes.size()}, &decompressed), zp::Result::ZC_SUCCESS);
+            bytes.assign(reinterpret_cast<const char*>(decompressed.data()), decompressed.size());
+            ++segments;
+        }
+        else
+        {
+            EXPECT_EQ(entry.path().filename(), "app.log");
+        }
+        content += bytes;
+    }
+
+    EXPECT_GE(segments, 2u);
+    for (int i = 0; i < 2000; ++i)
+    {
+        char needle[32];
+        std::snprintf(needle, sizeof(needle), "] line %d\n", i);
+        const std::size_t first = content.find(needle);
+        ASSERT_NE(first, std::string::npos) << needle;
+        EXPECT_EQ(content.find(needle, first + 1), std::string::npos) << needle;
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// AsyncBinaryRotatesByTime: Validates time-based rotation of an async binary logger leaves segments that each decode on their own.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(LoggerTest, AsyncBinaryRotatesByTime)
+{
+    const std::filesystem::path dir = zp::test::make_temp_path("zp_cpp_log_rotate_async");
+    std::filesystem::create_directories(dir);
+
+    zp::log::Logger logger           = {};
+    logger.config.async              = true;
+    logger.config.binary             = true;
+    logger.config.flush_interval_ms  = 5;
+    logger.config.rotate_interval_ms = 40;
+    zp::log::init(&logger, dir / "app.bin");
+    for (int i = 0; i < 300; ++i)
+    {
+        ZP_LOGB_INFO(&logger, "tick {}", i);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    zp::log::cleanup(&logger);
+
+    std::string decoded;
+    std::size_t files = 0;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(dir))
+    {
+        std::ostringstream out;
+        EXPECT_EQ(zp::log::decode_binary(entry.path(), out, false), zp::Result::ZC_SUCCESS) << entry.path();
+        decoded += out.str();
+        ++files;
+    }
+
+    EXPECT_GE(files, 3u);
+    for (int i = 0; i < 300; ++i)
+    {
+        EXPECT_NE(decoded.find("] tick " + std::to_string(i) + "\n"), std::string::npos) << i;
+    }
+
+    std::filesystem::remove_all(dir);
+}
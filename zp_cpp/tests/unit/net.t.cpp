@@ -2,10 +2,39 @@
 
 #include <atomic>
 #include <chrono>
+#include <optional>
+#include <string>
 #include <thread>
+#include <vector>
 
+#include "zp_cpp/async.hpp"
 #include "zp_cpp/net.hpp"
 
+namespace
+{
+    // connects, waits for one event from the server, then disconnects, logging each step.
+    zp::task<void> handshake(zp::net::Instance* p_inst, std::vector<std::string>* p_log)
+    {
+        const bool connected = co_await zp::net::client::connect_async(p_inst);
+        p_log->push_back(connected ? "connected" : "connect failed");
+        if (!connected)
+        {
+            co_return;
+        }
+
+        const std::optional<zp::net::client::NetEvent> event = co_await zp::net::client::recv(p_inst);
+        p_log->push_back(event ? "event " + std::to_string(event->event_id) + " size " + std::to_string(event->param_bytes.size()) : "no event");
+
+        co_await zp::net::client::disconnect_async(p_inst);
+        p_log->push_back("disconnected");
+    }
+
+    zp::task<void> connect_into(zp::net::Instance* p_inst, std::optional<bool>* p_out)
+    {
+        *p_out = co_await zp::net::client::connect_async(p_inst);
+    }
+}
+
 // =========================================================================================================================================
 // =========================================================================================================================================
 // InitAndExit: Validates net::init() and net::exit() sequence succeeds without touching server/client state.
@@ -99,3 +128,132 @@ TEST(NetTest, ClientConnectsAndDisconnects)
     zp::net::server::stop_server(&instance);
     zp::net::exit(&instance);
 }
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// AsyncHandshakeWithPoller: Validates connect_async, recv and disconnect_async complete with the client's handle_incoming
+// registered as a poller on the same executor, each handshake ending exactly once on both sides.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(NetTest, AsyncHandshakeWithPoller)
+{
+    zp::net::Instance instance = {};
+
+    ASSERT_TRUE(zp::net::init(&instance));
+
+    instance.server_config.port = 0;
+    ASSERT_TRUE(zp::net::server::start_server(&instance));
+    ASSERT_TRUE(zp::net::client::start_client(&instance));
+
+    instance.client_config.server_addr = "127.0.0.1";
+    instance.client_config.server_port = zp::net::server::get_server_port(&instance);
+
+    zp::net::server::NetId client_id   = nullptr;
+    int connected_calls                = 0;
+    int disconnected_calls             = 0;
+    int server_disconnects             = 0;
+    const zp::subscription on_client   = instance.server_state.on_client_connected.subscribe([&](const zp::net::server::ClientConnectedEvt& evt) { client_id = evt.client_id; });
+    const zp::subscription on_gone     = instance.server_state.on_client_disconnected.subscribe([&](const zp::net::server::ClientDisconnectedEvt&) { ++server_disconnects; });
+    const zp::subscription on_up       = instance.client_state.on_connected_to_server.subscribe([&](const zp::Void&) { ++connected_calls; });
+    const zp::subscription on_down     = instance.client_state.on_disconnected_from_server.subscribe([&](const zp::Void&) { ++disconnected_calls; });
+
+    zp::executor exec;
+    zp::exec_init(&exec);
+    zp::exec_add_poller(&exec, [&]() { zp::net::server::handle_incoming(&instance); });
+    zp::exec_add_poller(&exec, [&]() { zp::net::client::handle_incoming(&instance); });
+
+    std::vector<std::string> log;
+    zp::exec_spawn(&exec, handshake(&instance, &log));
+
+    // the server sends once the task is parked in recv, so the event is handed to it rather than queued.
+    bool sent                                         = false;
+    const std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (exec.state.spawned > 0 && std::chrono::steady_clock::now() < until)
+    {
+        zp::exec_poll(&exec);
+        if (!sent && log.size() == 1 && client_id != nullptr)
+        {
+            zp::net::server::send_event(&instance, {{client_id}, 7, {1, 2, 3}});
+            sent = true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // let the server see the disconnect the client just completed.
+    for (int i = 0; i < 50 && server_disconnects == 0; ++i)
+    {
+        zp::exec_poll(&exec);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(exec.state.spawned, 0u);
+    EXPECT_EQ(log, (std::vector<std::string>{"connected", "event 7 size 3", "disconnected"}));
+    EXPECT_EQ(connected_calls, 1);
+    EXPECT_EQ(disconnected_calls, 1);
+    EXPECT_EQ(server_disconnects, 1);
+    EXPECT_FALSE(zp::net::client::is_connected_to_server(&instance));
+    zp::exec_exit(&exec);
+
+    zp::net::client::stop_client(&instance);
+    zp::net::server::stop_server(&instance);
+    zp::net::exit(&instance);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// AsyncConnectTimesOut: Validates connect_async gives up from the executor's timer once CONNECT_TIMEOUT_MS passes on a virtual
+// clock while the server never answers, and that a later handshake is not completed by the abandoned one.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(NetTest, AsyncConnectTimesOut)
+{
+    zp::net::Instance instance = {};
+
+    ASSERT_TRUE(zp::net::init(&instance));
+
+    instance.server_config.port = 0;
+    ASSERT_TRUE(zp::net::server::start_server(&instance));
+    ASSERT_TRUE(zp::net::client::start_client(&instance));
+
+    instance.client_config.server_addr = "127.0.0.1";
+    instance.client_config.server_port = zp::net::server::get_server_port(&instance);
+
+    int connected_calls                = 0;
+    const zp::subscription on_up       = instance.client_state.on_connected_to_server.subscribe([&](const zp::Void&) { ++connected_calls; });
+
+    zp::clock::use_virtual_clock(0, 0.0);
+    zp::executor exec;
+    zp::exec_init(&exec);
+    zp::exec_add_poller(&exec, [&]() { zp::net::client::handle_incoming(&instance); });
+
+    // the server host is never serviced, so the handshake cannot finish.
+    std::optional<bool> connected;
+    zp::exec_spawn(&exec, connect_into(&instance, &connected));
+    zp::clock::advance_virtual_clock(zp::ens{zp::net::client::CONNECT_TIMEOUT_MS - 1} * 1'000'000);
+    zp::exec_poll(&exec);
+    EXPECT_FALSE(connected.has_value());
+
+    zp::clock::advance_virtual_clock(2'000'000);
+    zp::exec_poll(&exec);
+    EXPECT_EQ(connected, false);
+    EXPECT_EQ(connected_calls, 0);
+    EXPECT_FALSE(zp::net::client::is_connected_to_server(&instance));
+
+    // a second attempt with the server serviced connects on its own handshake.
+    zp::exec_add_poller(&exec, [&]() { zp::net::server::handle_incoming(&instance); });
+    connected.reset();
+    zp::exec_spawn(&exec, connect_into(&instance, &connected));
+    for (int i = 0; i < 5000 && !connected.has_value(); ++i)
+    {
+        zp::exec_poll(&exec);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(connected, true);
+    EXPECT_EQ(connected_calls, 1);
+    zp::exec_exit(&exec);
+    zp::clock::set_source(nullptr);
+
+    zp::net::client::stop_client(&instance);
+    zp::net::server::stop_server(&instance);
+    zp::net::exit(&instance);
+}
@@ -0,0 +1,277 @@
+#include <gtest/gtest.h>
+#include "zp_cpp/core.hpp"
+#include "zp_cpp/pak.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../cmn.hpp"
+
+namespace
+{
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // write_text: Writes a text file, creating parent directories as needed.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void write_text(const std::filesystem::path& path, const std::string& text)
+    {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream ofs(path, std::ios::binary);
+        ofs << text;
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// PackOpenFind: Validates packed files are found by relative path with identical contents at 4K-aligned offsets.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(PakTest, PackOpenFind)
+{
+    const std::filesystem::path src_dir  = zp::test::make_temp_path("zp_cpp_pak_src");
+    const std::filesystem::path pak_path = zp::test::make_temp_path("zp_cpp_pak", ".pak");
+
+    write_text(src_dir / "a.txt", "alpha");
+    write_text(src_dir / "nested" / "b.txt", std::string(10000, 'b'));
+    write_text(src_dir / "nested" / "deeper" / "empty.txt", "");
+
+    ASSERT_EQ(zp::pak::pack_dir(src_dir, pak_path), zp::Result::ZC_SUCCESS);
+
+    zp::pak::Archive archive = {};
+    archive.config.path      = pak_path;
+    ASSERT_EQ(zp::pak::open(&archive), zp::Result::ZC_SUCCESS);
+
+    zp::span<const std::byte> data;
+    ASSERT_EQ(zp::pak::find(&archive, "a.txt", &data), zp::Result::ZC_SUCCESS);
+    ASSERT_EQ(data.count, 5u);
+    EXPECT_EQ(std::memcmp(data.p, "alpha", 5), 0);
+    EXPECT_EQ((data.p - archive.state.p_base) % zp::pak::ALIGNMENT, 0);
+
+    ASSERT_EQ(zp::pak::find(&archive, "nested/b.txt", &data), zp::Result::ZC_SUCCESS);
+    ASSERT_EQ(data.count, 10000u);
+    EXPECT_EQ(static_cast<char>(data.p[9999]), 'b');
+    EXPECT_EQ((data.p - archive.state.p_base) % zp::pak::ALIGNMENT, 0);
+
+    ASSERT_EQ(zp::pak::find(&archive, "nested/deeper/empty.txt", &data), zp::Result::ZC_SUCCESS);
+    EXPECT_EQ(data.count, 0u);
+
+    EXPECT_EQ(zp::pak::find(&archive, "missing.txt", &data), zp::Result::ZC_FILE_NOT_FOUND);
+    EXPECT_EQ(zp::pak::verify(&archive), zp::Result::ZC_SUCCESS);
+
+    zp::pak::close(&archive);
+    EXPECT_EQ(archive.state.p_base, nullptr);
+
+    std::error_code ec;
+    std::filesystem::remove_all(src_dir, ec);
+    std::filesystem::remove(pak_path, ec);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// VerifyDetectsCorruption: Validates verify() reports a checksum mismatch after an entry's bytes are modified on disk.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(PakTest, VerifyDetectsCorruption)
+{
+    const std::filesystem::path src_dir  = zp::test::make_temp_path("zp_cpp_pak_src");
+    const std::filesystem::path pak_path = zp::test::make_temp_path("zp_cpp_pak", ".pak");
+
+    write_text(src_dir / "payload.bin", "payload");
+    ASSERT_EQ(zp::pak::pack_dir(src_dir, pak_path), zp::Result::ZC_SUCCESS);
+
+    std::uint64_t offset;
+    {
+        zp::pak::Archive archive = {};
+        archive.config.path      = pak_path;
+        ASSERT_EQ(zp::pak::open(&archive), zp::Result::ZC_SUCCESS);
+        offset = zp::pak::find_entry(&archive, "payload.bin")->offset;
+        zp::pak::close(&archive);
+    }
+
+    {
+        std::fstream fs(pak_path, std::ios::binary | std::ios::in | std::ios::out);
+        fs.seekp(static_cast<std::streamoff>(offset));
+        fs.put('X');
+    }
+
+    zp::pak::Archive archive = {};
+    archive.config.path      = pak_path;
+    ASSERT_EQ(zp::pak::open(&archive), zp::Result::ZC_SUCCESS);
+    EXPECT_EQ(zp::pak::verify(&archive), zp::Result::ZC_CHECKSUM_MISMATCH);
+    zp::pak::close(&archive);
+
+    std::error_code ec;
+    std::filesystem::remove_all(src_dir, ec);
+    std::filesystem::remove(pak_path, ec);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// PackCompressedRead: Validates compressible entries are stored compressed, incompressible ones raw, and read() restores both.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(PakTest, PackCompressedRead)
+{
+    const std::filesystem::path src_dir  = zp::test::make_temp_path("zp_cpp_pak_src");
+    const std::filesystem::path pak_path = zp::test::make_temp_path("zp_cpp_pak", ".pak");
+
+    std::string repeated;
+    for (int i = 0; i < 2000; ++i)
+    {
+        repeated += "entity " + std::to_string(i % 17) + " moved\n";
+    }
+    write_text(src_dir / "log.txt", repeated);
+    write_text(src_dir / "tiny.txt", "xyz");
+
+    ASSERT_EQ(zp::pak::pack_dir(src_dir, pak_path, true), zp::Result::ZC_SUCCESS);
+
+    zp::pak::Archive archive = {};
+    archive.config.path      = pak_path;
+    ASSERT_EQ(zp::pak::open(&archive), zp::Result::ZC_SUCCESS);
+
+    const zp::pak::Entry* p_log = zp::pak::find_entry(&archive, "log.txt");
+    ASSERT_NE(p_log, nullptr);
+    EXPECT_EQ(p_log->flags & zp::pak::ENTRY_COMPRESSED, zp::pak::ENTRY_COMPRESSED);
+    EXPECT_EQ(p_log->raw_size, repeated.size());
+    EXPECT_LT(p_log->stored_size, repeated.size() / 4);
+
+    std::vector<std::byte> buffer(repeated.size());
+    zp::span<std::byte> contents;
+    ASSERT_EQ(zp::pak::read(&archive, "log.txt", {buffer.data(), buffer.size()}, &contents), zp::Result::ZC_SUCCESS);
+    ASSERT_EQ(contents.count, repeated.size());
+    EXPECT_EQ(std::memcmp(contents.p, repeated.data(), repeated.size()), 0);
+    EXPECT_EQ(zp::pak::read(&archive, "log.txt", {buffer.data(), buffer.size() - 1}, &contents), zp::Result::ZC_OUT_OF_BOUNDS);
+
+    EXPECT_EQ(zp::pak::find_entry(&archive, "tiny.txt")->flags, zp::pak::ENTRY_NONE);
+    ASSERT_EQ(zp::pak::read(&archive, "tiny.txt", {buffer.data(), buffer.size()}, &contents), zp::Result::ZC_SUCCESS);
+    ASSERT_EQ(contents.count, 3u);
+    EXPECT_EQ(std::memcmp(contents.p, "xyz", 3), 0);
+
+    EXPECT_EQ(zp::pak::verify(&archive), zp::Result::ZC_SUCCESS);
+    zp::pak::close(&archive);
+
+    std::error_code ec;
+    std::filesystem::remove_all(src_dir, ec);
+    std::filesystem::remove(pak_path, ec);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ComparesPathOnHashMatch: Validates lookups compare the stored path when hashes match. b.txt's slot is rewritten to carry
+// a.txt's hash and moved to the head of a.txt's probe, as a colliding path would sit; a.txt must still resolve to its own slot
+// and b.txt must no longer resolve at all.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(PakTest, ComparesPathOnHashMatch)
+{
+    const std::filesystem::path src_dir  = zp::test::make_temp_path("zp_cpp_pak_src");
+    const std::filesystem::path pak_path = zp::test::make_temp_path("zp_cpp_pak", ".pak");
+
+    write_text(src_dir / "a.txt", "alpha");
+    write_text(src_dir / "b.txt", "bravo!");
+    ASSERT_EQ(zp::pak::pack_dir(src_dir, pak_path), zp::Result::ZC_SUCCESS);
+
+    {
+        zp::pak::Header header = {};
+        std::fstream fs(pak_path, std::ios::binary | std::ios::in | std::ios::out);
+        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        std::vector<zp::pak::Entry> slots(header.slot_count);
+        fs.read(reinterpret_cast<char*>(slots.data()), static_cast<std::streamsize>(slots.size() * sizeof(zp::pak::Entry)));
+
+        const std::uint64_t hash_a = zp::pak::path_hash("a.txt");
+        const std::uint64_t hash_b = zp::pak::path_hash("b.txt");
+        zp::pak::Entry entry_a     = {};
+        zp::pak::Entry entry_b     = {};
+        for (const zp::pak::Entry& slot : slots)
+        {
+            entry_a = slot.path_hash == hash_a ? slot : entry_a;
+            entry_b = slot.path_hash == hash_b ? slot : entry_b;
+        }
+        ASSERT_EQ(entry_a.path_hash, hash_a);
+        ASSERT_EQ(entry_b.path_hash, hash_b);
+
+        const std::uint32_t mask = header.slot_count - 1;
+        const std::uint32_t head = static_cast<std::uint32_t>(hash_a) & mask;
+        entry_b.path_hash        = hash_a;
+        slots.assign(header.slot_count, zp::pak::Entry{});
+        slots[head]              = entry_b;
+        slots[(head + 1) & mask] = entry_a;
+
+        fs.seekp(static_cast<std::streamoff>(sizeof(zp::pak::Header)));
+        fs.write(reinterpret_cast<const char*>(slots.data()), static_cast<std::streamsize>(slots.size() * sizeof(zp::pak::Entry)));
+    }
+
+    zp::pak::Archive archive = {};
+    archive.config.path      = pak_path;
+    ASSERT_EQ(zp::pak::open(&archive), zp::Result::ZC_SUCCESS);
+
+    zp::span<const std::byte> data;
+    ASSERT_EQ(zp::pak::find(&archive, "a.txt", &data), zp::Result::ZC_SUCCESS);
+    ASSERT_EQ(data.count, 5u);
+    EXPECT_EQ(std::memcmp(data.p, "alpha", 5), 0);
+    EXPECT_EQ(zp::pak::find(&archive, "b.txt", &data), zp::Result::ZC_FILE_NOT_FOUND);
+    zp::pak::close(&archive);
+
+    std::error_code ec;
+    std::filesystem::remove_all(src_dir, ec);
+    std::filesystem::remove(pak_path, ec);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// OpenRejectsInvalidFiles: Validates open() fails for missing files and files without a pak header.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(PakTest, OpenRejectsInvalidFiles)
+{
+    zp::pak::Archive archive = {};
+    archive.config.path      = zp::test::make_temp_path("zp_cpp_pak_missing", ".pak");
+    EXPECT_EQ(zp::pak::open(&archive), zp::Result::ZC_FILE_NOT_FOUND);
+
+    const std::filesystem::path junk_path = zp::test::make_temp_path("zp_cpp_pak_junk", ".pak");
+    write_text(junk_path, std::string(256, 'j'));
+
+    archive.config.path = junk_path;
+    EXPECT_EQ(zp::pak::open(&archive), zp::Result::ZC_INVALID_FORMAT);
+
+    std::error_code ec;
+    std::filesystem::remove(junk_path, ec);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// OpenRejectsFullToc: Validates open() rejects a toc whose every slot is occupied, which would make a missing path probe forever,
+// and that verify() refuses an archive that is not open.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(PakTest, OpenRejectsFullToc)
+{
+    const std::filesystem::path src_dir  = zp::test::make_temp_path("zp_cpp_pak_src");
+    const std::filesystem::path pak_path = zp::test::make_temp_path("zp_cpp_pak", ".pak");
+
+    write_text(src_dir / "only.txt", "only");
+    ASSERT_EQ(zp::pak::pack_dir(src_dir, pak_path), zp::Result::ZC_SUCCESS);
+
+    zp::pak::Header header = {};
+    {
+        std::fstream fs(pak_path, std::ios::binary | std::ios::in | std::ios::out);
+        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        for (std::uint32_t i = 0; i < header.slot_count; ++i)
+        {
+            const std::uint64_t path_hash = 0x9e3779b97f4a7c15ull + i;
+            fs.seekp(static_cast<std::streamoff>(sizeof(zp::pak::Header) + i * sizeof(zp::pak::Entry)));
+            fs.write(reinterpret_cast<const char*>(&path_hash), sizeof(path_hash));
+        }
+    }
+
+    zp::pak::Archive archive = {};
+    archive.config.path      = pak_path;
+    EXPECT_EQ(zp::pak::open(&archive), zp::Result::ZC_INVALID_FORMAT);
+    EXPECT_EQ(zp::pak::verify(&archive), zp::Result::ZC_FILE_NOT_FOUND);
+
+    std::error_code ec;
+    std::filesystem::remove_all(src_dir, ec);
+    std::filesystem::remove(pak_path, ec);
+}
@@ -33,8 +33,8 @@ TEST(PlatformUnitTest, EventTriggersInvokeSubscribers)
 {
     zp::platform::input::State input_state{};
 
-    bool mouse_move_received = false;
-    input_state.on_mouse_moved.subscribe([&mouse_move_received](zp::platform::input::MouseMoveEvt evt) { mouse_move_received = evt.pos.x == 0.5f && evt.pos.y == 0.25f && evt.d.x == 0.1f && evt.d.y == -0.2f; });
+    bool mouse_move_received             = false;
+    const zp::subscription move_received = input_state.on_mouse_moved.subscribe([&mouse_move_received](zp::platform::input::MouseMoveEvt evt) { mouse_move_received = evt.pos.x == 0.5f && evt.pos.y == 0.25f && evt.d.x == 0.1f && evt.d.y == -0.2f; });
 
     const zp::platform::input::MouseMoveEvt move_evt = {
         .pos = {0.5f, 0.25f},
@@ -43,8 +43,8 @@ TEST(PlatformUnitTest, EventTriggersInvokeSubscribers)
     input_state.on_mouse_moved.trigger(move_evt);
     EXPECT_TRUE(mouse_move_received);
 
-    bool void_event_received = false;
-    input_state.on_keyboard_state_changed.subscribe([&void_event_received](zp::Void) { void_event_received = true; });
+    bool void_event_received             = false;
+    const zp::subscription void_received = input_state.on_keyboard_state_changed.subscribe([&void_event_received](zp::Void) { void_event_received = true; });
     input_state.on_keyboard_state_changed.trigger(zp::Void{});
     EXPECT_TRUE(void_event_received);
 }
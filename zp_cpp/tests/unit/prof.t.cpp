@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+#define ZP_PROF_ENABLED 1
+#include "zp_cpp/prof.hpp"
+#include "../cmn.hpp"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // read_all: Reads a whole file as bytes.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    std::string read_all(const std::filesystem::path& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // count_of: Counts non-overlapping occurrences of needle.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    std::size_t count_of(const std::string& haystack, const std::string& needle)
+    {
+        std::size_t count = 0;
+        for (std::size_t pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + needle.size()))
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    // nested_work: Records an outer zone around three inner ones.
+    // =====================================================================================================================================
+    // =====================================================================================================================================
+    void nested_work()
+    {
+        ZP_PROF_ZONE("test::outer");
+        for (int i = 0; i < 3; ++i)
+        {
+            ZP_PROF_ZONE("test::inner");
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// ChromeTraceFromThreads: Validates zones from several threads land in the Chrome trace with their thread names.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(ProfTest, ChromeTraceFromThreads)
+{
+    const std::filesystem::path path = zp::test::make_temp_path("zp_cpp_prof", ".json");
+    zp::prof::reset();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([t]()
+        {
+            const std::string name = "worker " + std::to_string(t);
+            zp::prof::set_thread_name(name.c_str());
+            nested_work();
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    ASSERT_EQ(zp::prof::dump(path, zp::prof::Format::CHROME_JSON), zp::Result::ZC_SUCCESS);
+    const std::string json = read_all(path);
+
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0u);
+    EXPECT_EQ(count_of(json, "\"name\":\"test::outer\",\"ph\":\"X\""), 4u);
+    EXPECT_EQ(count_of(json, "\"name\":\"test::inner\",\"ph\":\"X\""), 12u);
+    EXPECT_EQ(count_of(json, "\"args\":{\"name\":\"worker "), 4u);
+
+    zp::prof::reset();
+    ASSERT_EQ(zp::prof::dump(path, zp::prof::Format::CHROME_JSON), zp::Result::ZC_SUCCESS);
+    EXPECT_EQ(count_of(read_all(path), "\"ph\":\"X\""), 0u);
+
+    std::filesystem::remove(path);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// PerfettoSlicesNest: Validates the protobuf export holds one track descriptor and properly nested begin/end slices.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(ProfTest, PerfettoSlicesNest)
+{
+    const std::filesystem::path path = zp::test::make_temp_path("zp_cpp_prof", ".pftrace");
+    zp::prof::reset();
+
+    std::thread([]() { nested_work(); }).join();
+    ASSERT_EQ(zp::prof::dump(path, zp::prof::Format::PERFETTO), zp::Result::ZC_SUCCESS);
+    const std::string bytes = read_all(path);
+
+    // =================================================================================================
+    // =================================================================================================
+    // Walk the top-level packets and replay the slice stack of the recording thread's track.
+    // =================================================================================================
+    // =================================================================================================
+    const auto read_varint = [](const std::string& data, std::size_t* p_pos)
+    {
+        std::uint64_t value = 0;
+        for (int shift = 0; *p_pos < data.size(); shift += 7)
+        {
+            const std::uint8_t byte  = static_cast<std::uint8_t>(data[(*p_pos)++]);
+            value                   |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                break;
+            }
+        }
+        return value;
+    };
+
+    std::size_t packets = 0;
+    std::size_t begins  = 0;
+    int depth           = 0;
+    int max_depth       = 0;
+    for (std::size_t pos = 0; pos < bytes.size();)
+    {
+        ASSERT_EQ(read_varint(bytes, &pos), (1u << 3) | 2u);
+        const std::size_t size   = read_varint(bytes, &pos);
+        const std::string packet = bytes.substr(pos, size);
+        pos                     += size;
+        ++packets;
+
+        // descriptor packets carry no TrackEvent (field 11); in event packets the type is the TrackEvent's first field.
+        std::string track_event;
+        for (std::size_t field = 0; field < packet.size();)
+        {
+            const std::uint64_t key   = read_varint(packet, &field);
+            const std::uint64_t value = read_varint(packet, &field);
+            if ((key & 7) == 2)
+            {
+                if ((key >> 3) == 11)
+                {
+                    track_event = packet.substr(field, value);
+                }
+                field += value;
+            }
+        }
+        if (track_event.empty())
+        {
+            continue;
+        }
+        std::size_t field = 0;
+        ASSERT_EQ(read_varint(track_event, &field), (9u << 3) | 0u);
+        const std::uint64_t type = read_varint(track_event, &field);
+        if (type == 1)
+        {
+            ++begins;
+            max_depth = std::max(max_depth, ++depth);
+        }
+        else
+        {
+            ASSERT_EQ(type, 2u);
+            ASSERT_GT(depth, 0);
+            --depth;
+        }
+    }
+
+    EXPECT_GE(packets, 9u);
+    EXPECT_EQ(begins, 4u);
+    EXPECT_EQ(depth, 0);
+    EXPECT_EQ(max_depth, 2);
+    EXPECT_NE(bytes.find("test::outer"), std::string::npos);
+
+    std::filesystem::remove(path);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// RenamesWhileDumping: Validates a thread renaming itself and recording zones during dumps shows up under one whole name or the
+// other, never a mix.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(ProfTest, RenamesWhileDumping)
+{
+    const std::filesystem::path path = zp::test::make_temp_path("zp_cpp_prof", ".json");
+    zp::prof::reset();
+
+    std::atomic<bool> started = false;
+    std::atomic<bool> stop    = false;
+    std::thread renamer([&started, &stop]()
+    {
+        for (int i = 0; !stop.load(std::memory_order_relaxed); ++i)
+        {
+            zp::prof::set_thread_name(i % 2 == 0 ? "renamer aaaaaaaa" : "renamer bb");
+            ZP_PROF_ZONE("test::rename");
+            started.store(true, std::memory_order_release);
+        }
+    });
+    while (!started.load(std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+
+    for (int i = 0; i < 20; ++i)
+    {
+        ASSERT_EQ(zp::prof::dump(path, zp::prof::Format::CHROME_JSON), zp::Result::ZC_SUCCESS);
+        const std::string json = read_all(path);
+        EXPECT_EQ(count_of(json, "\"renamer aaaaaaaa\"") + count_of(json, "\"renamer bb\""), 1u);
+    }
+    stop = true;
+    renamer.join();
+
+    std::filesystem::remove(path);
+}
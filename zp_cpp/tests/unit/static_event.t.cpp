@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "zp_cpp/platform.hpp"
+#include "zp_cpp/static_event.hpp"
+#include <string>
+
+namespace
+{
+    // a stateful handler, reached through static_event::handler.
+    struct TrackPointer
+    {
+        zp::math::vec2 total = {0.0f, 0.0f};
+        int moves            = 0;
+
+        void operator()(const zp::platform::input::MouseMoveEvt& evt)
+        {
+            total += evt.d;
+            ++moves;
+        }
+    };
+
+    struct CountDrags
+    {
+        int drags = 0;
+
+        void operator()(const zp::platform::input::MouseDragEvt&) { ++drags; }
+    };
+
+    std::string g_trace;
+
+    struct TraceKeyA
+    {
+        void operator()(const zp::platform::input::KeyDownEvt&) const { g_trace += "A"; }
+    };
+
+    struct TraceKeyB
+    {
+        void operator()(const zp::platform::input::KeyDownEvt&) const { g_trace += "B"; }
+    };
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// StaticThenDynamic: Validates static handlers run in declaration order before dynamic listeners, which subscribe and unsubscribe
+// as on Event<T>.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(StaticEventTest, StaticThenDynamic)
+{
+    zp::static_event<zp::platform::input::KeyDownEvt, TraceKeyA, TraceKeyB> on_key_down;
+    g_trace = "";
+
+    on_key_down.trigger({zp::platform::input::Keys::F});
+    EXPECT_EQ(g_trace, "AB");
+    EXPECT_EQ(on_key_down.listener_count(), 0u);
+
+    zp::subscription dynamic = on_key_down.subscribe([](const zp::platform::input::KeyDownEvt& evt) { g_trace += evt.key == zp::platform::input::Keys::F ? "f" : "?"; });
+    on_key_down.trigger({zp::platform::input::Keys::F});
+    EXPECT_EQ(g_trace, "ABABf");
+
+    dynamic.reset();
+    on_key_down.trigger({zp::platform::input::Keys::F});
+    EXPECT_EQ(g_trace, "ABABfAB");
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// PlatformInputThroughQueue: Validates static events take the platform's mouse events straight from an event_queue, and that
+// stateful handlers keep their state.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(StaticEventTest, PlatformInputThroughQueue)
+{
+    zp::event_queue queue;
+    zp::static_event<zp::platform::input::MouseMoveEvt, TrackPointer> on_mouse_moved;
+    zp::static_event<zp::platform::input::MouseDragEvt, CountDrags> on_mouse_dragged;
+    const zp::subscription move_route = zp::queue_forward(&queue, &on_mouse_moved);
+    const zp::subscription drag_route = zp::queue_forward(&queue, &on_mouse_dragged);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        zp::enqueue(&queue, zp::platform::input::MouseMoveEvt{{0.1f * i, 0.0f}, {0.1f, 0.05f}});
+    }
+    zp::enqueue(&queue, zp::platform::input::MouseDragEvt{});
+    zp::dispatch_all(&queue);
+
+    const TrackPointer& pointer = on_mouse_moved.handler<TrackPointer>();
+    EXPECT_EQ(pointer.moves, 10);
+    EXPECT_NEAR(pointer.total.x, 1.0f, 1e-5f);
+    EXPECT_NEAR(pointer.total.y, 0.5f, 1e-5f);
+    EXPECT_EQ(on_mouse_dragged.handler<CountDrags>().drags, 1);
+}
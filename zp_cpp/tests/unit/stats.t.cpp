@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include "zp_cpp/stats.hpp"
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// BucketsBoundRelativeError: Validates every value lands in a bucket that contains it and is under 1% wide, from 1 ns to an hour.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(StatsTest, BucketsBoundRelativeError)
+{
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 100000; ++i)
+    {
+        const std::uint64_t value  = rng() >> (rng() % 64) & zp::stats::HISTOGRAM_MAX_VALUE;
+        const std::uint32_t index  = zp::stats::bucket_index(value);
+        std::uint32_t shift        = 0;
+        const std::uint64_t lowest = zp::stats::bucket_lowest(index, &shift);
+
+        ASSERT_LT(index, zp::stats::HISTOGRAM_BUCKETS);
+        ASSERT_LE(lowest, value);
+        ASSERT_LT(value - lowest, std::uint64_t(1) << shift);
+        if (value >= 256)
+        {
+            ASSERT_LT(static_cast<double>(std::uint64_t(1) << shift) / static_cast<double>(lowest), 0.01) << value;
+        }
+    }
+
+    EXPECT_EQ(zp::stats::bucket_index(zp::stats::HISTOGRAM_MAX_VALUE), zp::stats::HISTOGRAM_BUCKETS - 1);
+    EXPECT_EQ(zp::stats::bucket_index(~std::uint64_t(0)), zp::stats::HISTOGRAM_BUCKETS - 1);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// PercentilesTrackTail: Validates percentiles of a known distribution stay within the bucket error and expose a slow tail.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(StatsTest, PercentilesTrackTail)
+{
+    std::unique_ptr<zp::stats::histogram> histogram = std::make_unique<zp::stats::histogram>();
+    EXPECT_EQ(zp::stats::value_at_percentile(histogram.get(), 50.0), 0u);
+
+    // 99% of frames take 1-990 us, 1% stall for a full second.
+    for (std::uint64_t i = 1; i <= 990; ++i)
+    {
+        zp::stats::record(histogram.get(), i * 1000);
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        zp::stats::record(histogram.get(), 1'000'000'000);
+    }
+
+    const zp::stats::Summary summary = zp::stats::summarize(histogram.get());
+    EXPECT_EQ(summary.count, 1000u);
+    EXPECT_EQ(summary.min, 1000u);
+    EXPECT_EQ(summary.max, 1'000'000'000u);
+    EXPECT_NEAR(summary.p50, 500'000.0, 500'000.0 * 0.01);
+    EXPECT_NEAR(summary.p90, 900'000.0, 900'000.0 * 0.01);
+    EXPECT_NEAR(summary.p99, 990'000.0, 990'000.0 * 0.01);
+    EXPECT_EQ(summary.p999, 1'000'000'000u);
+    EXPECT_NEAR(summary.mean, (990.0 * 991.0 / 2.0 * 1000.0 + 10.0 * 1e9) / 1000.0, 1.0);
+
+    zp::stats::reset(histogram.get());
+    EXPECT_EQ(zp::stats::summarize(histogram.get()).count, 0u);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// MergeAcrossThreads: Validates per-thread histograms merge into the same totals and extremes as one histogram would hold.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(StatsTest, MergeAcrossThreads)
+{
+    constexpr int THREADS = 4;
+    constexpr int VALUES  = 100000;
+
+    std::vector<std::unique_ptr<zp::stats::histogram>> per_thread;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+    {
+        per_thread.push_back(std::make_unique<zp::stats::histogram>());
+        threads.emplace_back([t, p_histogram = per_thread.back().get()]()
+        {
+            for (int i = 0; i < VALUES; ++i)
+            {
+                zp::stats::record(p_histogram, static_cast<std::uint64_t>(t * VALUES + i + 1));
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::unique_ptr<zp::stats::histogram> merged = std::make_unique<zp::stats::histogram>();
+    for (const std::unique_ptr<zp::stats::histogram>& histogram : per_thread)
+    {
+        zp::stats::merge(merged.get(), histogram.get());
+    }
+
+    const zp::stats::Summary summary = zp::stats::summarize(merged.get());
+    EXPECT_EQ(summary.count, static_cast<std::uint64_t>(THREADS * VALUES));
+    EXPECT_EQ(summary.min, 1u);
+    EXPECT_EQ(summary.max, static_cast<std::uint64_t>(THREADS * VALUES));
+    EXPECT_NEAR(summary.mean, (THREADS * VALUES + 1) / 2.0, 1e-6);
+    EXPECT_NEAR(summary.p50, THREADS * VALUES / 2.0, THREADS * VALUES / 2.0 * 0.01);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// SerializeRoundTrip: Validates serialized histograms decode to the same summary and that corrupt input is rejected untouched.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(StatsTest, SerializeRoundTrip)
+{
+    std::unique_ptr<zp::stats::histogram> source = std::make_unique<zp::stats::histogram>();
+    std::mt19937_64 rng(11);
+    for (int i = 0; i < 50000; ++i)
+    {
+        zp::stats::record(source.get(), rng() % 60'000'000'000);
+    }
+
+    std::vector<std::byte> bytes;
+    zp::stats::serialize(source.get(), &bytes);
+    EXPECT_LT(bytes.size(), zp::stats::HISTOGRAM_BUCKETS * 12u);
+
+    std::unique_ptr<zp::stats::histogram> decoded = std::make_unique<zp::stats::histogram>();
+    ASSERT_EQ(zp::stats::deserialize(zp::span<const std::byte>{bytes.data(), bytes.size()}, decoded.get()), zp::Result::ZC_SUCCESS);
+
+    const zp::stats::Summary expected = zp::stats::summarize(source.get());
+    const zp::stats::Summary actual   = zp::stats::summarize(decoded.get());
+    EXPECT_EQ(actual.count, expected.count);
+    EXPECT_EQ(actual.min, expected.min);
+    EXPECT_EQ(actual.max, expected.max);
+    EXPECT_EQ(actual.p50, expected.p50);
+    EXPECT_EQ(actual.p99, expected.p99);
+    EXPECT_EQ(actual.p999, expected.p999);
+
+    std::unique_ptr<zp::stats::histogram> untouched = std::make_unique<zp::stats::histogram>();
+    EXPECT_EQ(zp::stats::deserialize(zp::span<const std::byte>{bytes.data(), bytes.size() - 1}, untouched.get()), zp::Result::ZC_INVALID_FORMAT);
+    bytes[0] = std::byte{0};
+    EXPECT_EQ(zp::stats::deserialize(zp::span<const std::byte>{bytes.data(), bytes.size()}, untouched.get()), zp::Result::ZC_INVALID_FORMAT);
+    EXPECT_EQ(zp::stats::summarize(untouched.get()).count, 0u);
+}
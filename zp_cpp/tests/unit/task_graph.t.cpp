@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+#include "zp_cpp/jobs.hpp"
+#include "zp_cpp/task_graph.hpp"
+#include "../alloc_counter.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // the frame from the request: poll -> net in -> (ui | skinning | textures) -> gpu record -> net out.
+    struct Frame
+    {
+        enum Task
+        {
+            POLL,
+            NET_IN,
+            UI,
+            SKIN,
+            TEX,
+            RECORD,
+            NET_OUT,
+            COUNT,
+        };
+
+        zp::task_graph graph;
+        std::atomic<std::uint32_t> clock = 0;
+        std::uint32_t started[COUNT]     = {};
+        std::uint32_t finished[COUNT]    = {};
+        std::uint32_t index[COUNT]       = {};
+
+        // each task stamps when it started and finished on a shared counter, and runs body in between.
+        zp::small_function<void()> stamp(Task task, zp::small_function<void()> body = {})
+        {
+            return [this, task, body]()
+            {
+                started[task] = clock.fetch_add(1);
+                if (body)
+                {
+                    body();
+                }
+                finished[task] = clock.fetch_add(1);
+            };
+        }
+
+        void build(zp::small_function<void()> middle = {})
+        {
+            zp::graph_init(&graph);
+            const zp::TaskResource input    = zp::graph_resource(&graph, "input");
+            const zp::TaskResource world    = zp::graph_resource(&graph, "world");
+            const zp::TaskResource ui_draw  = zp::graph_resource(&graph, "ui draw lists");
+            const zp::TaskResource skinning = zp::graph_resource(&graph, "skinning buffers");
+            const zp::TaskResource staging  = zp::graph_resource(&graph, "texture staging");
+            const zp::TaskResource commands = zp::graph_resource(&graph, "command buffers");
+
+            index[POLL]                     = zp::graph_add(&graph, "platform poll", stamp(POLL), {}, {input});
+            index[NET_IN]                   = zp::graph_add(&graph, "net incoming", stamp(NET_IN), {input}, {world});
+            index[UI]                       = zp::graph_add(&graph, "ui update", stamp(UI, middle), {input, world}, {ui_draw});
+            index[SKIN]                     = zp::graph_add(&graph, "skinning prep", stamp(SKIN, middle), {world}, {skinning});
+            index[TEX]                      = zp::graph_add(&graph, "tex upload staging", stamp(TEX, middle), {world}, {staging});
+            index[RECORD]                   = zp::graph_add(&graph, "gpu record", stamp(RECORD), {ui_draw, skinning, staging}, {commands});
+            index[NET_OUT]                  = zp::graph_add(&graph, "net outgoing", stamp(NET_OUT), {world, commands}, {});
+            zp::graph_compile(&graph);
+        }
+    };
+
+    // pairs (before, after) the frame must order.
+    constexpr Frame::Task FRAME_EDGES[][2] = {
+        {Frame::POLL, Frame::NET_IN},
+        {Frame::NET_IN, Frame::UI},
+        {Frame::NET_IN, Frame::SKIN},
+        {Frame::NET_IN, Frame::TEX},
+        {Frame::UI, Frame::RECORD},
+        {Frame::SKIN, Frame::RECORD},
+        {Frame::TEX, Frame::RECORD},
+        {Frame::RECORD, Frame::NET_OUT},
+    };
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// DerivesEdgesFromResources: Validates reads and writes alone order the frame, leave the three middle stages independent, and
+// that a later writer waits for earlier readers.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(TaskGraphTest, DerivesEdgesFromResources)
+{
+    Frame frame;
+    frame.build();
+
+    for (const auto& edge : FRAME_EDGES)
+    {
+        EXPECT_TRUE(zp::graph_depends_on(&frame.graph, frame.index[edge[1]], frame.index[edge[0]])) << edge[0] << " -> " << edge[1];
+    }
+    EXPECT_TRUE(zp::graph_depends_on(&frame.graph, frame.index[Frame::NET_OUT], frame.index[Frame::POLL]));
+    EXPECT_FALSE(zp::graph_depends_on(&frame.graph, frame.index[Frame::SKIN], frame.index[Frame::UI]));
+    EXPECT_FALSE(zp::graph_depends_on(&frame.graph, frame.index[Frame::TEX], frame.index[Frame::SKIN]));
+    EXPECT_FALSE(zp::graph_depends_on(&frame.graph, frame.index[Frame::UI], frame.index[Frame::TEX]));
+    zp::graph_exit(&frame.graph);
+
+    // write-after-read: a writer declared after two readers runs after both.
+    zp::task_graph graph;
+    zp::graph_init(&graph);
+    const zp::TaskResource shared = zp::graph_resource(&graph, "shared");
+    const std::uint32_t reader_a  = zp::graph_add(&graph, "reader a", []() {}, {shared}, {});
+    const std::uint32_t reader_b  = zp::graph_add(&graph, "reader b", []() {}, {shared}, {});
+    const std::uint32_t writer    = zp::graph_add(&graph, "writer", []() {}, {}, {shared});
+    zp::graph_compile(&graph);
+    EXPECT_TRUE(zp::graph_depends_on(&graph, writer, reader_a));
+    EXPECT_TRUE(zp::graph_depends_on(&graph, writer, reader_b));
+    EXPECT_FALSE(zp::graph_depends_on(&graph, reader_b, reader_a));
+    zp::graph_exit(&graph);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// RunsFrameInParallel: Validates every run of the frame on a pool keeps each edge's order, that the three middle stages run at
+// the same time in every run, and that no run allocates, the first included.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(TaskGraphTest, RunsFrameInParallel)
+{
+    constexpr int RUNS = 50;
+    zp::jobs::init({.worker_count = 4});
+
+    // each middle stage waits until all three of its run have arrived, so a run only finishes if the pool runs them side by side.
+    // the deadline just turns a scheduling bug into a failure rather than a hang.
+    std::atomic<int> middle_arrived   = 0;
+    std::atomic<bool> middle_stranded = false;
+    Frame frame;
+    frame.build(
+        [&]()
+        {
+            const int all_in                                  = (middle_arrived.fetch_add(1) / 3 + 1) * 3;
+            const std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (middle_arrived.load() < all_in)
+            {
+                if (std::chrono::steady_clock::now() > until)
+                {
+                    middle_stranded = true;
+                    return;
+                }
+                std::this_thread::yield();
+            }
+        });
+
+    // init stocked the job nodes and graph_compile sized the per-run state, so nothing is left to warm up.
+    const std::size_t before = zp::test::allocations.load();
+    for (int run = 0; run < RUNS; ++run)
+    {
+        frame.clock = 0;
+        zp::graph_run(&frame.graph);
+        for (const auto& edge : FRAME_EDGES)
+        {
+            ASSERT_LT(frame.finished[edge[0]], frame.started[edge[1]]) << "run " << run << ": " << edge[0] << " -> " << edge[1];
+        }
+    }
+    const std::size_t allocations = zp::test::allocations.load() - before;
+
+    EXPECT_FALSE(middle_stranded.load());
+    EXPECT_EQ(middle_arrived.load(), 3 * RUNS);
+    EXPECT_EQ(frame.graph.state.runs, static_cast<std::uint64_t>(RUNS));
+    EXPECT_EQ(allocations, 0u);
+    zp::graph_exit(&frame.graph);
+    zp::jobs::shutdown();
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// CriticalPathFirst: Validates that once a run has timed the tasks, the root heading the longest chain starts first on the
+// calling thread even though it was declared last, and that critical_path_ns measures that chain.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(TaskGraphTest, CriticalPathFirst)
+{
+    const auto sleep_ms = [](int ms) { return [ms]() { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }; };
+
+    zp::jobs::init({.worker_count = 2});
+    zp::task_graph graph;
+    zp::graph_init(&graph);
+
+    const std::thread::id caller               = std::this_thread::get_id();
+    std::atomic<std::uint32_t> first_on_caller = ~0u;
+    const auto note_caller                     = [&](std::uint32_t task)
+    {
+        std::uint32_t none = ~0u;
+        if (std::this_thread::get_id() == caller)
+        {
+            first_on_caller.compare_exchange_strong(none, task);
+        }
+    };
+
+    // four short independent tasks, then a chain of three declared after them.
+    for (std::uint32_t i = 0; i < 4; ++i)
+    {
+        const zp::TaskResource own = zp::graph_resource(&graph, "short");
+        zp::graph_add(
+            &graph,
+            "short",
+            [=]()
+            {
+                note_caller(i);
+                sleep_ms(1)();
+            },
+            {},
+            {own});
+    }
+    const zp::TaskResource chain = zp::graph_resource(&graph, "chain");
+    const std::uint32_t head     = zp::graph_add(
+        &graph,
+        "chain head",
+        [&]()
+        {
+            note_caller(head);
+            sleep_ms(4)();
+        },
+        {},
+        {chain});
+    zp::graph_add(&graph, "chain middle", sleep_ms(4), {chain}, {chain});
+    zp::graph_add(&graph, "chain tail", sleep_ms(4), {chain}, {chain});
+    zp::graph_compile(&graph);
+
+    zp::graph_run(&graph);
+    first_on_caller = ~0u;
+    zp::graph_run(&graph);
+
+    EXPECT_EQ(first_on_caller.load(), head);
+    EXPECT_GE(graph.state.critical_path_ns, 12'000'000u);
+    zp::graph_exit(&graph);
+    zp::jobs::shutdown();
+}
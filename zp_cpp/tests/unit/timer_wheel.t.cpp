@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "zp_cpp/timer_wheel.hpp"
+#include <random>
+#include <vector>
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// FiresOnTimeAcrossLevels: Validates timers on every level, and past the wheel's span, fire within one tick of their deadline and
+// never early.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(TimerWheelTest, FiresOnTimeAcrossLevels)
+{
+    zp::timer_wheel wheel;
+    wheel.config.tick_ns = 1000;
+    zp::wheel_init(&wheel, 0);
+
+    // 2^32 ticks of 1 us is ~72 minutes, so the last deadline starts out parked beyond the wheel.
+    const std::vector<zp::ens> deadlines = {1, 999, 1000, 1001, 255'000, 300'000, 65'536'000, 70'000'000, 20'000'000'000, 5'000'000'000'000};
+    std::vector<zp::ens> fired_at(deadlines.size(), 0);
+    zp::ens now = 0;
+    for (std::size_t i = 0; i < deadlines.size(); ++i)
+    {
+        zp::wheel_schedule_at(&wheel, deadlines[i], [&, i]() { fired_at[i] = now; });
+    }
+    EXPECT_EQ(zp::wheel_pending(&wheel), deadlines.size());
+
+    // step unevenly so advances land both on and between ticks.
+    std::size_t fired = 0;
+    for (zp::ens step = 700; now < 6'000'000'000'000; step = std::min<zp::ens>(step * 3 / 2, 10'000'000'000))
+    {
+        now   += step;
+        fired += zp::wheel_advance(&wheel, now);
+    }
+
+    EXPECT_EQ(fired, deadlines.size());
+    EXPECT_EQ(zp::wheel_pending(&wheel), 0u);
+    for (std::size_t i = 0; i < deadlines.size(); ++i)
+    {
+        EXPECT_GE(fired_at[i], deadlines[i]) << i;
+    }
+
+    // with advances every tick, lateness is bounded by the tick.
+    zp::wheel_exit(&wheel);
+    zp::wheel_init(&wheel, 0);
+    zp::ens late = 0;
+    for (const zp::ens deadline : deadlines)
+    {
+        if (deadline < 100'000'000)
+        {
+            zp::wheel_schedule_at(&wheel, deadline, [&, deadline]() { late = std::max(late, now - deadline); });
+        }
+    }
+    for (now = 0; now <= 100'000'000; now += 1000)
+    {
+        zp::wheel_advance(&wheel, now);
+    }
+    EXPECT_LT(late, 1000u);
+    zp::wheel_exit(&wheel);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// CancelAndReschedule: Validates cancel works once, stale ids are rejected and callbacks can reschedule themselves.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(TimerWheelTest, CancelAndReschedule)
+{
+    zp::timer_wheel wheel;
+    zp::wheel_init(&wheel, 1'000'000'000);
+
+    bool cancelled_ran       = false;
+    const zp::TimerId cancel = zp::wheel_schedule_after(&wheel, 5'000'000, [&]() { cancelled_ran = true; });
+    EXPECT_TRUE(zp::wheel_cancel(&wheel, cancel));
+    EXPECT_FALSE(zp::wheel_cancel(&wheel, cancel));
+    EXPECT_FALSE(zp::wheel_cancel(&wheel, zp::INVALID_TIMER));
+
+    // a periodic timer re-arms itself from its own callback and reuses the freed node.
+    int ticks = 0;
+    std::function<void()> periodic;
+    periodic = [&]()
+    {
+        if (++ticks < 5)
+        {
+            zp::wheel_schedule_after(&wheel, 10'000'000, periodic);
+        }
+    };
+    zp::wheel_schedule_after(&wheel, 10'000'000, periodic);
+    EXPECT_FALSE(zp::wheel_cancel(&wheel, cancel));
+
+    for (zp::ens ms = 1; ms <= 100; ++ms)
+    {
+        zp::wheel_advance(&wheel, 1'000'000'000 + ms * 1'000'000);
+    }
+
+    EXPECT_FALSE(cancelled_ran);
+    EXPECT_EQ(ticks, 5);
+    EXPECT_EQ(zp::wheel_pending(&wheel), 0u);
+    zp::wheel_exit(&wheel);
+}
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// MillionTimers: Validates a million timers over a minute schedule, cancel and fire with the expected counts.
+// =========================================================================================================================================
+// =========================================================================================================================================
+TEST(TimerWheelTest, MillionTimers)
+{
+    constexpr int TIMERS = 1'000'000;
+
+    zp::timer_wheel wheel;
+    zp::wheel_init(&wheel, 0);
+
+    std::mt19937_64 rng(3);
+    std::vector<zp::TimerId> ids;
+    ids.reserve(TIMERS);
+    std::size_t ran = 0;
+    for (int i = 0; i < TIMERS; ++i)
+    {
+        ids.push_back(zp::wheel_schedule_at(&wheel, rng() % 60'000'000'000, [&ran]() { ++ran; }));
+    }
+    for (int i = 0; i < TIMERS; i += 2)
+    {
+        ASSERT_TRUE(zp::wheel_cancel(&wheel, ids[i]));
+    }
+    std::size_t fired = 0;
+    for (zp::ens now = 0; now <= 61'000'000'000; now += 16'000'000)
+    {
+        fired += zp::wheel_advance(&wheel, now);
+    }
+
+    EXPECT_EQ(fired, static_cast<std::size_t>(TIMERS / 2));
+    EXPECT_EQ(ran, static_cast<std::size_t>(TIMERS / 2));
+    EXPECT_EQ(zp::wheel_pending(&wheel), 0u);
+    zp::wheel_exit(&wheel);
+}
@@ -0,0 +1,39 @@
+#include "zp_cpp/cli.hpp"
+#include "zp_cpp/core.hpp"
+#include "zp_cpp/log.hpp"
+
+#include <iostream>
+
+// =========================================================================================================================================
+// =========================================================================================================================================
+// main: zp_logdecode --in=<binary log> [--format=text|json]. Writes one decoded record per line to stdout.
+// =========================================================================================================================================
+// =========================================================================================================================================
+int main(int argc, char** argv)
+{
+    const std::unordered_map<std::string, std::string> args = zp::cli::parse_cli(argc, argv);
+
+    // =============================================================================================
+    // =============================================================================================
+    // Guard: an input file is required and the format must be known.
+    // =============================================================================================
+    // =============================================================================================
+    {
+        const bool has_in       = args.contains("in");
+        const bool valid_format = !args.contains("format") || args.at("format") == "text" || args.at("format") == "json";
+        if (!has_in || !valid_format)
+        {
+            std::cerr << "usage: zp_logdecode --in=<binary log> [--format=text|json]" << std::endl;
+            return 2;
+        }
+    }
+
+    const bool json         = args.contains("format") && args.at("format") == "json";
+    const zp::Result result = zp::log::decode_binary(args.at("in"), std::cout, json);
+    if (result != zp::Result::ZC_SUCCESS)
+    {
+        std::cerr << "zp_logdecode: failed to decode " << args.at("in") << " (" << static_cast<int>(result) << ")" << std::endl;
+        return 1;
+    }
+    return 0;
+}